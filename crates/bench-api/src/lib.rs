@@ -32,6 +32,20 @@
 //!
 //! All API calls must happen on the same thread.
 //!
+//! Between `wasm_bench_create` and `wasm_bench_compile`,
+//! `wasm_bench_on_compile_phase` may be called to additionally time each phase
+//! of compilation (see the `WASM_BENCH_PHASE_*` constants), so that, for
+//! example, regressions in code generation can be told apart from regressions
+//! in publishing code to executable memory. Since the phase callbacks are
+//! invoked on the benchmarking thread, they may start and stop performance
+//! counters (such as instructions retired, cache misses, or page faults) in
+//! addition to timers. After compilation, `wasm_bench_compile_cache_status`
+//! returns whether the module came from Wasmtime's compilation cache.
+//!
+//! By default no compilation cache is used. Setting the
+//! `WASM_BENCH_CACHE_CONFIG` environment variable to the path of a cache
+//! configuration file enables the cache configured by that file.
+//!
 //! Functions which return pointers use null as an error value. Function which
 //! return `int` use `0` as OK and non-zero as an error value.
 //!
@@ -114,9 +128,23 @@
 //!     )
 //! "#).unwrap();
 //!
-//! // This will call the `compilation_{start,end}` timing functions on success.
+//! // Optionally, time each phase of compilation as well.
+//! extern "C" fn phase_start(timer: *mut u8, phase: u32) {
+//!     // Start your timer for `phase` here.
+//! }
+//! extern "C" fn phase_end(timer: *mut u8, phase: u32) {
+//!     // End your timer for `phase` here.
+//! }
+//! let code = unsafe {
+//!     wasm_bench_on_compile_phase(bench_api, ptr::null_mut(), phase_start, phase_end)
+//! };
+//! assert_eq!(code, OK);
+//!
+//! // This will call the `compilation_{start,end}` timing functions on success,
+//! // and the phase timing functions for each phase of compilation.
 //! let code = unsafe { wasm_bench_compile(bench_api, wasm.as_ptr(), wasm.len()) };
 //! assert_eq!(code, OK);
+//! assert_eq!(unsafe { wasm_bench_compile_cache_status(bench_api) }, -1);
 //!
 //! // This will call the `instantiation_{start,end}` timing functions on success.
 //! let code = unsafe { wasm_bench_instantiate(bench_api) };
@@ -138,13 +166,25 @@ use anyhow::{anyhow, Context, Result};
 use std::os::raw::{c_int, c_void};
 use std::slice;
 use std::{env, path::PathBuf};
-use wasmtime::{Config, Engine, Instance, Linker, Module, Store};
+use wasmtime::{CompileEvent, CompilePhase, Config, Engine, Instance, Linker, Module, Store};
 use wasmtime_wasi::{sync::WasiCtxBuilder, WasiCtx};
 
 pub type ExitCode = c_int;
 pub const OK: ExitCode = 0;
 pub const ERR: ExitCode = -1;
 
+/// The phases of compilation reported to `wasm_bench_on_compile_phase`
+/// callbacks, in the order they happen.
+///
+/// Parsing and validating the module, except for function bodies.
+pub const WASM_BENCH_PHASE_TRANSLATE: u32 = 0;
+/// Validating and compiling function bodies with Cranelift.
+pub const WASM_BENCH_PHASE_CODEGEN: u32 = 1;
+/// Linking compiled functions into an object.
+pub const WASM_BENCH_PHASE_LINK: u32 = 2;
+/// Copying code into executable memory and registering it with the engine.
+pub const WASM_BENCH_PHASE_PUBLISH: u32 = 3;
+
 // Randomize the location of heap objects to avoid accidental locality being an
 // uncontrolled variable that obscures performance evaluation in our
 // experiments.
@@ -338,6 +378,39 @@ pub extern "C" fn wasm_bench_compile(
     to_exit_code(result)
 }
 
+/// Time each phase of compiling the Wasm benchmark module.
+///
+/// When `wasm_bench_compile` is called afterwards, `phase_start` and
+/// `phase_end` are invoked with `timer` and one of the `WASM_BENCH_PHASE_*`
+/// constants around each phase of compilation. These calls happen within the
+/// `compilation_{start,end}` calls. Only the publish phase happens when the
+/// module is loaded from the compilation cache.
+#[no_mangle]
+pub extern "C" fn wasm_bench_on_compile_phase(
+    state: *mut c_void,
+    timer: *mut u8,
+    phase_start: extern "C" fn(*mut u8, u32),
+    phase_end: extern "C" fn(*mut u8, u32),
+) -> ExitCode {
+    let state = unsafe { (state as *mut BenchState).as_mut().unwrap() };
+    state.compile_phase_timer = Some((timer, phase_start, phase_end));
+    OK
+}
+
+/// Whether the Wasm benchmark module was found in the compilation cache.
+///
+/// Returns `1` for a cache hit, `0` for a cache miss, and `-1` if no
+/// compilation cache is configured or the module hasn't been compiled yet.
+#[no_mangle]
+pub extern "C" fn wasm_bench_compile_cache_status(state: *mut c_void) -> c_int {
+    let state = unsafe { (state as *mut BenchState).as_mut().unwrap() };
+    match state.cache_hit {
+        Some(true) => 1,
+        Some(false) => 0,
+        None => -1,
+    }
+}
+
 /// Instantiate the Wasm benchmark module.
 #[no_mangle]
 pub extern "C" fn wasm_bench_instantiate(state: *mut c_void) -> ExitCode {
@@ -367,6 +440,18 @@ fn to_exit_code<T>(result: impl Into<Result<T>>) -> ExitCode {
     }
 }
 
+/// Maps a compilation phase to its `WASM_BENCH_PHASE_*` constant, if it has
+/// one.
+fn phase_index(phase: CompilePhase) -> Option<u32> {
+    match phase {
+        CompilePhase::Translate => Some(WASM_BENCH_PHASE_TRANSLATE),
+        CompilePhase::Codegen => Some(WASM_BENCH_PHASE_CODEGEN),
+        CompilePhase::Link => Some(WASM_BENCH_PHASE_LINK),
+        CompilePhase::Publish => Some(WASM_BENCH_PHASE_PUBLISH),
+        _ => None,
+    }
+}
+
 /// This structure contains the actual Rust implementation of the state required
 /// to manage the Wasmtime engine between calls.
 struct BenchState {
@@ -374,6 +459,12 @@ struct BenchState {
     compilation_timer: *mut u8,
     compilation_start: extern "C" fn(*mut u8),
     compilation_end: extern "C" fn(*mut u8),
+    compile_phase_timer: Option<(
+        *mut u8,
+        extern "C" fn(*mut u8, u32),
+        extern "C" fn(*mut u8, u32),
+    )>,
+    cache_hit: Option<bool>,
     instantiation_timer: *mut u8,
     instantiation_start: extern "C" fn(*mut u8),
     instantiation_end: extern "C" fn(*mut u8),
@@ -404,9 +495,13 @@ impl BenchState {
         execution_end: extern "C" fn(*mut u8),
         make_wasi_cx: impl FnMut() -> Result<WasiCtx> + 'static,
     ) -> Result<Self> {
-        // NB: do not configure a code cache.
+        // NB: do not configure a code cache unless explicitly requested, since
+        // by default compilation itself should be measured.
         let mut config = Config::new();
         config.wasm_simd(true);
+        if let Some(path) = env::var_os("WASM_BENCH_CACHE_CONFIG") {
+            config.cache_config_load(path)?;
+        }
         let engine = Engine::new(&config)?;
         let mut linker = Linker::<HostState>::new(&engine);
 
@@ -438,6 +533,8 @@ impl BenchState {
             compilation_timer,
             compilation_start,
             compilation_end,
+            compile_phase_timer: None,
+            cache_hit: None,
             instantiation_timer,
             instantiation_start,
             instantiation_end,
@@ -453,10 +550,29 @@ impl BenchState {
             "create a new engine to repeat compilation"
         );
 
+        let phase_timer = self.compile_phase_timer;
+        let cache_hit = std::cell::Cell::new(None);
+        let on_event = |event: CompileEvent| match event {
+            CompileEvent::Start(phase) => {
+                if let (Some((timer, start, _)), Some(phase)) = (phase_timer, phase_index(phase)) {
+                    start(timer, phase);
+                }
+            }
+            CompileEvent::End(phase) => {
+                if let (Some((timer, _, end)), Some(phase)) = (phase_timer, phase_index(phase)) {
+                    end(timer, phase);
+                }
+            }
+            CompileEvent::CacheHit => cache_hit.set(Some(true)),
+            CompileEvent::CacheMiss => cache_hit.set(Some(false)),
+        };
+
         (self.compilation_start)(self.compilation_timer);
-        let module = Module::from_binary(self.linker.engine(), bytes)?;
+        let module = Module::from_binary_with_events(self.linker.engine(), bytes, on_event)?;
         (self.compilation_end)(self.compilation_timer);
 
+        self.cache_hit = cache_hit.get();
+
         self.module = Some(module);
         Ok(())
     }
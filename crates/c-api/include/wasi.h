@@ -46,6 +46,46 @@ WASI_DECLARE_OWN(config)
  */
 WASI_API_EXTERN own wasi_config_t* wasi_config_new();
 
+/**
+ * \typedef wasi_write_pipe_t
+ * \brief Convenience alias for #wasi_write_pipe_t
+ *
+ * \struct wasi_write_pipe_t
+ * \brief A growable in-memory buffer that WASI programs can write their stdout
+ * or stderr to.
+ *
+ * A pipe can be shared between any number of configurations and stays valid
+ * independently of them, so it can be read after the WASI program has run
+ * even if its store has been deleted.
+ *
+ * \fn void wasi_write_pipe_delete(wasi_write_pipe_t *);
+ * \brief Deletes a pipe.
+ */
+WASI_DECLARE_OWN(write_pipe)
+
+/**
+ * \brief Creates a new empty in-memory pipe.
+ *
+ * The caller is expected to deallocate the returned pipe.
+ */
+WASI_API_EXTERN own wasi_write_pipe_t* wasi_write_pipe_new();
+
+/**
+ * \brief Copies everything written to this pipe so far into `out`.
+ *
+ * The caller is expected to deallocate `out` with #wasm_byte_vec_delete.
+ */
+WASI_API_EXTERN void wasi_write_pipe_contents(const wasi_write_pipe_t* pipe, own wasm_byte_vec_t* out);
+
+/**
+ * \brief Moves everything written to this pipe so far into `out`, leaving the
+ * pipe empty.
+ *
+ * This is useful to reuse one pipe across many runs of a WASI program. The
+ * caller is expected to deallocate `out` with #wasm_byte_vec_delete.
+ */
+WASI_API_EXTERN void wasi_write_pipe_take(wasi_write_pipe_t* pipe, own wasm_byte_vec_t* out);
+
 /**
  * \brief Sets the argv list for this configuration object.
  *
@@ -100,6 +140,15 @@ WASI_API_EXTERN bool wasi_config_set_stdin_file(wasi_config_t* config, const cha
  */
 WASI_API_EXTERN void wasi_config_inherit_stdin(wasi_config_t* config);
 
+/**
+ * \brief Configures standard input to be taken from the specified bytes.
+ *
+ * The WASI program will read the contents of `binary` from stdin and then see
+ * end-of-file. This takes ownership of the contents of `binary`, which the
+ * caller must not use or delete afterwards.
+ */
+WASI_API_EXTERN void wasi_config_set_stdin_bytes(wasi_config_t* config, wasm_byte_vec_t* binary);
+
 /**
  * \brief Configures standard output to be written to the specified file.
  *
@@ -117,6 +166,16 @@ WASI_API_EXTERN bool wasi_config_set_stdout_file(wasi_config_t* config, const ch
  */
 WASI_API_EXTERN void wasi_config_inherit_stdout(wasi_config_t* config);
 
+/**
+ * \brief Configures standard output to be written to the specified in-memory
+ * pipe.
+ *
+ * The `pipe` is not consumed by this function and remains owned by the caller,
+ * who can read what the WASI program wrote with #wasi_write_pipe_contents or
+ * #wasi_write_pipe_take.
+ */
+WASI_API_EXTERN void wasi_config_set_stdout_pipe(wasi_config_t* config, const wasi_write_pipe_t* pipe);
+
 /**
  * \brief Configures standard output to be written to the specified file.
  *
@@ -134,6 +193,16 @@ WASI_API_EXTERN bool wasi_config_set_stderr_file(wasi_config_t* config, const ch
  */
 WASI_API_EXTERN void wasi_config_inherit_stderr(wasi_config_t* config);
 
+/**
+ * \brief Configures standard error to be written to the specified in-memory
+ * pipe.
+ *
+ * The `pipe` is not consumed by this function and remains owned by the caller,
+ * who can read what the WASI program wrote with #wasi_write_pipe_contents or
+ * #wasi_write_pipe_take.
+ */
+WASI_API_EXTERN void wasi_config_set_stderr_pipe(wasi_config_t* config, const wasi_write_pipe_t* pipe);
+
 /**
  * \brief Configures a "preopened directory" to be available to WASI APIs.
  *
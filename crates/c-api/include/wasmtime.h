@@ -165,6 +165,7 @@
 #define WASMTIME_API_H
 
 #include <wasi.h>
+#include <wasmtime/async.h>
 #include <wasmtime/config.h>
 #include <wasmtime/error.h>
 #include <wasmtime/engine.h>
@@ -0,0 +1,361 @@
+/**
+ * \file wasmtime/async.h
+ *
+ * \brief Wasmtime async functionality
+ *
+ * Async functionality in Wasmtime is well documented here:
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.async_support
+ *
+ * All WebAssembly executes synchronously, but async support enables wasm
+ * code to be executed on a separate stack, so it can be paused and resumed. There
+ * are three mechanisms for yielding control from wasm to the caller: fuel,
+ * epochs, and async host functions.
+ *
+ * When WebAssembly is executed, a #wasmtime_call_future_t is returned. This
+ * struct represents the state of the execution and each call to
+ * #wasmtime_call_future_poll will execute the WebAssembly code on a separate
+ * stack until the function returns or yields control back to the caller.
+ *
+ * It's expected these futures are polled in a loop until completed, at which
+ * point the future should be deleted. Functions that return a
+ * #wasmtime_call_future_t are special in that all parameters to that function
+ * should not be modified in any way and must be kept alive until the future
+ * is deleted. This includes concurrent calls for a single store - another
+ * function on a store should not be called while there is a
+ * #wasmtime_call_future_t alive.
+ *
+ * As for asynchronous host calls - the reverse contract is upheld. Wasmtime
+ * will keep all parameters to the function alive and unmodified until the
+ * #wasmtime_func_async_continuation_callback_t returns true.
+ *
+ * Note that this isn't always enabled at build time.
+ */
+
+#ifndef WASMTIME_ASYNC_H
+#define WASMTIME_ASYNC_H
+
+#include <wasm.h>
+#include <wasmtime/config.h>
+#include <wasmtime/error.h>
+#include <wasmtime/func.h>
+#include <wasmtime/instance.h>
+#include <wasmtime/linker.h>
+#include <wasmtime/module.h>
+#include <wasmtime/store.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Whether or not to enable support for asynchronous functions in
+ * Wasmtime.
+ *
+ * When enabled, the config can optionally define host functions with async.
+ * Instances created and functions called with this Config must be called
+ * through their asynchronous APIs, however. For example using
+ * #wasmtime_func_call will panic when used with this config.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.async_support
+ */
+WASMTIME_CONFIG_PROP(void, async_support, bool)
+
+/**
+ * \brief Configures the size of the stacks used for asynchronous execution.
+ *
+ * This setting configures the size of the stacks that are allocated for
+ * asynchronous execution.
+ *
+ * The value cannot be less than max_wasm_stack.
+ *
+ * The amount of stack space guaranteed for host functions is async_stack_size
+ * - max_wasm_stack, so take care not to set these two values close to one
+ * another; doing so may cause host functions to overflow the stack and abort
+ * the process.
+ *
+ * By default this option is 2 MiB.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.async_stack_size
+ */
+WASMTIME_CONFIG_PROP(wasmtime_error_t*, async_stack_size, size_t)
+
+/**
+ * \brief Configures how many stacks used for asynchronous execution are kept
+ * around for reuse.
+ *
+ * By default every asynchronous call maps a fresh stack and unmaps it once the
+ * call finishes. When this is nonzero, up to this many stacks are instead
+ * cached by the engine after use and handed out again to later calls. The
+ * pages of cached stacks are discarded, so they only consume address space.
+ *
+ * This has no effect with the pooling allocator, which always reuses its
+ * stacks.
+ *
+ * By default this option is 0.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.async_stack_cache_size
+ */
+WASMTIME_CONFIG_PROP(void, async_stack_cache_size, size_t)
+
+/**
+ * \brief Returns statistics about the stacks used for asynchronous execution
+ * by an engine.
+ *
+ * \param engine the engine to query
+ * \param live where to store the number of stacks currently in use
+ * \param cached where to store the number of idle stacks kept for reuse
+ * \param created where to store the number of stacks created from scratch
+ * \param reused where to store the number of allocations which reused an
+ *        idle stack
+ *
+ * Stacks are only tracked when they're cached for reuse, as configured with
+ * #wasmtime_config_async_stack_cache_size_set; otherwise all statistics are
+ * zero.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Engine.html#method.fiber_stack_stats
+ */
+WASM_API_EXTERN void wasmtime_engine_fiber_stack_stats(
+    const wasm_engine_t *engine,
+    size_t *live,
+    size_t *cached,
+    uint64_t *created,
+    uint64_t *reused);
+
+/**
+ * \brief Configures this store to yield while executing futures whenever fuel
+ * runs out.
+ *
+ * When fuel runs out the future will yield back to the caller of
+ * #wasmtime_call_future_poll, after which `fuel_to_inject` units of fuel are
+ * added to the store. This happens at most `injection_count` times, after
+ * which running out of fuel traps.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Store.html#method.out_of_fuel_async_yield
+ */
+WASM_API_EXTERN void wasmtime_context_out_of_fuel_async_yield(
+    wasmtime_context_t *context,
+    uint64_t injection_count,
+    uint64_t fuel_to_inject);
+
+/**
+ * \brief Configures epoch-deadline expiration to yield to the caller and then
+ * update the deadline.
+ *
+ * When the deadline is reached the future yields back to the caller of
+ * #wasmtime_call_future_poll, and the deadline is then extended by `delta`
+ * ticks. Epoch interruption must be enabled with
+ * #wasmtime_config_epoch_interruption_set.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Store.html#method.epoch_deadline_async_yield_and_update
+ */
+WASM_API_EXTERN void wasmtime_context_epoch_deadline_async_yield_and_update(
+    wasmtime_context_t *context,
+    uint64_t delta);
+
+/**
+ * The callback to determine a continuation's current state.
+ *
+ * Return true if the host call has completed, otherwise false will
+ * continue to yield WebAssembly execution.
+ */
+typedef bool (*wasmtime_func_async_continuation_callback_t)(void *env);
+
+/**
+ * A continuation for the current state of the host function's execution.
+ */
+typedef struct wasmtime_async_continuation_t {
+  /// Callback for if the async function has completed.
+  wasmtime_func_async_continuation_callback_t callback;
+  /// User-provided argument to pass to the callback.
+  void *env;
+  /// A finalizer for the user-provided *env
+  void (*finalizer)(void *);
+} wasmtime_async_continuation_t;
+
+/**
+ * \brief Callback signature for #wasmtime_linker_define_async_func and
+ * #wasmtime_func_new_async.
+ *
+ * This is a host function that returns a continuation to be called later.
+ *
+ * All the arguments to this function will be kept alive until the continuation
+ * returns that it has errored or has completed.
+ *
+ * \param env user-provided argument passed to #wasmtime_linker_define_async_func
+ * \param caller a temporary object that can only be used during this function
+ * call. Used to acquire #wasmtime_context_t or caller's state
+ * \param args the arguments provided to this function invocation
+ * \param nargs how many arguments are provided
+ * \param results where to write the results of this function
+ * \param nresults how many results must be produced
+ * \param trap_ret if assigned a not `NULL` value then the called function will
+ * trap with the returned error. Note that ownership of trap is transferred
+ * to wasmtime.
+ * \param continuation_ret the returned continuation that determines when the
+ * async function has completed executing. If this isn't written to then the
+ * host function has completed synchronously.
+ *
+ * Only supported for async stores.
+ *
+ * See #wasmtime_func_callback_t for more information.
+ */
+typedef void (*wasmtime_func_async_callback_t)(
+    void *env,
+    wasmtime_caller_t *caller,
+    const wasmtime_val_t *args,
+    size_t nargs,
+    wasmtime_val_t *results,
+    size_t nresults,
+    wasm_trap_t **trap_ret,
+    wasmtime_async_continuation_t *continuation_ret);
+
+/**
+ * \brief The structure representing a asynchronously running function.
+ *
+ * This structure is always owned by the caller and must be deleted using
+ * #wasmtime_call_future_delete.
+ *
+ * Functions that return this type require that the parameters to the function
+ * are unmodified until this future is destroyed.
+ */
+typedef struct wasmtime_call_future wasmtime_call_future_t;
+
+/**
+ * \brief Executes WebAssembly in the function.
+ *
+ * Returns true if the function call has completed. After this function returns
+ * true, it should *not* be called again for a given future.
+ *
+ * This function returns false if execution has yielded either due to being out
+ * of fuel (see #wasmtime_context_out_of_fuel_async_yield), reaching an epoch
+ * deadline (see #wasmtime_context_epoch_deadline_async_yield_and_update), or
+ * because a continuation of an async host function returned false.
+ *
+ * The future is polled with a no-op waker, so Wasmtime never notifies the
+ * embedder that progress can be made. It's up to the embedder to decide when
+ * to call this function again, for example once the I/O an async host function
+ * is waiting on has completed.
+ *
+ * The poll method gives ownership of the results of the function to the
+ * caller once it has completed.
+ */
+WASM_API_EXTERN bool wasmtime_call_future_poll(wasmtime_call_future_t *future);
+
+/**
+ * \brief Frees the underlying memory for a future.
+ *
+ * All wasmtime_call_future_t are owned by the caller and should be deleted
+ * using this function.
+ */
+WASM_API_EXTERN void wasmtime_call_future_delete(wasmtime_call_future_t *future);
+
+/**
+ * \brief Invokes this function with the params given, returning the results
+ * asynchronously.
+ *
+ * This function is the same as #wasmtime_func_call except that it is
+ * asynchronous. This is only compatible with stores associated with an
+ * asynchronous config.
+ *
+ * The result is a future that is owned by the caller and must be deleted via
+ * #wasmtime_call_future_delete.
+ *
+ * The `args` and `results` pointers may be `NULL` if the corresponding length
+ * is zero. The `trap_ret` and `error_ret` pointers may *not* be `NULL`.
+ *
+ * Does not take ownership of #wasmtime_val_t arguments or #wasmtime_val_t
+ * results, and all parameters to this function must be kept alive and not
+ * modified until the returned #wasmtime_call_future_t is deleted. This includes
+ * the context and store parameters. Only a single future can be alive for a
+ * given store at a single time (meaning only call this function after the
+ * previous call's future was deleted).
+ *
+ * See the header documentation for more information.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Func.html#method.call_async
+ */
+WASM_API_EXTERN wasmtime_call_future_t* wasmtime_func_call_async(
+    wasmtime_context_t *context,
+    const wasmtime_func_t *func,
+    const wasmtime_val_t *args,
+    size_t nargs,
+    wasmtime_val_t *results,
+    size_t nresults,
+    wasm_trap_t** trap_ret,
+    wasmtime_error_t** error_ret);
+
+/**
+ * \brief Creates a new host-defined function whose callback may complete
+ * asynchronously.
+ *
+ * This function is the same as #wasmtime_func_new except that the callback
+ * can return a continuation which is polled until the host call has
+ * completed. WebAssembly calling this function is suspended in the meantime.
+ *
+ * This function requires that the store was created with an asynchronous
+ * config, and the returned function can only be called through
+ * #wasmtime_func_call_async or from other WebAssembly running asynchronously.
+ */
+WASM_API_EXTERN void wasmtime_func_new_async(
+    wasmtime_context_t *store,
+    const wasm_functype_t* type,
+    wasmtime_func_async_callback_t callback,
+    void *env,
+    void (*finalizer)(void*),
+    wasmtime_func_t *ret
+);
+
+/**
+ * \brief Defines a new async function in this linker.
+ *
+ * This function behaves similar to #wasmtime_linker_define_func, except it
+ * supports async callbacks.
+ *
+ * The callback `cb` will be invoked on another stack (fiber for Windows).
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_linker_define_async_func(
+    wasmtime_linker_t *linker,
+    const char *module,
+    size_t module_len,
+    const char *name,
+    size_t name_len,
+    const wasm_functype_t *ty,
+    wasmtime_func_async_callback_t cb,
+    void *data,
+    void (*finalizer)(void *));
+
+/**
+ * \brief Instantiates a #wasm_module_t with the items defined in this linker
+ * for an async store.
+ *
+ * This is the same as #wasmtime_linker_instantiate but used for async stores
+ * (which requires functions are called asynchronously). The returning
+ * #wasmtime_call_future_t must be polled using #wasmtime_call_future_poll, and
+ * is owned and must be deleted using #wasmtime_call_future_delete.
+ *
+ * The `trap_ret` and `error_ret` pointers may *not* be `NULL` and the returned
+ * memory is owned by the caller.
+ *
+ * All arguments to this function must outlive the returned future and be
+ * unmodified until the future is deleted.
+ */
+WASM_API_EXTERN wasmtime_call_future_t *wasmtime_linker_instantiate_async(
+    const wasmtime_linker_t *linker,
+    wasmtime_context_t *store,
+    const wasmtime_module_t *module,
+    wasmtime_instance_t *instance,
+    wasm_trap_t** trap_ret,
+    wasmtime_error_t** error_ret);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif // WASMTIME_ASYNC_H
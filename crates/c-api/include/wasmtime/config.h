@@ -80,6 +80,10 @@ enum wasmtime_profiling_strategy_enum { // ProfilingStrategy
   ///
   /// Note that this isn't always enabled at build time.
   WASMTIME_PROFILING_STRATEGY_VTUNE,
+  /// Symbols for JIT code are appended to `/tmp/perf-<pid>.map` which `perf`
+  /// reads directly, without needing `perf inject`. This only has an effect on
+  /// Linux.
+  WASMTIME_PROFILING_STRATEGY_PERFMAP,
 };
 
 #define WASMTIME_CONFIG_PROP(ret, name, ty) \
@@ -96,6 +100,66 @@ enum wasmtime_profiling_strategy_enum { // ProfilingStrategy
  */
 WASMTIME_CONFIG_PROP(void, debug_info, bool)
 
+/**
+ * \brief Configures whether DWARF debug information is registered with native
+ * debuggers lazily.
+ *
+ * This setting is `false` by default. When enabled, modules compiled with
+ * #wasmtime_config_debug_info_set only have their debug information built and
+ * registered with debuggers at load time if a debugger is attached to the
+ * process (which is only detected on Linux). Otherwise registration is
+ * deferred until #wasmtime_module_register_debug is called, which avoids the
+ * cost of registration when many modules are loaded.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.lazy_debug_registration.
+ */
+WASMTIME_CONFIG_PROP(void, lazy_debug_registration, bool)
+
+/**
+ * \brief Configures whether modules loaded from files share their compiled
+ * code with other engines in the process.
+ *
+ * This setting is `false` by default. When enabled, a file loaded with
+ * #wasmtime_module_deserialize_file which is already loaded by another engine
+ * that also enabled this setting reuses that engine's mapping of the file and
+ * compiled module metadata instead of creating new ones. Files loaded by
+ * separate processes already share their pages through the page cache. This
+ * has no effect on platforms other than Unix.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.share_deserialized_code.
+ */
+WASMTIME_CONFIG_PROP(void, share_deserialized_code, bool)
+
+/**
+ * \brief Configures whether a backtrace is captured when WebAssembly traps.
+ *
+ * This setting is `true` by default. Capturing a backtrace walks the native
+ * stack, which can dominate the cost of a trap. When disabled, traps raised by
+ * WebAssembly have no frames, so #wasm_trap_trace returns an empty list and
+ * #wasm_trap_origin returns `NULL`, but trapping is much cheaper. This is
+ * useful when traps are used as routine control flow.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.wasm_backtrace.
+ */
+WASMTIME_CONFIG_PROP(void, wasm_backtrace, bool)
+
+/**
+ * \brief Configures whether backtraces are symbolicated with debug information
+ * from the wasm module.
+ *
+ * When enabled, modules retain the DWARF found in wasm binaries and use it to
+ * provide filename and line number information for frames of a trap's
+ * backtrace. By default this is controlled by the `WASMTIME_BACKTRACE_DETAILS`
+ * environment variable, and calling this function overrides that.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.wasm_backtrace_details.
+ */
+WASMTIME_CONFIG_PROP(void, wasm_backtrace_details, bool)
+
 /**
  * \brief Whether or not fuel is enabled for generated code.
  *
@@ -220,6 +284,77 @@ WASMTIME_CONFIG_PROP(void, cranelift_debug_verifier, bool)
  */
 WASMTIME_CONFIG_PROP(void, cranelift_opt_level, wasmtime_opt_level_t)
 
+/**
+ * \brief Configures the optimization level used by
+ * #wasmtime_module_new_tier_up.
+ *
+ * This enables tiered compilation: a module can be compiled quickly at the
+ * level configured with #wasmtime_config_cranelift_opt_level_set to start
+ * running immediately, and then recompiled in the background at this level
+ * with #wasmtime_module_new_tier_up for use in future instantiations.
+ *
+ * This setting is #WASMTIME_OPT_LEVEL_SPEED by default.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.cranelift_tier_up_opt_level.
+ */
+WASMTIME_CONFIG_PROP(void, cranelift_tier_up_opt_level, wasmtime_opt_level_t)
+
+/**
+ * \brief Configures the target triple that code is compiled for.
+ *
+ * By default this is the host's triple and compiled code is tuned for the CPU
+ * features detected on the host. Once a target is set, even the host's own
+ * triple, CPU features are no longer detected and must be enabled explicitly
+ * with #wasmtime_config_cranelift_flag_enable. Setting a target also resets
+ * any target-specific cranelift flags configured so far, so it should be
+ * called first.
+ *
+ * An engine configured for a target other than the host can only be used to
+ * precompile modules, for example with #wasmtime_module_serialize. Such
+ * modules are rejected by #wasmtime_module_new and #wasmtime_module_deserialize
+ * on the compiling machine.
+ *
+ * An error is returned if the target isn't a valid triple or isn't supported.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.target.
+ */
+WASM_API_EXTERN wasmtime_error_t* wasmtime_config_target_set(wasm_config_t*, const char *target);
+
+/**
+ * \brief Sets a target-specific or shared cranelift flag to `value`.
+ *
+ * This can be used, for example, to tune code compiled for a target configured
+ * with #wasmtime_config_target_set to the exact CPU features of the machines it
+ * will run on.
+ *
+ * An error is returned if the flag doesn't exist or `value` isn't valid for it.
+ *
+ * This function is unsafe in the same way as the Rust version: some flags
+ * change the code generated in ways Wasmtime relies on, and setting them may
+ * lead to incorrect code or memory unsafety.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.cranelift_flag_set.
+ */
+WASM_API_EXTERN wasmtime_error_t* wasmtime_config_cranelift_flag_set(wasm_config_t*, const char *key, const char *value);
+
+/**
+ * \brief Enables a target-specific or shared boolean cranelift flag, such as
+ * `has_avx2` or `has_bmi2` on x86_64.
+ *
+ * A module compiled with a CPU feature enabled is checked against the host's
+ * features when it's loaded with #wasmtime_module_deserialize, which returns
+ * an error if the host doesn't support the feature.
+ *
+ * An error is returned if the flag doesn't exist or isn't a boolean flag.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.cranelift_flag_enable.
+ */
+WASM_API_EXTERN wasmtime_error_t* wasmtime_config_cranelift_flag_enable(wasm_config_t*, const char *flag);
+
 /**
  * \brief Configures the profiling strategy used for JIT code.
  *
@@ -230,11 +365,39 @@ WASMTIME_CONFIG_PROP(wasmtime_error_t*, profiler, wasmtime_profiling_strategy_t)
 /**
  * \brief Configures the maximum size for memory to be considered "static"
  *
+ * By default each linear memory on 64-bit platforms reserves 4GiB of virtual
+ * address space plus a 2GiB guard region, which allows bounds checks to be
+ * elided from compiled code but limits how many instances fit in one
+ * process's address space. Guests which only need a small amount of memory can
+ * instead use a compact reservation by configuring, for example:
+ *
+ * * #wasmtime_config_static_memory_maximum_size_set to `0`, so memories are
+ *   "dynamic" and only reserve their current size,
+ * * #wasmtime_config_dynamic_memory_guard_size_set and
+ *   #wasmtime_config_dynamic_memory_reserved_for_growth_set to small values,
+ *   such as 64KiB, and
+ * * #wasmtime_config_guard_before_linear_memory_set to `false`.
+ *
+ * Compiled code has explicit bounds checks in this configuration. These
+ * settings are baked into the machine code of each module, which is why they're
+ * configured per engine rather than per store or per instance. To use compact
+ * reservations for only some guests, create a separate engine with these
+ * settings for those guests' modules and stores; any number of engines may be
+ * used within one process.
+ *
  * For more information see the Rust documentation at
  * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.static_memory_maximum_size.
  */
 WASMTIME_CONFIG_PROP(void, static_memory_maximum_size, uint64_t)
 
+/**
+ * \brief Configures whether all memories are forced to be "static".
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.static_memory_forced.
+ */
+WASMTIME_CONFIG_PROP(void, static_memory_forced, bool)
+
 /**
  * \brief Configures the guard region size for "static" memory.
  *
@@ -251,6 +414,106 @@ WASMTIME_CONFIG_PROP(void, static_memory_guard_size, uint64_t)
  */
 WASMTIME_CONFIG_PROP(void, dynamic_memory_guard_size, uint64_t)
 
+/**
+ * \brief Configures the size, in bytes, of the extra virtual memory space
+ * reserved after a "dynamic" memory for growing into.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.dynamic_memory_reserved_for_growth.
+ */
+WASMTIME_CONFIG_PROP(void, dynamic_memory_reserved_for_growth, uint64_t)
+
+/**
+ * \brief Configures whether a guard region is placed before linear memory as
+ * well as after it.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.guard_before_linear_memory.
+ */
+WASMTIME_CONFIG_PROP(void, guard_before_linear_memory, bool)
+
+/**
+ * \brief Configures whether copy-on-write memory-mapped data is used to
+ * initialize linear memories.
+ *
+ * This setting is `true` by default. When enabled, modules which meet the
+ * necessary criteria have their initial heap contents mapped into linear memory
+ * instead of copying data segments on each instantiation. Use
+ * #wasmtime_module_has_memory_image to check whether a module uses this path.
+ *
+ * Note that this isn't always enabled at build time.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.memory_init_cow.
+ */
+WASMTIME_CONFIG_PROP(void, memory_init_cow, bool)
+
+/**
+ * \brief Configures whether `memfd_create` is always used on Linux to back a
+ * module's initial memory image.
+ *
+ * This setting is `false` by default, in which case the image of a module
+ * deserialized from a file is mapped from that file instead.
+ *
+ * Note that this isn't always enabled at build time.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.force_memory_init_memfd.
+ */
+WASMTIME_CONFIG_PROP(void, force_memory_init_memfd, bool)
+
+/**
+ * \brief Configures the size, in bytes, of initialized data up to which a
+ * copy-on-write memory image is always created.
+ *
+ * This setting is 16 MiB by default.
+ *
+ * Note that this isn't always enabled at build time.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.memory_guaranteed_dense_image_size.
+ */
+WASMTIME_CONFIG_PROP(void, memory_guaranteed_dense_image_size, uint64_t)
+
+/**
+ * \brief Configures whether linear memories are initialized a page at a time
+ * rather than by copying individual data segments.
+ *
+ * This setting is `false` by default.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.paged_memory_initialization.
+ */
+WASMTIME_CONFIG_PROP(void, paged_memory_initialization, bool)
+
+/**
+ * \brief Configures whether functions within a module are compiled in parallel
+ * using multiple threads.
+ *
+ * This setting is `true` by default. Note that this isn't always enabled at
+ * build time.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.parallel_compilation.
+ */
+WASMTIME_CONFIG_PROP(void, parallel_compilation, bool)
+
+/**
+ * \brief Configures the maximum number of threads that an engine uses to
+ * compile modules in parallel.
+ *
+ * When nonzero the engine created from this configuration uses its own pool of
+ * at most this many threads for compilation instead of a process-wide pool
+ * sized to the number of CPUs. This setting is 0 by default, which uses the
+ * process-wide pool. It has no effect if parallel compilation is disabled.
+ *
+ * Note that this isn't always enabled at build time.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.parallel_compilation_threads.
+ */
+WASMTIME_CONFIG_PROP(void, parallel_compilation_threads, size_t)
+
 /**
  * \brief Enables Wasmtime's cache and loads configuration from the specified
  * path.
@@ -265,6 +528,207 @@ WASMTIME_CONFIG_PROP(void, dynamic_memory_guard_size, uint64_t)
  */
 WASM_API_EXTERN wasmtime_error_t* wasmtime_config_cache_config_load(wasm_config_t*, const char*);
 
+/**
+ * \brief Callback used to look up a compiled module in a custom cache store.
+ *
+ * The first argument is the `env` pointer given to
+ * #wasmtime_config_cache_store_set, followed by the key (not nul-terminated)
+ * and its length in bytes. If an artifact is found for the key then it should
+ * be written to the final argument, typically with #wasm_byte_vec_new, and
+ * `true` returned. Ownership of the vector is transferred to Wasmtime.
+ * Otherwise `false` should be returned and the final argument left untouched.
+ */
+typedef bool (*wasmtime_cache_store_get_callback_t)(
+    void *env, const uint8_t *key, size_t key_len, wasm_byte_vec_t *value);
+
+/**
+ * \brief Callback used to insert a compiled module into a custom cache store.
+ *
+ * The first argument is the `env` pointer given to
+ * #wasmtime_config_cache_store_set, followed by the key and its length in
+ * bytes and the artifact and its length in bytes. Both buffers are only valid
+ * for the duration of the call. Returns whether the artifact was stored.
+ */
+typedef bool (*wasmtime_cache_store_insert_callback_t)(
+    void *env, const uint8_t *key, size_t key_len, const uint8_t *value,
+    size_t value_len);
+
+/**
+ * \brief Configures a custom storage backend for compiled modules.
+ *
+ * When set, #wasmtime_module_new and related functions consult `get` before
+ * compiling a module and call `insert` with the compiled artifact after a
+ * cache miss. This takes precedence over the filesystem cache configured with
+ * #wasmtime_config_cache_config_load.
+ *
+ * The callbacks may be invoked concurrently from any thread, so `env` must be
+ * safe to share between threads. The `finalizer`, if not `NULL`, is invoked
+ * with `env` once the configuration and all engines created from it have been
+ * deleted.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.cache_store.
+ */
+WASM_API_EXTERN void wasmtime_config_cache_store_set(
+    wasm_config_t *config,
+    wasmtime_cache_store_get_callback_t get,
+    wasmtime_cache_store_insert_callback_t insert,
+    void *env,
+    void (*finalizer)(void*));
+
+/**
+ * \brief Specifier for how Wasmtime allocates instances, values are in
+ * #wasmtime_instance_allocation_strategy_enum
+ */
+typedef uint8_t wasmtime_instance_allocation_strategy_t;
+
+/**
+ * \brief Different ways that Wasmtime can allocate the resources of an
+ * instance.
+ *
+ * The default value is #WASMTIME_INSTANCE_ALLOCATION_STRATEGY_ON_DEMAND.
+ */
+enum wasmtime_instance_allocation_strategy_enum { // InstanceAllocationStrategy
+  /// Resources related to an instance are allocated at instantiation time and
+  /// deallocated when the owning store is deleted.
+  WASMTIME_INSTANCE_ALLOCATION_STRATEGY_ON_DEMAND,
+  /// A pool of resources is reserved when the engine is created, and
+  /// instantiation reuses slots from that pool. Slots are returned to the pool
+  /// when the owning store is deleted.
+  ///
+  /// Note that this isn't always enabled at build time.
+  WASMTIME_INSTANCE_ALLOCATION_STRATEGY_POOLING,
+};
+
+/**
+ * \brief Specifier for how the pooling allocator picks a free slot, values are
+ * in #wasmtime_pooling_allocation_strategy_enum
+ */
+typedef uint8_t wasmtime_pooling_allocation_strategy_t;
+
+/**
+ * \brief Different ways the pooling allocator can pick a free instance slot.
+ *
+ * The default is #WASMTIME_POOLING_ALLOCATION_STRATEGY_REUSE_AFFINITY when
+ * copy-on-write memory initialization is available, and
+ * #WASMTIME_POOLING_ALLOCATION_STRATEGY_NEXT_AVAILABLE otherwise.
+ */
+enum wasmtime_pooling_allocation_strategy_enum { // PoolingAllocationStrategy
+  /// Allocate from the next available instance slot.
+  WASMTIME_POOLING_ALLOCATION_STRATEGY_NEXT_AVAILABLE,
+  /// Allocate from a random available instance slot.
+  WASMTIME_POOLING_ALLOCATION_STRATEGY_RANDOM,
+  /// Try to allocate a slot that was previously used for the same module,
+  /// which can allow memory mappings to be reused.
+  WASMTIME_POOLING_ALLOCATION_STRATEGY_REUSE_AFFINITY,
+};
+
+/**
+ * \typedef wasmtime_pooling_allocation_config_t
+ * \brief Convenience alias for #wasmtime_pooling_allocation_config
+ *
+ * \struct wasmtime_pooling_allocation_config
+ * \brief Limits and settings for the pooling instance allocator.
+ *
+ * This corresponds to `InstanceLimits` and `PoolingAllocationStrategy` in the
+ * Rust API. A newly created configuration has the same defaults as the Rust
+ * API. It is passed to #wasmtime_config_allocation_strategy_set, which copies
+ * it, so it may be deleted afterwards with
+ * #wasmtime_pooling_allocation_config_delete.
+ */
+typedef struct wasmtime_pooling_allocation_config wasmtime_pooling_allocation_config_t;
+
+/**
+ * \brief Creates a new pooling allocation configuration with default settings.
+ *
+ * The caller owns the returned value and must delete it with
+ * #wasmtime_pooling_allocation_config_delete.
+ */
+WASM_API_EXTERN wasmtime_pooling_allocation_config_t *wasmtime_pooling_allocation_config_new();
+
+/**
+ * \brief Deletes a pooling allocation configuration.
+ */
+WASM_API_EXTERN void wasmtime_pooling_allocation_config_delete(wasmtime_pooling_allocation_config_t*);
+
+#define WASMTIME_POOLING_ALLOCATION_CONFIG_PROP(name, ty) \
+    WASM_API_EXTERN void wasmtime_pooling_allocation_config_##name##_set(wasmtime_pooling_allocation_config_t*, ty);
+
+/**
+ * \brief Configures how free instance slots are picked.
+ */
+WASMTIME_POOLING_ALLOCATION_CONFIG_PROP(strategy, wasmtime_pooling_allocation_strategy_t)
+
+/**
+ * \brief Configures the maximum number of concurrent instances.
+ *
+ * This defaults to 1000. It also bounds the number of async stacks that can be
+ * used at once.
+ */
+WASMTIME_POOLING_ALLOCATION_CONFIG_PROP(instance_count, uint32_t)
+
+/**
+ * \brief Configures the maximum size, in bytes, of an instance and its
+ * `VMContext`.
+ *
+ * This defaults to 1 MiB.
+ */
+WASMTIME_POOLING_ALLOCATION_CONFIG_PROP(instance_size, size_t)
+
+/**
+ * \brief Configures the maximum number of defined tables per module.
+ *
+ * This defaults to 1.
+ */
+WASMTIME_POOLING_ALLOCATION_CONFIG_PROP(instance_tables, uint32_t)
+
+/**
+ * \brief Configures the maximum number of elements of any defined table.
+ *
+ * This defaults to 10000.
+ */
+WASMTIME_POOLING_ALLOCATION_CONFIG_PROP(instance_table_elements, uint32_t)
+
+/**
+ * \brief Configures the maximum number of defined linear memories per module.
+ *
+ * This defaults to 1.
+ */
+WASMTIME_POOLING_ALLOCATION_CONFIG_PROP(instance_memories, uint32_t)
+
+/**
+ * \brief Configures the maximum number of WebAssembly pages of any defined
+ * linear memory.
+ *
+ * This defaults to 160 (10 MiB). It cannot exceed the size configured with
+ * #wasmtime_config_static_memory_maximum_size_set.
+ */
+WASMTIME_POOLING_ALLOCATION_CONFIG_PROP(instance_memory_pages, uint64_t)
+
+/**
+ * \brief Configures how instances are allocated.
+ *
+ * \param config the configuration to modify
+ * \param strategy the allocation strategy to use
+ * \param pooling settings for the pooling allocator, ignored for other
+ * strategies. If this is `NULL` the default pooling settings are used.
+ *
+ * This setting is #WASMTIME_INSTANCE_ALLOCATION_STRATEGY_ON_DEMAND by default.
+ * With #WASMTIME_INSTANCE_ALLOCATION_STRATEGY_POOLING all linear memories are
+ * "static", and the pool is reserved when the engine is created.
+ *
+ * An error is returned if the pooling allocator was not enabled when the C API
+ * was built. This function does not take ownership of `pooling`.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Config.html#method.allocation_strategy.
+ */
+WASM_API_EXTERN wasmtime_error_t* wasmtime_config_allocation_strategy_set(
+    wasm_config_t *config,
+    wasmtime_instance_allocation_strategy_t strategy,
+    const wasmtime_pooling_allocation_config_t *pooling
+);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
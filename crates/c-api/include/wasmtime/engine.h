@@ -8,6 +8,7 @@
 #define WASMTIME_ENGINE_H
 
 #include <wasm.h>
+#include <wasmtime/error.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -27,6 +28,29 @@ extern "C" {
  */
 WASM_API_EXTERN void wasmtime_engine_increment_epoch(wasm_engine_t *engine);
 
+/**
+ * \brief Starts a background thread which increments the engine's epoch every
+ * `interval_ns` nanoseconds.
+ *
+ * This replaces having to call #wasmtime_engine_increment_epoch from a thread
+ * managed by the embedder. Calling this function again replaces the ticker with
+ * one using the new interval. The thread is stopped by
+ * #wasmtime_engine_stop_epoch_ticker or when the engine is deleted.
+ *
+ * Returns an error if `interval_ns` is zero or the thread could not be
+ * spawned.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Engine.html#method.start_epoch_ticker
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_engine_start_epoch_ticker(wasm_engine_t *engine, uint64_t interval_ns);
+
+/**
+ * \brief Stops the thread started by #wasmtime_engine_start_epoch_ticker, if
+ * any.
+ */
+WASM_API_EXTERN void wasmtime_engine_stop_epoch_ticker(wasm_engine_t *engine);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -30,6 +30,17 @@ extern "C" {
  */
 typedef struct wasmtime_error wasmtime_error_t;
 
+/**
+ * \brief Creates a new error with the provided message.
+ *
+ * This is useful to return from callbacks such as
+ * #wasmtime_out_of_fuel_callback_t, where returning an error raises a trap in
+ * the executing WebAssembly. The `message` is a NUL-terminated string which is
+ * copied into the error. The returned error must be deleted with
+ * #wasmtime_error_delete unless ownership is transferred elsewhere.
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_error_new(const char *message);
+
 /**
  * \brief Deletes an error.
  */
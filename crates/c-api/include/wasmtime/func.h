@@ -244,6 +244,112 @@ WASM_API_EXTERN wasm_trap_t *wasmtime_func_call_unchecked(
     wasmtime_val_raw_t *args_and_results
 );
 
+/**
+ * \brief Calls a WebAssembly function many times in an "unchecked" fashion.
+ *
+ * \param store the store that owns `func`
+ * \param func the function to call
+ * \param args_and_results `count` blocks of `stride` values each
+ * \param stride the number of #wasmtime_val_raw_t values in each block
+ * \param count the number of times to call `func`
+ * \param trap_index where to store the index of the trapping call, if any
+ *
+ * This is a batched version of #wasmtime_func_call_unchecked. The `i`th call
+ * reads its parameters from, and writes its results to, the block starting at
+ * `args_and_results + i * stride` with the same layout as
+ * #wasmtime_func_call_unchecked. All calls are made within a single entry into
+ * WebAssembly, so the cost of setting up trap handling and updating store
+ * state is paid once for the whole batch rather than once per call.
+ *
+ * Calls are made in order. If one of them traps then no further calls are made,
+ * the index of the trapping call is written to `trap_index`, and the trap is
+ * returned (and owned by the caller). Blocks of calls before the trapping one
+ * contain their results. On success `NULL` is returned and `trap_index` is not
+ * written.
+ *
+ * All of the safety requirements of #wasmtime_func_call_unchecked apply to
+ * each of the `count` blocks, and `stride` must be large enough that each
+ * block can hold all the parameters and all the results of `func`.
+ */
+WASM_API_EXTERN wasm_trap_t *wasmtime_func_call_batch(
+    wasmtime_context_t *store,
+    const wasmtime_func_t *func,
+    wasmtime_val_raw_t *args_and_results,
+    size_t stride,
+    size_t count,
+    size_t *trap_index
+);
+
+/**
+ * \brief A function whose signature has been validated ahead of time.
+ *
+ * This type is created with #wasmtime_typed_func_new and is intended for hot
+ * paths which call the same function many times. Type-checking happens once
+ * during construction which means that #wasmtime_typed_func_call performs no
+ * per-call validation, conversion, or allocation.
+ *
+ * Instances of this type are owned by the embedder and must be deallocated
+ * with #wasmtime_typed_func_delete.
+ */
+typedef struct wasmtime_typed_func wasmtime_typed_func_t;
+
+/**
+ * \brief Deallocates a #wasmtime_typed_func_t.
+ */
+WASM_API_EXTERN void wasmtime_typed_func_delete(wasmtime_typed_func_t *func);
+
+/**
+ * \brief Creates a #wasmtime_typed_func_t from a function and its expected type.
+ *
+ * \param store the store that owns `func`
+ * \param func the function to wrap
+ * \param ty the type that `func` is expected to have
+ * \param ret where to store the resulting typed function on success
+ *
+ * This function checks that the type of `func` exactly matches `ty`. If it
+ * does not then an error is returned and `ret` is not written. The `ty`
+ * argument is not taken ownership of. On success the returned typed function
+ * must be deallocated with #wasmtime_typed_func_delete.
+ *
+ * The returned value is only valid for use with the `store` that owns `func`.
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_typed_func_new(
+    const wasmtime_context_t *store,
+    const wasmtime_func_t *func,
+    const wasm_functype_t *ty,
+    wasmtime_typed_func_t **ret
+);
+
+/**
+ * \brief Returns the number of #wasmtime_val_raw_t slots required to call
+ * the typed function.
+ *
+ * This is the maximum of the function's parameter count and result count and
+ * is the minimum length of the `args_and_results` buffer passed to
+ * #wasmtime_typed_func_call.
+ */
+WASM_API_EXTERN size_t wasmtime_typed_func_args_and_results_len(const wasmtime_typed_func_t *func);
+
+/**
+ * \brief Calls a #wasmtime_typed_func_t.
+ *
+ * This function has the same semantics and calling convention as
+ * #wasmtime_func_call_unchecked except that the function's signature has
+ * already been validated against the type provided to #wasmtime_typed_func_new.
+ * Callers are still responsible for ensuring that `args_and_results` has at
+ * least #wasmtime_typed_func_args_and_results_len slots, that all parameters
+ * contain values of the expected types, and that `store` is the same store
+ * the typed function was created with.
+ *
+ * Returns `NULL` on success or a trap if the function trapped, which is owned
+ * by the caller.
+ */
+WASM_API_EXTERN wasm_trap_t *wasmtime_typed_func_call(
+    wasmtime_context_t *store,
+    const wasmtime_typed_func_t *func,
+    wasmtime_val_raw_t *args_and_results
+);
+
 /**
  * \brief Loads a #wasmtime_extern_t from the caller's context
  *
@@ -269,6 +375,28 @@ WASM_API_EXTERN bool wasmtime_caller_export_get(
     wasmtime_extern_t *item
 );
 
+/**
+ * \brief Loads a #wasmtime_extern_t from the caller's context by index
+ *
+ * This is the same as #wasmtime_caller_export_get except that the export is
+ * identified by its index in the caller's module, as returned by
+ * #wasmtime_module_export_index, rather than looked up by name on each call.
+ * Note that an index resolved with a module other than the caller's may refer
+ * to an unrelated export.
+ *
+ * \param caller the caller object to look up the export from
+ * \param index the index of the export
+ * \param item where to store the return value
+ *
+ * Returns a nonzero value if the export was found, or 0 if the export wasn't
+ * found. If the export wasn't found then `item` isn't written to.
+ */
+WASM_API_EXTERN bool wasmtime_caller_export_get_by_index(
+    wasmtime_caller_t *caller,
+    size_t index,
+    wasmtime_extern_t *item
+);
+
 /**
  * \brief Returns the store context of the caller object.
  */
@@ -84,6 +84,85 @@ WASM_API_EXTERN wasmtime_error_t *wasmtime_global_set(
     const wasmtime_val_t *val
 );
 
+/**
+ * \brief Returns a pointer to the storage of a global's value.
+ *
+ * \param store the store that owns `global`
+ * \param global the global whose storage to return
+ *
+ * Reading a global through the returned pointer is a plain load, without the
+ * type checks and conversions of #wasmtime_global_get, which makes it suitable
+ * for polling globals such as counters after every call. The pointer remains
+ * valid for as long as the store is alive, and WebAssembly updates the value
+ * in-place.
+ *
+ * The value is stored in native endianness: an `i32` or `f32` occupies the
+ * first 4 bytes, an `i64` or `f64` the first 8 bytes, and a `v128` all 16
+ * bytes. For `externref` and `funcref` globals `NULL` is returned since their
+ * storage is an internal representation.
+ *
+ * The value may only be written through the pointer if the global is mutable,
+ * and the pointer must not be used while the store is in use on another
+ * thread.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Global.html#method.data_ptr
+ */
+WASM_API_EXTERN void *wasmtime_global_ptr(
+    const wasmtime_context_t *store,
+    const wasmtime_global_t *global
+);
+
+/**
+ * \brief Gets the value of an `i32` global.
+ *
+ * \param store the store that owns `global`
+ * \param global the global to get
+ * \param out where to store the value of the global
+ *
+ * Returns `false`, leaving `out` untouched, if `global` doesn't have the type
+ * `i32`. Unlike #wasmtime_global_get this doesn't go through a
+ * #wasmtime_val_t.
+ */
+WASM_API_EXTERN bool wasmtime_global_get_i32(
+    const wasmtime_context_t *store,
+    const wasmtime_global_t *global,
+    int32_t *out
+);
+
+/**
+ * \brief Gets the value of an `i64` global.
+ *
+ * Same as #wasmtime_global_get_i32, but for `i64` globals.
+ */
+WASM_API_EXTERN bool wasmtime_global_get_i64(
+    const wasmtime_context_t *store,
+    const wasmtime_global_t *global,
+    int64_t *out
+);
+
+/**
+ * \brief Gets the value of an `f32` global.
+ *
+ * Same as #wasmtime_global_get_i32, but for `f32` globals.
+ */
+WASM_API_EXTERN bool wasmtime_global_get_f32(
+    const wasmtime_context_t *store,
+    const wasmtime_global_t *global,
+    float32_t *out
+);
+
+/**
+ * \brief Gets the value of an `f64` global.
+ *
+ * Same as #wasmtime_global_get_i32, but for `f64` globals.
+ */
+WASM_API_EXTERN bool wasmtime_global_get_f64(
+    const wasmtime_context_t *store,
+    const wasmtime_global_t *global,
+    float64_t *out
+);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
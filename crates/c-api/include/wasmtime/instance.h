@@ -94,6 +94,70 @@ WASM_API_EXTERN bool wasmtime_instance_export_get(
     wasmtime_extern_t *item
 );
 
+/**
+ * \brief Get an export by its index in the instance's module.
+ *
+ * \param store the store that owns `instance`
+ * \param instance the instance to lookup within
+ * \param index the index of the export, as returned by
+ *        #wasmtime_module_export_index for the module of `instance`
+ * \param item where to store the export itself
+ *
+ * Returns nonzero if `index` is in bounds and `item` is filled in. Otherwise
+ * returns 0.
+ *
+ * Unlike #wasmtime_instance_export_get this doesn't look up the export by
+ * name, so resolving the index once per module with
+ * #wasmtime_module_export_index makes repeated lookups cheap. Note that an
+ * index resolved with a different module may refer to an unrelated export.
+ *
+ * Doesn't take ownership of any arguments but does return ownership of the
+ * #wasmtime_extern_t.
+ */
+WASM_API_EXTERN bool wasmtime_instance_export_get_by_index(
+    wasmtime_context_t *store,
+    const wasmtime_instance_t *instance,
+    size_t index,
+    wasmtime_extern_t *item
+);
+
+/**
+ * \brief Captures the current state of an instance as a new module.
+ *
+ * \param store the store that owns `instance`
+ * \param instance the instance to snapshot
+ * \param wasm the binary of the module `instance` was created from
+ * \param wasm_len the byte length of `wasm`
+ * \param ret where to store the returned module
+ *
+ * This is intended for guests which spend a long time in their start function
+ * before they're ready to serve requests. Instances of the returned module
+ * start out with the globals, memories, and tables defined by the module in
+ * the state they are in now, and without running the start function again.
+ * With copy-on-write memory initialization enabled (see
+ * #wasmtime_config_memory_init_cow_set) instantiating the snapshot maps its
+ * memory contents instead of copying them.
+ *
+ * Compiled modules don't retain their original binary, so the binary that
+ * `instance` was created from must be passed in as `wasm`. Imported items and
+ * host state are not part of the snapshot.
+ *
+ * Returns an error if `wasm` isn't the module of `instance` or if the state of
+ * `instance` can't be captured, for example because a table contains a
+ * non-null `externref`. Otherwise `ret` is filled in with a module owned by the
+ * caller.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Instance.html#method.snapshot
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_instance_snapshot(
+    wasmtime_context_t *store,
+    const wasmtime_instance_t *instance,
+    const uint8_t *wasm,
+    size_t wasm_len,
+    wasmtime_module_t **ret
+);
+
 /**
  * \brief Get an export by index from an instance.
  *
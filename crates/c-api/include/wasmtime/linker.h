@@ -42,6 +42,19 @@ typedef struct wasmtime_linker wasmtime_linker_t;
  */
 WASM_API_EXTERN wasmtime_linker_t* wasmtime_linker_new(wasm_engine_t* engine);
 
+/**
+ * \brief Creates a copy of a linker.
+ *
+ * The returned linker has all of the definitions and settings of `linker`, and
+ * the two can be modified independently afterwards. Host functions are shared
+ * between the copies rather than recreated, so this is a cheap way to stamp out
+ * many linkers from a single template linker, for example one per tenant.
+ *
+ * This function does not take ownership of the argument, and the caller is
+ * expected to delete the returned linker.
+ */
+WASM_API_EXTERN wasmtime_linker_t* wasmtime_linker_clone(const wasmtime_linker_t* linker);
+
 /**
  * \brief Deletes a linker
  */
@@ -117,6 +130,56 @@ WASM_API_EXTERN wasmtime_error_t* wasmtime_linker_define_func(
     void (*finalizer)(void*)
 );
 
+/**
+ * \brief A host function to define with #wasmtime_linker_define_func_table.
+ *
+ * The fields correspond to the arguments of #wasmtime_linker_define_func.
+ */
+typedef struct wasmtime_linker_func_entry {
+  /// The module name the function is defined under.
+  const char *module;
+  /// The byte length of `module`.
+  size_t module_len;
+  /// The field name the function is defined under.
+  const char *name;
+  /// The byte length of `name`.
+  size_t name_len;
+  /// The type of the function.
+  const wasm_functype_t *ty;
+  /// The host callback to invoke when the function is called.
+  wasmtime_func_callback_t callback;
+  /// The host-provided data to provide as the first argument to the callback.
+  void *data;
+  /// An optional finalizer for `data`.
+  void (*finalizer)(void*);
+} wasmtime_linker_func_entry_t;
+
+/**
+ * \brief Defines many functions in this linker at once.
+ *
+ * \param linker the linker the functions are being defined in.
+ * \param entries the functions to define
+ * \param len the number of elements in `entries`
+ *
+ * This is equivalent to calling #wasmtime_linker_define_func for each entry in
+ * order, but is more efficient for large numbers of functions. Functions which
+ * share a type share their compiled trampolines, and the linker's internal
+ * tables are sized for all of the entries up front.
+ *
+ * This function takes ownership of the `data` of every entry. If a definition
+ * fails then an error is returned and the finalizers of the entries which
+ * weren't defined are invoked, while the functions defined before the failing
+ * entry remain in the linker.
+ *
+ * \return On success `NULL` is returned, otherwise an error is returned which
+ * describes why a definition failed.
+ */
+WASM_API_EXTERN wasmtime_error_t* wasmtime_linker_define_func_table(
+    wasmtime_linker_t *linker,
+    const wasmtime_linker_func_entry_t *entries,
+    size_t len
+);
+
 /**
  * \brief Defines a new function in this linker.
  *
@@ -216,6 +279,80 @@ WASM_API_EXTERN wasmtime_error_t* wasmtime_linker_instantiate(
     wasm_trap_t **trap
 );
 
+/**
+ * \typedef wasmtime_instance_pre_t
+ * \brief Convenience alias for #wasmtime_instance_pre
+ *
+ * \struct wasmtime_instance_pre
+ * \brief A module whose imports have already been resolved and type-checked,
+ * ready to be instantiated.
+ *
+ * This is created with #wasmtime_linker_instantiate_pre and instantiated with
+ * #wasmtime_instance_pre_instantiate. Resolving imports by name and
+ * type-checking them is performed once up front, so each instantiation only
+ * needs to allocate and initialize the new instance. This pairs well with the
+ * pooling instance allocator for embeddings that instantiate the same module
+ * many times.
+ *
+ * Instances of this type must be deallocated with
+ * #wasmtime_instance_pre_delete.
+ */
+typedef struct wasmtime_instance_pre wasmtime_instance_pre_t;
+
+/**
+ * \brief Deallocates a #wasmtime_instance_pre_t.
+ */
+WASM_API_EXTERN void wasmtime_instance_pre_delete(wasmtime_instance_pre_t *instance_pre);
+
+/**
+ * \brief Resolves and type-checks the imports of a module ahead of time.
+ *
+ * \param linker the linker used to resolve the imports of `module`
+ * \param store the store that the resolved imports are looked up in
+ * \param module the module whose imports are resolved
+ * \param instance_pre where to store the resulting #wasmtime_instance_pre_t
+ *
+ * \return An error if any import of `module` isn't defined in `linker` or is
+ * defined with the wrong type, or `NULL` on success in which case
+ * `instance_pre` is filled in and is owned by the caller.
+ *
+ * If every import of `module` is satisfied by functions defined in `linker`
+ * with #wasmtime_linker_define_func or #wasmtime_linker_define_func_unchecked,
+ * the result isn't tied to `store` and can be instantiated in any store
+ * belonging to the same engine. Otherwise it can only be instantiated within
+ * `store`, since it refers to items owned by `store`.
+ *
+ * This function does not take ownership of any of its arguments.
+ */
+WASM_API_EXTERN wasmtime_error_t* wasmtime_linker_instantiate_pre(
+    const wasmtime_linker_t *linker,
+    wasmtime_context_t *store,
+    const wasmtime_module_t *module,
+    wasmtime_instance_pre_t **instance_pre
+);
+
+/**
+ * \brief Instantiates a #wasmtime_instance_pre_t within a store.
+ *
+ * \param instance_pre the pre-resolved module to instantiate
+ * \param store the store to create the instance within
+ * \param instance the returned instance, if successful.
+ * \param trap a trap returned, if the start function traps.
+ *
+ * \return This function has the same return semantics as
+ * #wasmtime_linker_instantiate. An error is returned if `instance_pre` refers
+ * to items owned by a different store than `store`.
+ *
+ * The `store` provided must belong to the same engine as the linker that
+ * `instance_pre` was created with.
+ */
+WASM_API_EXTERN wasmtime_error_t* wasmtime_instance_pre_instantiate(
+    const wasmtime_instance_pre_t *instance_pre,
+    wasmtime_context_t *store,
+    wasmtime_instance_t *instance,
+    wasm_trap_t **trap
+);
+
 /**
  * \brief Defines automatic instantiations of a #wasm_module_t in this linker.
  *
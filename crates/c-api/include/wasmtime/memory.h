@@ -116,6 +116,140 @@ WASM_API_EXTERN wasmtime_error_t *wasmtime_memory_grow(
     uint64_t *prev_size
 );
 
+/**
+ * \brief Zeroes a range of a memory, releasing the pages backing it.
+ *
+ * \param store the store that owns `memory`
+ * \param memory the memory to decommit a range of
+ * \param offset the byte offset of the start of the range
+ * \param len the length of the range, in bytes
+ *
+ * The size of the memory is unchanged. Pages wholly within the range are
+ * returned to the operating system and read as zero afterwards, while the
+ * bytes of partially covered pages are zeroed in place. This lets embedders
+ * shrink a long-running instance back to its working set without dropping it.
+ *
+ * Returns an error if the range is out of bounds, in which case nothing is
+ * zeroed, and `NULL` otherwise.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Memory.html#method.decommit.
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_memory_decommit_range(
+    wasmtime_context_t *store,
+    const wasmtime_memory_t *memory,
+    size_t offset,
+    size_t len
+);
+
+/**
+ * \brief Zeroes all of a memory, releasing the pages backing it.
+ *
+ * This is the same as #wasmtime_memory_decommit_range with the whole current
+ * size of `memory`.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Memory.html#method.reset.
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_memory_reset(
+    wasmtime_context_t *store,
+    const wasmtime_memory_t *memory
+);
+
+/**
+ * \brief Copies bytes out of a linear memory with a bounds check.
+ *
+ * \param store the store that owns `memory`
+ * \param memory the memory to read from
+ * \param offset the byte offset within linear memory to start reading at
+ * \param buf where to copy the bytes to
+ * \param len the number of bytes to copy
+ *
+ * Returns `false`, leaving `buf` untouched, if `offset + len` exceeds the
+ * current size of the memory. Unlike a pointer returned by
+ * #wasmtime_memory_data this doesn't need to be refreshed after the memory is
+ * grown.
+ */
+WASM_API_EXTERN bool wasmtime_memory_read(
+    const wasmtime_context_t *store,
+    const wasmtime_memory_t *memory,
+    size_t offset,
+    uint8_t *buf,
+    size_t len
+);
+
+/**
+ * \brief Copies bytes into a linear memory with a bounds check.
+ *
+ * \param store the store that owns `memory`
+ * \param memory the memory to write to
+ * \param offset the byte offset within linear memory to start writing at
+ * \param buf the bytes to copy
+ * \param len the number of bytes to copy
+ *
+ * Returns `false`, leaving memory untouched, if `offset + len` exceeds the
+ * current size of the memory.
+ */
+WASM_API_EXTERN bool wasmtime_memory_write(
+    wasmtime_context_t *store,
+    const wasmtime_memory_t *memory,
+    size_t offset,
+    const uint8_t *buf,
+    size_t len
+);
+
+/**
+ * \brief A buffer used with #wasmtime_memory_readv and #wasmtime_memory_writev.
+ */
+typedef struct wasmtime_iovec {
+  /// Pointer to the start of the buffer.
+  uint8_t *data;
+  /// Length of the buffer, in bytes.
+  size_t len;
+} wasmtime_iovec_t;
+
+/**
+ * \brief Copies a contiguous range of a linear memory into several buffers.
+ *
+ * \param store the store that owns `memory`
+ * \param memory the memory to read from
+ * \param offset the byte offset within linear memory to start reading at
+ * \param iovs the buffers to fill, in order
+ * \param iovs_len the number of buffers in `iovs`
+ *
+ * This is equivalent to a #wasmtime_memory_read for each buffer at successive
+ * offsets but with a single bounds check for the whole range. Returns `false`,
+ * leaving all buffers untouched, if the range is out of bounds.
+ */
+WASM_API_EXTERN bool wasmtime_memory_readv(
+    const wasmtime_context_t *store,
+    const wasmtime_memory_t *memory,
+    size_t offset,
+    const wasmtime_iovec_t *iovs,
+    size_t iovs_len
+);
+
+/**
+ * \brief Copies several buffers into a contiguous range of a linear memory.
+ *
+ * \param store the store that owns `memory`
+ * \param memory the memory to write to
+ * \param offset the byte offset within linear memory to start writing at
+ * \param iovs the buffers to copy, in order
+ * \param iovs_len the number of buffers in `iovs`
+ *
+ * This is equivalent to a #wasmtime_memory_write for each buffer at successive
+ * offsets but with a single bounds check for the whole range. Returns `false`,
+ * leaving memory untouched, if the range is out of bounds.
+ */
+WASM_API_EXTERN bool wasmtime_memory_writev(
+    wasmtime_context_t *store,
+    const wasmtime_memory_t *memory,
+    size_t offset,
+    const wasmtime_iovec_t *iovs,
+    size_t iovs_len
+);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -48,6 +48,70 @@ WASM_API_EXTERN wasmtime_error_t *wasmtime_module_new(
     wasmtime_module_t **ret
 );
 
+/**
+ * \brief Compiles a WebAssembly binary into an optimized #wasmtime_module_t.
+ *
+ * This function is the same as #wasmtime_module_new except that the module is
+ * compiled at the optimization level configured with
+ * #wasmtime_config_cranelift_tier_up_opt_level_set.
+ *
+ * This is intended to be called from a background thread after a module
+ * compiled with #wasmtime_module_new has already started serving requests.
+ * Once it returns, the optimized module can replace the original one for all
+ * future instantiations, while existing instances keep running their original
+ * code. Both modules belong to `engine` and can be used with the same stores.
+ *
+ * This function does not take ownership of any of its arguments, but the
+ * returned error and module are owned by the caller.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Module.html#method.from_binary_tier_up
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_module_new_tier_up(
+    wasm_engine_t *engine,
+    const uint8_t *wasm,
+    size_t wasm_len,
+    wasmtime_module_t **ret
+);
+
+/**
+ * \brief Callback invoked as compilation of a module makes progress.
+ *
+ * The first argument is the `env` pointer provided to
+ * #wasmtime_module_new_with_callback, the second is the number of functions
+ * compiled so far, and the third is the total number of functions in the
+ * module.
+ */
+typedef void (*wasmtime_module_compile_progress_callback_t)(void *env, size_t completed, size_t total);
+
+/**
+ * \brief Compiles a WebAssembly binary into a #wasmtime_module_t, reporting
+ * progress as each function finishes compiling.
+ *
+ * This function is the same as #wasmtime_module_new except that `callback` is
+ * invoked with `env` once for each function in the module after it has been
+ * compiled. This can be used to report progress when compiling large modules.
+ *
+ * If parallel compilation is enabled (see
+ * #wasmtime_config_parallel_compilation_set) then `callback` is invoked from
+ * the threads performing compilation, possibly concurrently, so `env` and
+ * `callback` must be safe to use from multiple threads. The number of threads
+ * used can be limited with #wasmtime_config_parallel_compilation_threads_set.
+ * If the compiled module is found in the compilation cache then `callback` is
+ * not invoked at all.
+ *
+ * This function does not take ownership of any of its arguments, but the
+ * returned error and module are owned by the caller.
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_module_new_with_callback(
+    wasm_engine_t *engine,
+    const uint8_t *wasm,
+    size_t wasm_len,
+    wasmtime_module_compile_progress_callback_t callback,
+    void *env,
+    wasmtime_module_t **ret
+);
+
 /**
  * \brief Deletes a module.
  */
@@ -75,6 +139,28 @@ WASM_API_EXTERN void wasmtime_module_exports(
     wasm_exporttype_vec_t *out
 );
 
+/**
+ * \brief Resolves the name of an export to its index in this module.
+ *
+ * \param module the module to look up the export in
+ * \param name the name of the export
+ * \param name_len the byte length of `name`
+ * \param index where to store the index of the export
+ *
+ * Returns nonzero if the export was found, and `index` is filled in with the
+ * position of the export in #wasmtime_module_exports. Otherwise returns 0.
+ *
+ * The index can be passed to #wasmtime_instance_export_get_by_index and
+ * #wasmtime_caller_export_get_by_index for instances of this module, which
+ * avoids looking up the export by name on every access.
+ */
+WASM_API_EXTERN bool wasmtime_module_export_index(
+    const wasmtime_module_t *module,
+    const char *name,
+    size_t name_len,
+    size_t *index
+);
+
 /**
  * \brief Validate a WebAssembly binary.
  *
@@ -111,6 +197,74 @@ WASM_API_EXTERN wasmtime_error_t* wasmtime_module_serialize(
     wasm_byte_vec_t *ret
 );
 
+/**
+ * \brief Returns the number of bytes #wasmtime_module_serialize produces.
+ *
+ * \param module the module
+ * \param size where to store the size of the serialized module
+ *
+ * This can be used to allocate a buffer for #wasmtime_module_serialize_into,
+ * or to size a file before streaming the module into it with
+ * #wasmtime_module_serialize_stream.
+ */
+WASM_API_EXTERN wasmtime_error_t* wasmtime_module_serialized_size(
+    const wasmtime_module_t* module,
+    size_t *size
+);
+
+/**
+ * \brief Serializes compiled module artifacts into a caller-provided buffer.
+ *
+ * \param module the module
+ * \param buf the buffer to serialize into
+ * \param len the byte length of `buf`
+ * \param written where to store the number of bytes written to `buf`
+ *
+ * This produces the same bytes as #wasmtime_module_serialize without
+ * allocating them. Returns an error if `buf` is smaller than the size returned
+ * by #wasmtime_module_serialized_size, in which case the contents of `buf` are
+ * unspecified.
+ */
+WASM_API_EXTERN wasmtime_error_t* wasmtime_module_serialize_into(
+    const wasmtime_module_t* module,
+    uint8_t *buf,
+    size_t len,
+    size_t *written
+);
+
+/**
+ * \brief Callback signature for #wasmtime_module_serialize_stream.
+ *
+ * The callback is given the `env` pointer passed to
+ * #wasmtime_module_serialize_stream and the next `len` bytes of the serialized
+ * module, which are only valid for the duration of the call. Returning an
+ * error stops serialization, and the error is returned from
+ * #wasmtime_module_serialize_stream.
+ */
+typedef wasmtime_error_t* (*wasmtime_serialize_callback_t)(
+    void *env,
+    const uint8_t *data,
+    size_t len);
+
+/**
+ * \brief Serializes compiled module artifacts by handing them to a callback
+ * chunk by chunk.
+ *
+ * \param module the module
+ * \param callback invoked with each chunk of the serialized module, in order
+ * \param env passed to each invocation of `callback`
+ *
+ * This produces the same bytes as #wasmtime_module_serialize without
+ * assembling a copy of the whole artifact first: the compiled code is handed
+ * to `callback` directly from where it is loaded, in chunks of at most 1 MiB.
+ * This is useful to stream large modules into a file or object store.
+ */
+WASM_API_EXTERN wasmtime_error_t* wasmtime_module_serialize_stream(
+    const wasmtime_module_t* module,
+    wasmtime_serialize_callback_t callback,
+    void *env
+);
+
 /**
  * \brief Build a module from serialized data.
  *
@@ -135,6 +289,14 @@ WASM_API_EXTERN wasmtime_error_t *wasmtime_module_deserialize(
  * reads the data for the serialized module from the path on disk. This can be
  * faster than the alternative which may require copying the data around.
  *
+ * The file is mapped into memory rather than read, and its machine code is
+ * made executable in place. No copy of the compiled code is made, so the cost
+ * of this function is largely independent of the size of the code, pages are
+ * only loaded from disk as they're used, and separate processes deserializing
+ * the same file share the same page cache pages. As a consequence the file must
+ * not be modified while the returned module is alive. See
+ * #wasmtime_module_image_range for the range of memory this mapping occupies.
+ *
  * This function does not take ownership of any of its arguments, but the
  * returned error and module are owned by the caller.
  *
@@ -148,6 +310,72 @@ WASM_API_EXTERN wasmtime_error_t *wasmtime_module_deserialize_file(
     wasmtime_module_t **ret
 );
 
+/**
+ * \brief Returns whether instances of this module have their linear memories
+ * initialized from a copy-on-write memory image.
+ *
+ * \param module the module to query
+ * \param ret where to store whether a memory image is used
+ *
+ * \return `NULL` on success, in which case `ret` is filled in, or an error if
+ * the memory image could not be created.
+ *
+ * If `ret` is `false` then data segments are copied into linear memory on each
+ * instantiation, for example because #wasmtime_config_memory_init_cow_set was
+ * disabled or because the module's data segments don't meet the criteria for
+ * copy-on-write initialization. Memory images are otherwise created lazily
+ * when the module is first instantiated, so this function may create them.
+ *
+ * This function does not take ownership of `module`, and the caller is
+ * expected to deallocate the returned #wasmtime_error_t.
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_module_has_memory_image(
+    const wasmtime_module_t *module,
+    bool *ret
+);
+
+/**
+ * \brief Returns the range of bytes in memory where this module's compilation
+ * image resides.
+ *
+ * \param module the module to query
+ * \param start where to store the start of the range
+ * \param end where to store the end of the range, exclusive
+ *
+ * The compilation image for a module contains executable code, data, debug
+ * information, etc. For modules created with #wasmtime_module_deserialize_file
+ * this is the memory-mapped view of the file itself.
+ *
+ * This range is exposed to allow low-level manipulation of the memory in
+ * platform-specific manners such as using `madvise` or `mlock` to page in the
+ * contents ahead of time. It is not safe to modify the memory in this range,
+ * nor is it safe to modify the protections of memory in this range.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Module.html#method.image_range
+ */
+WASM_API_EXTERN void wasmtime_module_image_range(
+    const wasmtime_module_t *module,
+    const uint8_t **start,
+    const uint8_t **end
+);
+
+/**
+ * \brief Registers this module's DWARF debug information with native
+ * debuggers, if it hasn't been registered already.
+ *
+ * This is only necessary when the engine was configured with
+ * #wasmtime_config_lazy_debug_registration_set, for example after a debugger
+ * has been attached to the process. It does nothing if the module was compiled
+ * without #wasmtime_config_debug_info_set enabled.
+ *
+ * An error is returned if the debug image for this module couldn't be created.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Module.html#method.register_debug_info
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_module_register_debug(const wasmtime_module_t *module);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
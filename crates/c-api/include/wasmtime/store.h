@@ -84,6 +84,190 @@ WASM_API_EXTERN wasmtime_context_t *wasmtime_store_context(wasmtime_store_t *sto
  */
 WASM_API_EXTERN void wasmtime_store_delete(wasmtime_store_t *store);
 
+/**
+ * \brief Resets a store so that it can be reused, keeping its internal
+ * allocations.
+ *
+ * \param store the store to reset
+ * \param data the new user-provided data for the store, replacing the data
+ * passed to #wasmtime_store_new
+ * \param finalizer an optional finalizer for `data`
+ *
+ * All instances within `store` are deallocated and all functions, tables,
+ * memories, and globals created within it are dropped, including the host
+ * state of host functions. The finalizer for the store's previous data is then
+ * run, and any WASI configuration is removed. Afterwards the store behaves as
+ * if it were newly created with `data` and `finalizer`: no fuel has been added
+ * or consumed, the epoch deadline is zero, and out-of-fuel and epoch-deadline
+ * behavior is reset to trapping.
+ *
+ * This is intended for embeddings that handle many short-lived requests, for
+ * which creating and deleting a store per request would otherwise be
+ * measurable. Modules instantiated in the store before the reset are
+ * unregistered from it, so a reused store doesn't keep them alive.
+ *
+ * Any #wasmtime_func_t, #wasmtime_instance_t, or other item previously created
+ * within `store` must not be used with it after it has been reset. Doing so
+ * will abort the process.
+ *
+ * This function must not be called while WebAssembly is executing within
+ * `store`.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Store.html#method.reset
+ */
+WASM_API_EXTERN void wasmtime_store_reset(
+    wasmtime_store_t *store,
+    void *data,
+    void (*finalizer)(void*)
+);
+
+/**
+ * \brief Callback invoked when a linear memory in a store is about to grow.
+ *
+ * \param env the `env` pointer given to #wasmtime_store_limiter
+ * \param current the current size of the memory, in bytes
+ * \param desired the size the memory is requested to grow to, in bytes
+ * \param maximum the maximum size of the memory, in bytes, or `SIZE_MAX` if
+ *        the memory is unbounded
+ *
+ * Returns whether the growth is permitted. This is also invoked with a
+ * `current` size of 0 when a memory is created.
+ */
+typedef bool (*wasmtime_memory_growing_callback_t)(
+    void *env,
+    size_t current,
+    size_t desired,
+    size_t maximum
+);
+
+/**
+ * \brief Callback invoked when a table in a store is about to grow.
+ *
+ * \param env the `env` pointer given to #wasmtime_store_limiter
+ * \param current the current number of elements in the table
+ * \param desired the number of elements the table is requested to grow to
+ * \param maximum the maximum number of elements in the table, or `UINT32_MAX`
+ *        if the table is unbounded
+ *
+ * Returns whether the growth is permitted. This is also invoked with a
+ * `current` size of 0 when a table is created.
+ */
+typedef bool (*wasmtime_table_growing_callback_t)(
+    void *env,
+    uint32_t current,
+    uint32_t desired,
+    uint32_t maximum
+);
+
+/**
+ * \brief Configures callbacks which decide whether memories and tables within
+ * a store may be created or grown.
+ *
+ * \param store the store to configure
+ * \param memory_growing invoked before a linear memory is created or grown, or
+ *        `NULL` to permit all memory growth
+ * \param table_growing invoked before a table is created or grown, or `NULL`
+ *        to permit all table growth
+ * \param env an arbitrary pointer passed to both callbacks
+ * \param finalizer an optional finalizer for `env`, run when the limiter is
+ *        replaced or the store is deleted
+ *
+ * Rejected growth makes `memory.grow` and `table.grow` return -1, and makes
+ * instantiation fail for memories and tables that are created. The callbacks
+ * are invoked on the thread that is growing the memory or table and must not
+ * call back into `store`.
+ *
+ * A limiter is retained across #wasmtime_store_reset, including for stores
+ * handed out again by a #wasmtime_store_pool_t.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Store.html#method.limiter
+ */
+WASM_API_EXTERN void wasmtime_store_limiter(
+    wasmtime_store_t *store,
+    wasmtime_memory_growing_callback_t memory_growing,
+    wasmtime_table_growing_callback_t table_growing,
+    void *env,
+    void (*finalizer)(void*)
+);
+
+/**
+ * \typedef wasmtime_store_pool_t
+ * \brief Convenience alias for #wasmtime_store_pool
+ *
+ * \struct wasmtime_store_pool
+ * \brief A cache of reset #wasmtime_store_t values for a single engine.
+ *
+ * Stores returned to a pool with #wasmtime_store_pool_put are reset with
+ * #wasmtime_store_reset and handed out again by #wasmtime_store_pool_take, so
+ * that steady-state request handling doesn't need to create or destroy stores.
+ *
+ * A pool is not safe to use from multiple threads concurrently. It's intended
+ * for each thread to have its own pool, for example stored in a thread-local
+ * variable, although stores taken from a pool can be sent to other threads
+ * like any other store.
+ */
+typedef struct wasmtime_store_pool wasmtime_store_pool_t;
+
+/**
+ * \brief Creates a new store pool for the specified engine.
+ *
+ * \param engine the engine that stores in this pool are connected to
+ * \param max_stores the maximum number of idle stores the pool retains
+ *
+ * The returned pool must be deleted with #wasmtime_store_pool_delete.
+ */
+WASM_API_EXTERN wasmtime_store_pool_t *wasmtime_store_pool_new(
+    wasm_engine_t *engine,
+    size_t max_stores
+);
+
+/**
+ * \brief Deletes a store pool along with all the idle stores it retains.
+ *
+ * Stores previously taken from the pool are unaffected and must still be
+ * returned with #wasmtime_store_pool_put or deleted with
+ * #wasmtime_store_delete.
+ */
+WASM_API_EXTERN void wasmtime_store_pool_delete(wasmtime_store_pool_t *pool);
+
+/**
+ * \brief Acquires a store from a pool.
+ *
+ * \param pool the pool to acquire a store from
+ * \param data user-provided data for the store, can later be acquired with
+ * #wasmtime_context_get_data.
+ * \param finalizer an optional finalizer for `data`
+ *
+ * This reuses an idle store from `pool` if one is available and otherwise
+ * creates a new one, as if by #wasmtime_store_new. The returned store is owned
+ * by the caller, and should be given back with #wasmtime_store_pool_put (or
+ * deleted with #wasmtime_store_delete) once it's no longer needed.
+ */
+WASM_API_EXTERN wasmtime_store_t *wasmtime_store_pool_take(
+    wasmtime_store_pool_t *pool,
+    void *data,
+    void (*finalizer)(void*)
+);
+
+/**
+ * \brief Returns a store to a pool.
+ *
+ * \param pool the pool to return the store to
+ * \param store the store to return, ownership of which is transferred to this
+ * function
+ *
+ * The store is reset with #wasmtime_store_reset, which runs the finalizer for
+ * its data, and retained for a future #wasmtime_store_pool_take. If `pool`
+ * already retains its maximum number of idle stores, or `store` belongs to a
+ * different engine, the store is deleted instead.
+ */
+WASM_API_EXTERN void wasmtime_store_pool_put(
+    wasmtime_store_pool_t *pool,
+    wasmtime_store_t *store
+);
+
 /**
  * \brief Returns the user-specified data associated with the specified store
  */
@@ -109,6 +293,59 @@ WASM_API_EXTERN void wasmtime_context_set_data(wasmtime_context_t* context, void
  */
 WASM_API_EXTERN void wasmtime_context_gc(wasmtime_context_t* context);
 
+/**
+ * \brief Returns statistics about garbage collections within the given
+ * context.
+ *
+ * \param context the context to query, which must not be NULL.
+ * \param collections where to store the number of collections performed so
+ *        far, both explicit ones through #wasmtime_context_gc and those
+ *        triggered automatically when internal buffers fill up.
+ * \param total_pause_ns where to store the total time spent collecting, in
+ *        nanoseconds.
+ * \param max_pause_ns where to store the longest single collection, in
+ *        nanoseconds.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Store.html#method.gc_stats
+ */
+WASM_API_EXTERN void wasmtime_context_gc_stats(
+    const wasmtime_context_t* context,
+    uint64_t *collections,
+    uint64_t *total_pause_ns,
+    uint64_t *max_pause_ns
+);
+
+/**
+ * \brief Returns the resources currently allocated within the given context.
+ *
+ * \param context the context to query, which must not be NULL.
+ * \param instances where to store the number of module instances created in
+ *        the store.
+ * \param memory_bytes_committed where to store the total size of all linear
+ *        memories in the store, in bytes.
+ * \param memory_bytes_reserved where to store the total address space
+ *        reserved for linear memories in the store, in bytes, including space
+ *        for future growth and guard regions.
+ * \param table_elements where to store the total number of elements of all
+ *        tables in the store.
+ *
+ * The values are computed from the store's instances when this is called,
+ * which takes time proportional to the number of instances, memories, and
+ * tables in the store. Memories and tables created by the host, for example
+ * with #wasmtime_memory_new, are included.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Store.html#method.resource_usage
+ */
+WASM_API_EXTERN void wasmtime_context_resource_usage(
+    const wasmtime_context_t* context,
+    size_t *instances,
+    size_t *memory_bytes_committed,
+    size_t *memory_bytes_reserved,
+    size_t *table_elements
+);
+
 /**
  * \brief Adds fuel to this context's store for wasm to consume while executing.
  *
@@ -153,6 +390,57 @@ WASM_API_EXTERN bool wasmtime_context_fuel_consumed(const wasmtime_context_t *co
  */
 WASM_API_EXTERN wasmtime_error_t *wasmtime_context_consume_fuel(wasmtime_context_t *context, uint64_t fuel, uint64_t *remaining);
 
+/**
+ * \typedef wasmtime_fuel_action_t
+ * \brief What to do after running out of fuel, as decided by a
+ * #wasmtime_out_of_fuel_callback_t.
+ *
+ * This is one of #WASMTIME_FUEL_ACTION_REFUEL or
+ * #WASMTIME_FUEL_ACTION_YIELD_AND_REFUEL.
+ */
+typedef uint8_t wasmtime_fuel_action_t;
+
+/// \brief Add fuel and continue executing.
+#define WASMTIME_FUEL_ACTION_REFUEL 0
+/// \brief Yield back to the caller of #wasmtime_call_future_poll, and add fuel
+/// once execution resumes. This requires async support.
+#define WASMTIME_FUEL_ACTION_YIELD_AND_REFUEL 1
+
+/**
+ * \brief Callback signature for #wasmtime_context_out_of_fuel_callback.
+ *
+ * The callback is given the context of the store that ran out of fuel and the
+ * `env` pointer it was registered with. To continue executing it stores the
+ * amount of fuel to add into `fuel` and how to proceed into `action` (which
+ * defaults to #WASMTIME_FUEL_ACTION_REFUEL) and returns NULL. Returning an
+ * error instead raises a trap in the executing WebAssembly.
+ */
+typedef wasmtime_error_t* (*wasmtime_out_of_fuel_callback_t)(
+    wasmtime_context_t *context,
+    void *env,
+    uint64_t *fuel,
+    wasmtime_fuel_action_t *action);
+
+/**
+ * \brief Configures a callback to invoke whenever this store runs out of fuel.
+ *
+ * Fuel consumption must be enabled via #wasmtime_config_consume_fuel_set. By
+ * default running out of fuel raises a trap, but this lets the embedder refuel
+ * the store, for example after charging for the fuel consumed, or suspend the
+ * store when executing asynchronously.
+ *
+ * The `finalizer` is invoked with `env` when the callback is replaced or the
+ * store is deleted.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Store.html#method.out_of_fuel_callback
+ */
+WASM_API_EXTERN void wasmtime_context_out_of_fuel_callback(
+    wasmtime_context_t *context,
+    wasmtime_out_of_fuel_callback_t callback,
+    void *env,
+    void (*finalizer)(void*));
+
 /**
  * \brief Configures WASI state within the specified store.
  *
@@ -177,6 +465,145 @@ WASM_API_EXTERN wasmtime_error_t *wasmtime_context_set_wasi(wasmtime_context_t *
  */
 WASM_API_EXTERN void wasmtime_context_set_epoch_deadline(wasmtime_context_t *context, uint64_t ticks_beyond_current);
 
+/**
+ * \brief Configures epoch-deadline expiration to record a profiling sample and
+ * then extend the deadline.
+ *
+ * When the epoch deadline is reached while WebAssembly is executing, the
+ * currently executing function is recorded as a sample and execution continues
+ * with a new deadline `delta` ticks after the current epoch. Incrementing the
+ * engine's epoch periodically with #wasmtime_engine_increment_epoch from
+ * another thread therefore acts as a low-overhead sampling profiler, the
+ * results of which are available with #wasmtime_context_profile_snapshot.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Store.html#method.epoch_deadline_sample_and_update.
+ */
+WASM_API_EXTERN void wasmtime_context_epoch_deadline_sample_and_update(wasmtime_context_t *context, uint64_t delta);
+
+/**
+ * \typedef wasmtime_deadline_action_t
+ * \brief What to do after the epoch deadline is reached, as decided by a
+ * #wasmtime_epoch_deadline_callback_t.
+ *
+ * This is one of #WASMTIME_DEADLINE_ACTION_EXTEND or
+ * #WASMTIME_DEADLINE_ACTION_YIELD_AND_EXTEND.
+ */
+typedef uint8_t wasmtime_deadline_action_t;
+
+/// \brief Extend the deadline and continue executing.
+#define WASMTIME_DEADLINE_ACTION_EXTEND 0
+/// \brief Yield back to the caller of #wasmtime_call_future_poll, and extend
+/// the deadline once execution resumes. This requires async support.
+#define WASMTIME_DEADLINE_ACTION_YIELD_AND_EXTEND 1
+
+/**
+ * \brief Callback signature for #wasmtime_context_epoch_deadline_callback.
+ *
+ * The callback is given the context of the store whose deadline was reached and
+ * the `env` pointer it was registered with. To continue executing it stores the
+ * number of ticks after the current epoch of the new deadline into `delta` and
+ * how to proceed into `action` (which defaults to
+ * #WASMTIME_DEADLINE_ACTION_EXTEND) and returns NULL. Returning an error
+ * instead raises a trap in the executing WebAssembly.
+ */
+typedef wasmtime_error_t* (*wasmtime_epoch_deadline_callback_t)(
+    wasmtime_context_t *context,
+    void *env,
+    uint64_t *delta,
+    wasmtime_deadline_action_t *action);
+
+/**
+ * \brief Configures epoch-deadline expiration to invoke a callback.
+ *
+ * By default reaching the epoch deadline raises a trap, but this lets the
+ * embedder decide each time whether to give the store another time slice,
+ * suspend it when executing asynchronously so other stores can run, or trap.
+ * Combined with #wasmtime_engine_start_epoch_ticker this implements
+ * cooperative time-slicing without a ticker thread of the embedder's own.
+ *
+ * The `finalizer` is invoked with `env` when the callback is replaced or the
+ * store is deleted.
+ *
+ * For more information see the Rust documentation at
+ * https://bytecodealliance.github.io/wasmtime/api/wasmtime/struct.Store.html#method.epoch_deadline_callback
+ */
+WASM_API_EXTERN void wasmtime_context_epoch_deadline_callback(
+    wasmtime_context_t *context,
+    wasmtime_epoch_deadline_callback_t callback,
+    void *env,
+    void (*finalizer)(void*));
+
+/**
+ * \typedef wasmtime_profile_t
+ * \brief Convenience alias for #wasmtime_profile
+ *
+ * \struct wasmtime_profile
+ * \brief A snapshot of the profiling samples recorded in a store.
+ *
+ * A profile is a list of the WebAssembly functions which have been sampled,
+ * with the most frequently sampled functions first. Profiles are created with
+ * #wasmtime_context_profile_snapshot and deleted with #wasmtime_profile_delete.
+ */
+typedef struct wasmtime_profile wasmtime_profile_t;
+
+/**
+ * \brief Returns a snapshot of the profiling samples recorded in this store.
+ *
+ * Samples are recorded when the epoch deadline is reached with the store
+ * configured by #wasmtime_context_epoch_deadline_sample_and_update, and
+ * accumulate until #wasmtime_context_clear_profile or #wasmtime_store_reset is
+ * called. The returned profile is owned by the caller and is independent of the
+ * store.
+ */
+WASM_API_EXTERN wasmtime_profile_t *wasmtime_context_profile_snapshot(wasmtime_context_t *context);
+
+/**
+ * \brief Discards all profiling samples recorded in this store so far.
+ */
+WASM_API_EXTERN void wasmtime_context_clear_profile(wasmtime_context_t *context);
+
+/**
+ * \brief Deletes a profile.
+ */
+WASM_API_EXTERN void wasmtime_profile_delete(wasmtime_profile_t *profile);
+
+/**
+ * \brief Returns the number of functions in a profile.
+ */
+WASM_API_EXTERN size_t wasmtime_profile_len(const wasmtime_profile_t *profile);
+
+/**
+ * \brief Returns the sample count of the function at `index` in a profile.
+ *
+ * If `index` is in bounds then `func_index` is filled in with the index of the
+ * function within its module, `samples` is filled in with the number of
+ * samples attributed to it, and `true` is returned. Otherwise `false` is
+ * returned.
+ */
+WASM_API_EXTERN bool wasmtime_profile_func(
+    const wasmtime_profile_t *profile,
+    size_t index,
+    uint32_t *func_index,
+    uint64_t *samples);
+
+/**
+ * \brief Returns the name of the function at `index` in a profile.
+ *
+ * Returns `NULL` if `index` is out of bounds or if the function's module has
+ * no name for it. The returned name is owned by the profile.
+ */
+WASM_API_EXTERN const wasm_name_t *wasmtime_profile_func_name(const wasmtime_profile_t *profile, size_t index);
+
+/**
+ * \brief Returns the name of the module of the function at `index` in a
+ * profile.
+ *
+ * Returns `NULL` if `index` is out of bounds or if the module has no name. The
+ * returned name is owned by the profile.
+ */
+WASM_API_EXTERN const wasm_name_t *wasmtime_profile_module_name(const wasmtime_profile_t *profile, size_t index);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
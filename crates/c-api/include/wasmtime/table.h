@@ -118,6 +118,80 @@ WASM_API_EXTERN wasmtime_error_t *wasmtime_table_grow(
     uint32_t *prev_size
 );
 
+/**
+ * \brief Sets a range of values in a table.
+ *
+ * \param store the store that owns `table`
+ * \param table the table to write to
+ * \param dst the first table index to write
+ * \param vals the values to store
+ * \param len the number of values in `vals`
+ *
+ * This function stores each of `vals` into the table starting at index `dst`,
+ * which is more efficient than calling #wasmtime_table_set for each of them.
+ * This can fail if any value has the wrong type for the table, or if the range
+ * is out of bounds, in which case no values are stored.
+ *
+ * This function does not take ownership of any of its arguments but yields
+ * ownership of the error.
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_table_set_range(
+    wasmtime_context_t *store,
+    const wasmtime_table_t *table,
+    uint32_t dst,
+    const wasmtime_val_t *vals,
+    size_t len
+);
+
+/**
+ * \brief Fills a range of a table with a value.
+ *
+ * \param store the store that owns `table`
+ * \param table the table to write to
+ * \param dst the first table index to write
+ * \param val the value to store
+ * \param len the number of elements to write
+ *
+ * This is the same as the `table.fill` instruction. It can fail if `val` has
+ * the wrong type for the table, or if the range is out of bounds.
+ *
+ * This function does not take ownership of any of its arguments but yields
+ * ownership of the error.
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_table_fill(
+    wasmtime_context_t *store,
+    const wasmtime_table_t *table,
+    uint32_t dst,
+    const wasmtime_val_t *val,
+    uint32_t len
+);
+
+/**
+ * \brief Copies a range of elements from one table to another.
+ *
+ * \param store the store that owns both tables
+ * \param dst_table the table to write to
+ * \param dst_index the first index in `dst_table` to write
+ * \param src_table the table to read from
+ * \param src_index the first index in `src_table` to read
+ * \param len the number of elements to copy
+ *
+ * This is the same as the `table.copy` instruction, and the two tables may be
+ * the same table with overlapping ranges. It can fail if the tables have
+ * different element types, or if either range is out of bounds.
+ *
+ * This function does not take ownership of any of its arguments but yields
+ * ownership of the error.
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_table_copy(
+    wasmtime_context_t *store,
+    const wasmtime_table_t *dst_table,
+    uint32_t dst_index,
+    const wasmtime_table_t *src_table,
+    uint32_t src_index,
+    uint32_t len
+);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -0,0 +1,378 @@
+//! Support for the asynchronous `wasmtime/async.h` API.
+//!
+//! Rust futures don't exist in C, so the futures here are driven entirely by
+//! the embedder: a `wasmtime_call_future_t` is polled with a no-op waker via
+//! `wasmtime_call_future_poll`, and async host functions hand back a
+//! `wasmtime_async_continuation_t` which is polled each time the enclosing
+//! future is polled. WebAssembly itself runs on a fiber, so when a host
+//! continuation isn't ready yet the fiber is suspended and control returns to
+//! the embedder's event loop.
+
+use crate::{
+    bad_utf8, handle_result, wasm_config_t, wasm_engine_t, wasm_functype_t, wasm_trap_t,
+    wasmtime_caller_t, wasmtime_error_t, wasmtime_linker_t, wasmtime_module_t, wasmtime_val_t,
+    wasmtime_val_union, CStoreContextMut, StoreData, WASMTIME_I32,
+};
+use std::ffi::c_void;
+use std::future::Future;
+use std::mem::{self, MaybeUninit};
+use std::panic::{self, AssertUnwindSafe};
+use std::pin::Pin;
+use std::ptr;
+use std::str;
+use std::task::{Context, Poll, RawWaker, RawWakerVTable, Waker};
+use wasmtime::{AsContextMut, Caller, Func, Instance, Trap, Val};
+
+#[no_mangle]
+pub extern "C" fn wasmtime_config_async_support_set(c: &mut wasm_config_t, enable: bool) {
+    c.config.async_support(enable);
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_config_async_stack_size_set(
+    c: &mut wasm_config_t,
+    size: usize,
+) -> Option<Box<wasmtime_error_t>> {
+    handle_result(c.config.async_stack_size(size), |_cfg| {})
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_config_async_stack_cache_size_set(c: &mut wasm_config_t, size: usize) {
+    c.config.async_stack_cache_size(size);
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_engine_fiber_stack_stats(
+    engine: &wasm_engine_t,
+    live: &mut usize,
+    cached: &mut usize,
+    created: &mut u64,
+    reused: &mut u64,
+) {
+    let stats = engine.engine.fiber_stack_stats();
+    *live = stats.live();
+    *cached = stats.cached();
+    *created = stats.created();
+    *reused = stats.reused();
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_context_out_of_fuel_async_yield(
+    mut store: CStoreContextMut<'_>,
+    injection_count: u64,
+    fuel_to_inject: u64,
+) {
+    store.out_of_fuel_async_yield(injection_count, fuel_to_inject);
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_context_epoch_deadline_async_yield_and_update(
+    mut store: CStoreContextMut<'_>,
+    delta: u64,
+) {
+    store.epoch_deadline_async_yield_and_update(delta);
+}
+
+pub type wasmtime_func_async_continuation_callback_t = extern "C" fn(*mut c_void) -> bool;
+
+#[repr(C)]
+pub struct wasmtime_async_continuation_t {
+    pub callback: wasmtime_func_async_continuation_callback_t,
+    pub env: *mut c_void,
+    pub finalizer: Option<extern "C" fn(*mut c_void)>,
+}
+
+// The continuation is only ever polled from the fiber running the host call,
+// which is the same thread that polls the enclosing `wasmtime_call_future_t`.
+unsafe impl Send for wasmtime_async_continuation_t {}
+
+impl Drop for wasmtime_async_continuation_t {
+    fn drop(&mut self) {
+        if let Some(f) = self.finalizer {
+            f(self.env);
+        }
+    }
+}
+
+impl Future for wasmtime_async_continuation_t {
+    type Output = ();
+
+    fn poll(self: Pin<&mut Self>, _cx: &mut Context<'_>) -> Poll<()> {
+        if (self.callback)(self.env) {
+            Poll::Ready(())
+        } else {
+            Poll::Pending
+        }
+    }
+}
+
+/// The continuation that host callbacks start with, which means that a
+/// callback which doesn't write a continuation has completed synchronously.
+extern "C" fn continuation_ready(_env: *mut c_void) -> bool {
+    true
+}
+
+pub type wasmtime_func_async_callback_t = extern "C" fn(
+    *mut c_void,
+    *mut wasmtime_caller_t,
+    *const wasmtime_val_t,
+    usize,
+    *mut wasmtime_val_t,
+    usize,
+    *mut Option<Box<wasm_trap_t>>,
+    *mut wasmtime_async_continuation_t,
+);
+
+/// Wrapper to send the host-provided `env` pointer into a future.
+#[derive(Copy, Clone)]
+struct CallbackDataPtr(*mut c_void);
+
+unsafe impl Send for CallbackDataPtr {}
+
+async fn invoke_c_async_callback<'a>(
+    callback: wasmtime_func_async_callback_t,
+    data: CallbackDataPtr,
+    mut caller: Caller<'a, StoreData>,
+    params: &'a [Val],
+    results: &'a mut [Val],
+) -> Result<(), Trap> {
+    // Convert `params/results` to `wasmtime_val_t` in the same manner as
+    // synchronous host functions. The storage lives within this future, which
+    // is pinned, so the pointers handed to C stay valid until the continuation
+    // has completed.
+    let mut vals = mem::take(&mut caller.data_mut().hostcall_val_storage);
+    debug_assert!(vals.is_empty());
+    vals.reserve(params.len() + results.len());
+    vals.extend(params.iter().cloned().map(|p| wasmtime_val_t::from_val(p)));
+    vals.extend((0..results.len()).map(|_| wasmtime_val_t {
+        kind: WASMTIME_I32,
+        of: wasmtime_val_union { i32: 0 },
+    }));
+    let (params, out_results) = vals.split_at_mut(params.len());
+
+    let mut caller = wasmtime_caller_t { caller };
+    let mut trap = None;
+    let mut continuation = wasmtime_async_continuation_t {
+        callback: continuation_ready,
+        env: ptr::null_mut(),
+        finalizer: None,
+    };
+    callback(
+        data.0,
+        &mut caller,
+        params.as_ptr(),
+        params.len(),
+        out_results.as_mut_ptr(),
+        out_results.len(),
+        &mut trap,
+        &mut continuation,
+    );
+    (&mut continuation).await;
+    drop(continuation);
+
+    if let Some(trap) = trap {
+        return Err(trap.trap);
+    }
+
+    for (i, result) in out_results.iter().enumerate() {
+        results[i] = unsafe { result.to_val() };
+    }
+
+    vals.truncate(0);
+    caller.caller.data_mut().hostcall_val_storage = vals;
+    Ok(())
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_func_new_async(
+    store: CStoreContextMut<'_>,
+    ty: &wasm_functype_t,
+    callback: wasmtime_func_async_callback_t,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+    func: &mut Func,
+) {
+    let ty = ty.ty().ty.clone();
+    let foreign = crate::ForeignData { data, finalizer };
+    *func = Func::new_async(store, ty, move |caller, params, results| {
+        drop(&foreign); // move entire foreign into this closure
+        let data = CallbackDataPtr(foreign.data);
+        Box::new(invoke_c_async_callback(
+            callback, data, caller, params, results,
+        ))
+    });
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_linker_define_async_func(
+    linker: &mut wasmtime_linker_t,
+    module: *const u8,
+    module_len: usize,
+    name: *const u8,
+    name_len: usize,
+    ty: &wasm_functype_t,
+    callback: wasmtime_func_async_callback_t,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) -> Option<Box<wasmtime_error_t>> {
+    let ty = ty.ty().ty.clone();
+    let module = match str::from_utf8(crate::slice_from_raw_parts(module, module_len)) {
+        Ok(s) => s,
+        Err(_) => return bad_utf8(),
+    };
+    let name = match str::from_utf8(crate::slice_from_raw_parts(name, name_len)) {
+        Ok(s) => s,
+        Err(_) => return bad_utf8(),
+    };
+    let foreign = crate::ForeignData { data, finalizer };
+    let result = linker
+        .linker
+        .func_new_async(module, name, ty, move |caller, params, results| {
+            drop(&foreign); // move entire foreign into this closure
+            let data = CallbackDataPtr(foreign.data);
+            Box::new(invoke_c_async_callback(
+                callback, data, caller, params, results,
+            ))
+        });
+    handle_result(result, |_linker| ())
+}
+
+pub struct wasmtime_call_future_t<'a> {
+    underlying: Option<Pin<Box<dyn Future<Output = ()> + 'a>>>,
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_call_future_delete(_future: Box<wasmtime_call_future_t<'_>>) {}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_call_future_poll(future: &mut wasmtime_call_future_t<'_>) -> bool {
+    let underlying = match &mut future.underlying {
+        Some(underlying) => underlying,
+        None => return true,
+    };
+    let waker = noop_waker();
+    let mut cx = Context::from_waker(&waker);
+    match underlying.as_mut().poll(&mut cx) {
+        Poll::Ready(()) => {
+            future.underlying = None;
+            true
+        }
+        Poll::Pending => false,
+    }
+}
+
+fn noop_waker() -> Waker {
+    unsafe { Waker::from_raw(noop_raw_waker()) }
+}
+
+fn noop_raw_waker() -> RawWaker {
+    RawWaker::new(ptr::null(), &NOOP_WAKER_VTABLE)
+}
+
+unsafe fn noop_clone(_data: *const ()) -> RawWaker {
+    noop_raw_waker()
+}
+
+unsafe fn noop(_data: *const ()) {}
+
+const NOOP_WAKER_VTABLE: RawWakerVTable = RawWakerVTable::new(noop_clone, noop, noop, noop);
+
+/// Catches panics raised while polling the wrapped future, the async analog of
+/// the `catch_unwind` in `wasmtime_func_call`.
+struct CatchUnwind<F>(F);
+
+impl<F: Future> Future for CatchUnwind<F> {
+    type Output = std::thread::Result<F::Output>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        let future = unsafe { self.map_unchecked_mut(|me| &mut me.0) };
+        match panic::catch_unwind(AssertUnwindSafe(|| future.poll(cx))) {
+            Ok(Poll::Ready(val)) => Poll::Ready(Ok(val)),
+            Ok(Poll::Pending) => Poll::Pending,
+            Err(panic) => Poll::Ready(Err(panic)),
+        }
+    }
+}
+
+async fn do_func_call_async(
+    mut store: CStoreContextMut<'_>,
+    func: Func,
+    args: &[wasmtime_val_t],
+    results: &mut [MaybeUninit<wasmtime_val_t>],
+    trap_ret: &mut *mut wasm_trap_t,
+    err_ret: &mut *mut wasmtime_error_t,
+) {
+    let mut params = mem::take(&mut store.data_mut().wasm_val_storage);
+    let (wt_params, wt_results) = crate::func::translate_args(
+        &mut params,
+        args.iter().map(|i| unsafe { i.to_val() }),
+        results.len(),
+    );
+    let result = CatchUnwind(func.call_async(&mut store, wt_params, wt_results)).await;
+    match result {
+        Ok(Ok(())) => {
+            for (slot, val) in results.iter_mut().zip(wt_results.iter()) {
+                crate::initialize(slot, wasmtime_val_t::from_val(val.clone()));
+            }
+            params.truncate(0);
+            store.data_mut().wasm_val_storage = params;
+        }
+        Ok(Err(trap)) => match trap.downcast::<Trap>() {
+            Ok(trap) => *trap_ret = Box::into_raw(Box::new(wasm_trap_t::new(trap))),
+            Err(err) => *err_ret = Box::into_raw(Box::new(wasmtime_error_t::from(err))),
+        },
+        Err(panic) => {
+            let trap = crate::func::trap_from_panic(panic);
+            *trap_ret = Box::into_raw(Box::new(wasm_trap_t::new(trap)));
+        }
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_func_call_async<'a>(
+    store: CStoreContextMut<'a>,
+    func: &Func,
+    args: *const wasmtime_val_t,
+    nargs: usize,
+    results: *mut MaybeUninit<wasmtime_val_t>,
+    nresults: usize,
+    trap_ret: &'a mut *mut wasm_trap_t,
+    err_ret: &'a mut *mut wasmtime_error_t,
+) -> Box<wasmtime_call_future_t<'a>> {
+    let args = crate::slice_from_raw_parts(args, nargs);
+    let results = crate::slice_from_raw_parts_mut(results, nresults);
+    let future = do_func_call_async(store, *func, args, results, trap_ret, err_ret);
+    Box::new(wasmtime_call_future_t {
+        underlying: Some(Box::pin(future)),
+    })
+}
+
+async fn do_linker_instantiate_async(
+    linker: &wasmtime_linker_t,
+    store: CStoreContextMut<'_>,
+    module: &wasmtime_module_t,
+    instance_ptr: &mut Instance,
+    trap_ret: &mut *mut wasm_trap_t,
+    err_ret: &mut *mut wasmtime_error_t,
+) {
+    let result = linker.linker.instantiate_async(store, &module.module).await;
+    if let Some(err) = crate::instance::handle_instantiate(result, instance_ptr, trap_ret) {
+        *err_ret = Box::into_raw(err);
+    }
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_linker_instantiate_async<'a>(
+    linker: &'a wasmtime_linker_t,
+    store: CStoreContextMut<'a>,
+    module: &'a wasmtime_module_t,
+    instance_ptr: &'a mut Instance,
+    trap_ret: &'a mut *mut wasm_trap_t,
+    err_ret: &'a mut *mut wasmtime_error_t,
+) -> Box<wasmtime_call_future_t<'a>> {
+    let future =
+        do_linker_instantiate_async(linker, store, module, instance_ptr, trap_ret, err_ret);
+    Box::new(wasmtime_call_future_t {
+        underlying: Some(Box::pin(future)),
+    })
+}
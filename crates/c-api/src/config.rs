@@ -2,10 +2,18 @@
 // them with the default set of features enabled.
 #![cfg_attr(not(feature = "cache"), allow(unused_imports))]
 
-use crate::{handle_result, wasmtime_error_t};
-use std::ffi::CStr;
+use crate::{handle_result, wasm_byte_vec_t, wasmtime_error_t};
+use std::ffi::{c_void, CStr};
 use std::os::raw::c_char;
-use wasmtime::{Config, OptLevel, ProfilingStrategy, Strategy};
+use std::sync::Arc;
+use wasmtime::{
+    Config, InstanceAllocationStrategy, OptLevel, ProfilingStrategy, Strategy, WasmBacktraceDetails,
+};
+
+#[cfg(feature = "cache")]
+use wasmtime::CacheStore;
+#[cfg(feature = "pooling-allocator")]
+use wasmtime::{InstanceLimits, PoolingAllocationStrategy};
 
 #[repr(C)]
 #[derive(Clone)]
@@ -35,6 +43,23 @@ pub enum wasmtime_opt_level_t {
 pub enum wasmtime_profiling_strategy_t {
     WASMTIME_PROFILING_STRATEGY_NONE,
     WASMTIME_PROFILING_STRATEGY_JITDUMP,
+    WASMTIME_PROFILING_STRATEGY_VTUNE,
+    WASMTIME_PROFILING_STRATEGY_PERFMAP,
+}
+
+#[repr(u8)]
+#[derive(Clone)]
+pub enum wasmtime_instance_allocation_strategy_t {
+    WASMTIME_INSTANCE_ALLOCATION_STRATEGY_ON_DEMAND,
+    WASMTIME_INSTANCE_ALLOCATION_STRATEGY_POOLING,
+}
+
+#[repr(u8)]
+#[derive(Clone)]
+pub enum wasmtime_pooling_allocation_strategy_t {
+    WASMTIME_POOLING_ALLOCATION_STRATEGY_NEXT_AVAILABLE,
+    WASMTIME_POOLING_ALLOCATION_STRATEGY_RANDOM,
+    WASMTIME_POOLING_ALLOCATION_STRATEGY_REUSE_AFFINITY,
 }
 
 #[no_mangle]
@@ -49,6 +74,30 @@ pub extern "C" fn wasmtime_config_debug_info_set(c: &mut wasm_config_t, enable:
     c.config.debug_info(enable);
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_config_lazy_debug_registration_set(c: &mut wasm_config_t, enable: bool) {
+    c.config.lazy_debug_registration(enable);
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_config_share_deserialized_code_set(c: &mut wasm_config_t, enable: bool) {
+    c.config.share_deserialized_code(enable);
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_config_wasm_backtrace_set(c: &mut wasm_config_t, enable: bool) {
+    c.config.wasm_backtrace(enable);
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_config_wasm_backtrace_details_set(c: &mut wasm_config_t, enable: bool) {
+    c.config.wasm_backtrace_details(if enable {
+        WasmBacktraceDetails::Enable
+    } else {
+        WasmBacktraceDetails::Disable
+    });
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_config_consume_fuel_set(c: &mut wasm_config_t, enable: bool) {
     c.config.consume_fuel(enable);
@@ -125,12 +174,69 @@ pub extern "C" fn wasmtime_config_cranelift_opt_level_set(
     c: &mut wasm_config_t,
     opt_level: wasmtime_opt_level_t,
 ) {
-    use wasmtime_opt_level_t::*;
-    c.config.cranelift_opt_level(match opt_level {
-        WASMTIME_OPT_LEVEL_NONE => OptLevel::None,
-        WASMTIME_OPT_LEVEL_SPEED => OptLevel::Speed,
-        WASMTIME_OPT_LEVEL_SPEED_AND_SIZE => OptLevel::SpeedAndSize,
-    });
+    c.config.cranelift_opt_level(opt_level.into());
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_config_cranelift_tier_up_opt_level_set(
+    c: &mut wasm_config_t,
+    opt_level: wasmtime_opt_level_t,
+) {
+    c.config.cranelift_tier_up_opt_level(opt_level.into());
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_config_target_set(
+    c: &mut wasm_config_t,
+    target: *const c_char,
+) -> Option<Box<wasmtime_error_t>> {
+    handle_result(
+        CStr::from_ptr(target)
+            .to_str()
+            .map_err(anyhow::Error::from)
+            .and_then(|target| c.config.target(target).map(|_| ())),
+        |()| {},
+    )
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_config_cranelift_flag_set(
+    c: &mut wasm_config_t,
+    key: *const c_char,
+    value: *const c_char,
+) -> Option<Box<wasmtime_error_t>> {
+    let result = (|| {
+        let key = CStr::from_ptr(key).to_str()?;
+        let value = CStr::from_ptr(value).to_str()?;
+        c.config.cranelift_flag_set(key, value)?;
+        Ok(())
+    })();
+    handle_result(result, |()| {})
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_config_cranelift_flag_enable(
+    c: &mut wasm_config_t,
+    flag: *const c_char,
+) -> Option<Box<wasmtime_error_t>> {
+    handle_result(
+        CStr::from_ptr(flag)
+            .to_str()
+            .map_err(anyhow::Error::from)
+            .and_then(|flag| c.config.cranelift_flag_enable(flag).map(|_| ())),
+        |()| {},
+    )
+}
+
+impl From<wasmtime_opt_level_t> for OptLevel {
+    fn from(opt_level: wasmtime_opt_level_t) -> OptLevel {
+        use wasmtime_opt_level_t::*;
+        match opt_level {
+            WASMTIME_OPT_LEVEL_NONE => OptLevel::None,
+            WASMTIME_OPT_LEVEL_SPEED => OptLevel::Speed,
+            WASMTIME_OPT_LEVEL_SPEED_AND_SIZE => OptLevel::SpeedAndSize,
+        }
+    }
 }
 
 #[no_mangle]
@@ -142,6 +248,8 @@ pub extern "C" fn wasmtime_config_profiler_set(
     let result = c.config.profiler(match strategy {
         WASMTIME_PROFILING_STRATEGY_NONE => ProfilingStrategy::None,
         WASMTIME_PROFILING_STRATEGY_JITDUMP => ProfilingStrategy::JitDump,
+        WASMTIME_PROFILING_STRATEGY_VTUNE => ProfilingStrategy::VTune,
+        WASMTIME_PROFILING_STRATEGY_PERFMAP => ProfilingStrategy::PerfMap,
     });
     handle_result(result, |_cfg| {})
 }
@@ -165,11 +273,85 @@ pub unsafe extern "C" fn wasmtime_config_cache_config_load(
     )
 }
 
+#[cfg(feature = "cache")]
+struct CCacheStore {
+    get: extern "C" fn(*mut c_void, *const u8, usize, &mut wasm_byte_vec_t) -> bool,
+    insert: extern "C" fn(*mut c_void, *const u8, usize, *const u8, usize) -> bool,
+    env: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+}
+
+// The C API requires that the callbacks and `env` can be used from any thread.
+#[cfg(feature = "cache")]
+unsafe impl Send for CCacheStore {}
+#[cfg(feature = "cache")]
+unsafe impl Sync for CCacheStore {}
+
+#[cfg(feature = "cache")]
+impl std::fmt::Debug for CCacheStore {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("CCacheStore").finish_non_exhaustive()
+    }
+}
+
+#[cfg(feature = "cache")]
+impl CacheStore for CCacheStore {
+    fn get(&self, key: &str) -> Option<Vec<u8>> {
+        let mut out = wasm_byte_vec_t::from(Vec::new());
+        if (self.get)(self.env, key.as_ptr(), key.len(), &mut out) {
+            Some(out.take())
+        } else {
+            None
+        }
+    }
+
+    fn insert(&self, key: &str, value: Vec<u8>) -> bool {
+        (self.insert)(
+            self.env,
+            key.as_ptr(),
+            key.len(),
+            value.as_ptr(),
+            value.len(),
+        )
+    }
+}
+
+#[cfg(feature = "cache")]
+impl Drop for CCacheStore {
+    fn drop(&mut self) {
+        if let Some(f) = self.finalizer {
+            f(self.env);
+        }
+    }
+}
+
+#[no_mangle]
+#[cfg(feature = "cache")]
+pub extern "C" fn wasmtime_config_cache_store_set(
+    c: &mut wasm_config_t,
+    get: extern "C" fn(*mut c_void, *const u8, usize, &mut wasm_byte_vec_t) -> bool,
+    insert: extern "C" fn(*mut c_void, *const u8, usize, *const u8, usize) -> bool,
+    env: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) {
+    c.config.cache_store(Arc::new(CCacheStore {
+        get,
+        insert,
+        env,
+        finalizer,
+    }));
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_config_static_memory_maximum_size_set(c: &mut wasm_config_t, size: u64) {
     c.config.static_memory_maximum_size(size);
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_config_static_memory_forced_set(c: &mut wasm_config_t, enable: bool) {
+    c.config.static_memory_forced(enable);
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_config_static_memory_guard_size_set(c: &mut wasm_config_t, size: u64) {
     c.config.static_memory_guard_size(size);
@@ -179,3 +361,165 @@ pub extern "C" fn wasmtime_config_static_memory_guard_size_set(c: &mut wasm_conf
 pub extern "C" fn wasmtime_config_dynamic_memory_guard_size_set(c: &mut wasm_config_t, size: u64) {
     c.config.dynamic_memory_guard_size(size);
 }
+
+#[no_mangle]
+pub extern "C" fn wasmtime_config_dynamic_memory_reserved_for_growth_set(
+    c: &mut wasm_config_t,
+    size: u64,
+) {
+    c.config.dynamic_memory_reserved_for_growth(size);
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_config_guard_before_linear_memory_set(
+    c: &mut wasm_config_t,
+    enable: bool,
+) {
+    c.config.guard_before_linear_memory(enable);
+}
+
+#[no_mangle]
+#[cfg(feature = "memory-init-cow")]
+pub extern "C" fn wasmtime_config_memory_init_cow_set(c: &mut wasm_config_t, enable: bool) {
+    c.config.memory_init_cow(enable);
+}
+
+#[no_mangle]
+#[cfg(feature = "memory-init-cow")]
+pub extern "C" fn wasmtime_config_force_memory_init_memfd_set(c: &mut wasm_config_t, enable: bool) {
+    c.config.force_memory_init_memfd(enable);
+}
+
+#[no_mangle]
+#[cfg(feature = "memory-init-cow")]
+pub extern "C" fn wasmtime_config_memory_guaranteed_dense_image_size_set(
+    c: &mut wasm_config_t,
+    size: u64,
+) {
+    c.config.memory_guaranteed_dense_image_size(size);
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_config_paged_memory_initialization_set(
+    c: &mut wasm_config_t,
+    enable: bool,
+) {
+    c.config.paged_memory_initialization(enable);
+}
+
+#[no_mangle]
+#[cfg(feature = "parallel-compilation")]
+pub extern "C" fn wasmtime_config_parallel_compilation_set(c: &mut wasm_config_t, enable: bool) {
+    c.config.parallel_compilation(enable);
+}
+
+#[no_mangle]
+#[cfg(feature = "parallel-compilation")]
+pub extern "C" fn wasmtime_config_parallel_compilation_threads_set(
+    c: &mut wasm_config_t,
+    threads: usize,
+) {
+    c.config.parallel_compilation_threads(threads);
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_config_allocation_strategy_set(
+    c: &mut wasm_config_t,
+    strategy: wasmtime_instance_allocation_strategy_t,
+    pooling: Option<&wasmtime_pooling_allocation_config_t>,
+) -> Option<Box<wasmtime_error_t>> {
+    use wasmtime_instance_allocation_strategy_t::*;
+    let strategy = match strategy {
+        WASMTIME_INSTANCE_ALLOCATION_STRATEGY_ON_DEMAND => InstanceAllocationStrategy::OnDemand,
+        WASMTIME_INSTANCE_ALLOCATION_STRATEGY_POOLING => match pooling_strategy(pooling) {
+            Ok(strategy) => strategy,
+            Err(e) => return Some(Box::new(e.into())),
+        },
+    };
+    c.config.allocation_strategy(strategy);
+    None
+}
+
+#[cfg(feature = "pooling-allocator")]
+fn pooling_strategy(
+    pooling: Option<&wasmtime_pooling_allocation_config_t>,
+) -> anyhow::Result<InstanceAllocationStrategy> {
+    Ok(match pooling {
+        Some(pooling) => InstanceAllocationStrategy::Pooling {
+            strategy: pooling.strategy,
+            instance_limits: pooling.instance_limits,
+        },
+        None => InstanceAllocationStrategy::pooling(),
+    })
+}
+
+#[cfg(not(feature = "pooling-allocator"))]
+fn pooling_strategy(
+    _pooling: Option<&wasmtime_pooling_allocation_config_t>,
+) -> anyhow::Result<InstanceAllocationStrategy> {
+    anyhow::bail!("the pooling allocator was not enabled when the C API was compiled")
+}
+
+/// Limits and settings for the pooling instance allocator, mirroring
+/// `wasmtime::InstanceLimits` and `wasmtime::PoolingAllocationStrategy`.
+///
+/// Without the `pooling-allocator` feature this is an empty placeholder so the
+/// exported symbols remain the same regardless of how the C API was built.
+#[derive(Clone, Default)]
+pub struct wasmtime_pooling_allocation_config_t {
+    #[cfg(feature = "pooling-allocator")]
+    strategy: PoolingAllocationStrategy,
+    #[cfg(feature = "pooling-allocator")]
+    instance_limits: InstanceLimits,
+}
+
+wasmtime_c_api_macros::declare_own!(wasmtime_pooling_allocation_config_t);
+
+#[no_mangle]
+pub extern "C" fn wasmtime_pooling_allocation_config_new(
+) -> Box<wasmtime_pooling_allocation_config_t> {
+    Box::new(wasmtime_pooling_allocation_config_t::default())
+}
+
+#[no_mangle]
+#[cfg_attr(not(feature = "pooling-allocator"), allow(unused_variables))]
+pub extern "C" fn wasmtime_pooling_allocation_config_strategy_set(
+    c: &mut wasmtime_pooling_allocation_config_t,
+    strategy: wasmtime_pooling_allocation_strategy_t,
+) {
+    #[cfg(feature = "pooling-allocator")]
+    {
+        use wasmtime_pooling_allocation_strategy_t::*;
+        c.strategy = match strategy {
+            WASMTIME_POOLING_ALLOCATION_STRATEGY_NEXT_AVAILABLE => {
+                PoolingAllocationStrategy::NextAvailable
+            }
+            WASMTIME_POOLING_ALLOCATION_STRATEGY_RANDOM => PoolingAllocationStrategy::Random,
+            WASMTIME_POOLING_ALLOCATION_STRATEGY_REUSE_AFFINITY => {
+                PoolingAllocationStrategy::ReuseAffinity
+            }
+        };
+    }
+}
+
+macro_rules! pooling_limit_setters {
+    ($($setter:ident => $field:ident: $ty:ty,)*) => {$(
+        #[no_mangle]
+        #[cfg_attr(not(feature = "pooling-allocator"), allow(unused_variables))]
+        pub extern "C" fn $setter(c: &mut wasmtime_pooling_allocation_config_t, value: $ty) {
+            #[cfg(feature = "pooling-allocator")]
+            {
+                c.instance_limits.$field = value;
+            }
+        }
+    )*};
+}
+
+pooling_limit_setters! {
+    wasmtime_pooling_allocation_config_instance_count_set => count: u32,
+    wasmtime_pooling_allocation_config_instance_size_set => size: usize,
+    wasmtime_pooling_allocation_config_instance_tables_set => tables: u32,
+    wasmtime_pooling_allocation_config_instance_table_elements_set => table_elements: u32,
+    wasmtime_pooling_allocation_config_instance_memories_set => memories: u32,
+    wasmtime_pooling_allocation_config_instance_memory_pages_set => memory_pages: u64,
+}
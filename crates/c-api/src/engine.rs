@@ -1,4 +1,5 @@
-use crate::wasm_config_t;
+use crate::{wasm_config_t, wasmtime_error_t};
+use std::time::Duration;
 use wasmtime::Engine;
 
 #[repr(C)]
@@ -38,3 +39,21 @@ pub extern "C" fn wasm_engine_new_with_config(c: Box<wasm_config_t>) -> Box<wasm
 pub extern "C" fn wasmtime_engine_increment_epoch(engine: &wasm_engine_t) {
     engine.engine.increment_epoch();
 }
+
+#[no_mangle]
+pub extern "C" fn wasmtime_engine_start_epoch_ticker(
+    engine: &wasm_engine_t,
+    interval_ns: u64,
+) -> Option<Box<wasmtime_error_t>> {
+    crate::handle_result(
+        engine
+            .engine
+            .start_epoch_ticker(Duration::from_nanos(interval_ns)),
+        |()| {},
+    )
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_engine_stop_epoch_ticker(engine: &wasm_engine_t) {
+    engine.engine.stop_epoch_ticker();
+}
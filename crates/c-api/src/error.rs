@@ -1,5 +1,7 @@
 use crate::wasm_name_t;
 use anyhow::{anyhow, Error, Result};
+use std::ffi::CStr;
+use std::os::raw::c_char;
 
 #[repr(C)]
 pub struct wasmtime_error_t {
@@ -14,6 +16,12 @@ impl From<Error> for wasmtime_error_t {
     }
 }
 
+impl From<wasmtime_error_t> for Error {
+    fn from(cerr: wasmtime_error_t) -> Error {
+        cerr.error
+    }
+}
+
 pub(crate) fn handle_result<T>(
     result: Result<T>,
     ok: impl FnOnce(T),
@@ -33,6 +41,14 @@ pub(crate) fn bad_utf8() -> Option<Box<wasmtime_error_t>> {
     }))
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_error_new(msg: *const c_char) -> Box<wasmtime_error_t> {
+    let msg = CStr::from_ptr(msg).to_string_lossy().into_owned();
+    Box::new(wasmtime_error_t {
+        error: anyhow!(msg),
+    })
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_error_message(error: &wasmtime_error_t, message: &mut wasm_name_t) {
     message.set_buffer(format!("{:?}", error.error).into_bytes());
@@ -1,8 +1,11 @@
 use crate::wasm_trap_t;
 use crate::{
-    wasm_extern_t, wasm_functype_t, wasm_store_t, wasm_val_t, wasm_val_vec_t, wasmtime_error_t,
-    wasmtime_extern_t, wasmtime_val_t, wasmtime_val_union, CStoreContext, CStoreContextMut,
+    handle_result, wasm_extern_t, wasm_functype_t, wasm_store_t, wasm_val_t, wasm_val_vec_t,
+    wasmtime_error_t, wasmtime_extern_t, wasmtime_val_t, wasmtime_val_union, CStoreContext,
+    CStoreContextMut,
 };
+use anyhow::anyhow;
+use std::any::Any;
 use std::ffi::c_void;
 use std::mem::{self, MaybeUninit};
 use std::panic::{self, AssertUnwindSafe};
@@ -111,7 +114,7 @@ pub unsafe extern "C" fn wasm_func_new_with_env(
 
 /// Places the `args` into `dst` and additionally reserves space in `dst` for `results_size`
 /// returns. The params/results slices are then returned separately.
-fn translate_args<'a>(
+pub(crate) fn translate_args<'a>(
     dst: &'a mut Vec<Val>,
     args: impl ExactSizeIterator<Item = Val>,
     results_size: usize,
@@ -157,19 +160,23 @@ pub unsafe extern "C" fn wasm_func_call(
             Err(err) => Box::into_raw(Box::new(wasm_trap_t::new(err.into()))),
         },
         Err(panic) => {
-            let trap = if let Some(msg) = panic.downcast_ref::<String>() {
-                Trap::new(msg)
-            } else if let Some(msg) = panic.downcast_ref::<&'static str>() {
-                Trap::new(*msg)
-            } else {
-                Trap::new("rust panic happened")
-            };
-            let trap = Box::new(wasm_trap_t::new(trap));
+            let trap = Box::new(wasm_trap_t::new(trap_from_panic(panic)));
             Box::into_raw(trap)
         }
     }
 }
 
+/// Converts a Rust panic caught while calling wasm into a trap for the caller.
+pub(crate) fn trap_from_panic(panic: Box<dyn Any + Send>) -> Trap {
+    if let Some(msg) = panic.downcast_ref::<String>() {
+        Trap::new(msg)
+    } else if let Some(msg) = panic.downcast_ref::<&'static str>() {
+        Trap::new(*msg)
+    } else {
+        Trap::new("rust panic happened")
+    }
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn wasm_func_type(f: &wasm_func_t) -> Box<wasm_functype_t> {
     Box::new(wasm_functype_t::new(f.func().ty(f.ext.store.context())))
@@ -197,7 +204,7 @@ pub extern "C" fn wasm_func_as_extern_const(f: &wasm_func_t) -> &wasm_extern_t {
 
 #[repr(C)]
 pub struct wasmtime_caller_t<'a> {
-    caller: Caller<'a, crate::StoreData>,
+    pub(crate) caller: Caller<'a, crate::StoreData>,
 }
 
 pub type wasmtime_func_callback_t = extern "C" fn(
@@ -352,13 +359,7 @@ pub unsafe extern "C" fn wasmtime_func_call(
             Err(err) => Some(Box::new(wasmtime_error_t::from(err))),
         },
         Err(panic) => {
-            let trap = if let Some(msg) = panic.downcast_ref::<String>() {
-                Trap::new(msg)
-            } else if let Some(msg) = panic.downcast_ref::<&'static str>() {
-                Trap::new(*msg)
-            } else {
-                Trap::new("rust panic happened")
-            };
+            let trap = trap_from_panic(panic);
             *trap_ret = Box::into_raw(Box::new(wasm_trap_t::new(trap)));
             None
         }
@@ -377,6 +378,75 @@ pub unsafe extern "C" fn wasmtime_func_call_unchecked(
     }
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_func_call_batch(
+    store: CStoreContextMut<'_>,
+    func: &Func,
+    args_and_results: *mut ValRaw,
+    stride: usize,
+    count: usize,
+    trap_index: &mut usize,
+) -> *mut wasm_trap_t {
+    match func.call_unchecked_batch(store, args_and_results, stride, count) {
+        Ok(()) => ptr::null_mut(),
+        Err((index, trap)) => {
+            *trap_index = index;
+            Box::into_raw(Box::new(wasm_trap_t::new(trap)))
+        }
+    }
+}
+
+pub struct wasmtime_typed_func_t {
+    func: Func,
+    params: usize,
+    results: usize,
+}
+
+wasmtime_c_api_macros::declare_own!(wasmtime_typed_func_t);
+
+#[no_mangle]
+pub extern "C" fn wasmtime_typed_func_new(
+    store: CStoreContext<'_>,
+    func: &Func,
+    ty: &wasm_functype_t,
+    ret: &mut *mut wasmtime_typed_func_t,
+) -> Option<Box<wasmtime_error_t>> {
+    let expected = &ty.ty().ty;
+    let actual = func.ty(store);
+    handle_result(
+        if actual == *expected {
+            Ok(())
+        } else {
+            Err(anyhow!(
+                "function type mismatch: expected {:?}, found {:?}",
+                expected,
+                actual
+            ))
+        },
+        |()| {
+            *ret = Box::into_raw(Box::new(wasmtime_typed_func_t {
+                func: *func,
+                params: actual.params().len(),
+                results: actual.results().len(),
+            }));
+        },
+    )
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_typed_func_args_and_results_len(f: &wasmtime_typed_func_t) -> usize {
+    f.params.max(f.results)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_typed_func_call(
+    store: CStoreContextMut<'_>,
+    f: &wasmtime_typed_func_t,
+    args_and_results: *mut ValRaw,
+) -> *mut wasm_trap_t {
+    wasmtime_func_call_unchecked(store, &f.func, args_and_results)
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_func_type(
     store: CStoreContext<'_>,
@@ -411,6 +481,20 @@ pub unsafe extern "C" fn wasmtime_caller_export_get(
     true
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_caller_export_get_by_index(
+    caller: &mut wasmtime_caller_t,
+    index: usize,
+    item: &mut MaybeUninit<wasmtime_extern_t>,
+) -> bool {
+    let which = match caller.caller.get_export_by_index(index) {
+        Some(item) => item,
+        None => return false,
+    };
+    crate::initialize(item, which.into());
+    true
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn wasmtime_func_from_raw(
     store: CStoreContextMut<'_>,
@@ -2,8 +2,9 @@ use crate::{
     handle_result, wasm_extern_t, wasm_globaltype_t, wasm_store_t, wasm_val_t, wasmtime_error_t,
     wasmtime_val_t, CStoreContext, CStoreContextMut,
 };
+use std::ffi::c_void;
 use std::mem::MaybeUninit;
-use wasmtime::{Extern, Global};
+use wasmtime::{Extern, Global, ValType};
 
 #[derive(Clone)]
 #[repr(transparent)]
@@ -115,3 +116,35 @@ pub unsafe extern "C" fn wasmtime_global_set(
 ) -> Option<Box<wasmtime_error_t>> {
     handle_result(global.set(store, val.to_val()), |()| {})
 }
+
+#[no_mangle]
+pub extern "C" fn wasmtime_global_ptr(store: CStoreContext<'_>, global: &Global) -> *mut c_void {
+    match global.ty(&store).content() {
+        ValType::ExternRef | ValType::FuncRef => std::ptr::null_mut(),
+        _ => global.data_ptr(&store).cast(),
+    }
+}
+
+macro_rules! typed_global_getters {
+    ($($name:ident => $ty:ident: $rust:ty,)*) => {$(
+        #[no_mangle]
+        pub unsafe extern "C" fn $name(
+            store: CStoreContext<'_>,
+            global: &Global,
+            out: &mut $rust,
+        ) -> bool {
+            if *global.ty(&store).content() != ValType::$ty {
+                return false;
+            }
+            *out = *global.data_ptr(&store).cast::<$rust>();
+            true
+        }
+    )*};
+}
+
+typed_global_getters! {
+    wasmtime_global_get_i32 => I32: i32,
+    wasmtime_global_get_i64 => I64: i64,
+    wasmtime_global_get_f32 => F32: f32,
+    wasmtime_global_get_f64 => F64: f64,
+}
@@ -3,7 +3,7 @@ use crate::{
     wasmtime_extern_t, wasmtime_module_t, CStoreContextMut, StoreRef,
 };
 use std::mem::MaybeUninit;
-use wasmtime::{Instance, Trap};
+use wasmtime::{Instance, Module, Trap};
 
 #[derive(Clone)]
 pub struct wasm_instance_t {
@@ -130,6 +130,39 @@ pub unsafe extern "C" fn wasmtime_instance_export_get(
     }
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_instance_export_get_by_index(
+    store: CStoreContextMut<'_>,
+    instance: &Instance,
+    index: usize,
+    item: &mut MaybeUninit<wasmtime_extern_t>,
+) -> bool {
+    match instance.get_export_by_index(store, index) {
+        Some(e) => {
+            crate::initialize(item, e.into());
+            true
+        }
+        None => false,
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_instance_snapshot(
+    mut store: CStoreContextMut<'_>,
+    instance: &Instance,
+    wasm: *const u8,
+    wasm_len: usize,
+    ret: &mut *mut wasmtime_module_t,
+) -> Option<Box<wasmtime_error_t>> {
+    let wasm = crate::slice_from_raw_parts(wasm, wasm_len);
+    let result = instance
+        .snapshot(&mut store, wasm)
+        .and_then(|snapshot| Module::from_binary(store.engine(), &snapshot));
+    crate::handle_result(result, |module| {
+        *ret = Box::into_raw(Box::new(wasmtime_module_t { module }));
+    })
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn wasmtime_instance_export_nth(
     store: CStoreContextMut<'_>,
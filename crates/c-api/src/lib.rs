@@ -52,6 +52,11 @@ mod wasi;
 #[cfg(feature = "wasi")]
 pub use crate::wasi::*;
 
+#[cfg(feature = "async")]
+mod r#async;
+#[cfg(feature = "async")]
+pub use crate::r#async::*;
+
 #[cfg(feature = "wat")]
 mod wat2wasm;
 #[cfg(feature = "wat")]
@@ -5,11 +5,11 @@ use crate::{
 use std::ffi::c_void;
 use std::mem::MaybeUninit;
 use std::str;
-use wasmtime::{Func, Instance, Linker};
+use wasmtime::{Func, Instance, InstancePre, Linker};
 
 #[repr(C)]
 pub struct wasmtime_linker_t {
-    linker: Linker<crate::StoreData>,
+    pub(crate) linker: Linker<crate::StoreData>,
 }
 
 #[no_mangle]
@@ -19,6 +19,13 @@ pub extern "C" fn wasmtime_linker_new(engine: &wasm_engine_t) -> Box<wasmtime_li
     })
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_linker_clone(linker: &wasmtime_linker_t) -> Box<wasmtime_linker_t> {
+    Box::new(wasmtime_linker_t {
+        linker: linker.linker.clone(),
+    })
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_linker_allow_shadowing(
     linker: &mut wasmtime_linker_t,
@@ -96,6 +103,46 @@ pub unsafe extern "C" fn wasmtime_linker_define_func_unchecked(
     )
 }
 
+#[repr(C)]
+pub struct wasmtime_linker_func_entry_t {
+    pub module: *const u8,
+    pub module_len: usize,
+    pub name: *const u8,
+    pub name_len: usize,
+    pub ty: *const wasm_functype_t,
+    pub callback: crate::wasmtime_func_callback_t,
+    pub data: *mut c_void,
+    pub finalizer: Option<extern "C" fn(*mut std::ffi::c_void)>,
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_linker_define_func_table(
+    linker: &mut wasmtime_linker_t,
+    entries: *const wasmtime_linker_func_entry_t,
+    len: usize,
+) -> Option<Box<wasmtime_error_t>> {
+    let entries = crate::slice_from_raw_parts(entries, len);
+
+    // Take ownership of every entry's data up front so if a definition fails
+    // the finalizers of the entries after it are still run.
+    let cbs = entries
+        .iter()
+        .map(|e| crate::func::c_callback_to_rust_fn(e.callback, e.data, e.finalizer))
+        .collect::<Vec<_>>();
+
+    let linker = &mut linker.linker;
+    linker.reserve(entries.len());
+    for (entry, cb) in entries.iter().zip(cbs) {
+        let ty = (*entry.ty).ty().ty.clone();
+        let module = to_str!(entry.module, entry.module_len);
+        let name = to_str!(entry.name, entry.name_len);
+        if let Err(e) = linker.func_new(module, name, ty, cb) {
+            return Some(Box::new(e.into()));
+        }
+    }
+    None
+}
+
 #[cfg(feature = "wasi")]
 #[no_mangle]
 pub extern "C" fn wasmtime_linker_define_wasi(
@@ -132,6 +179,38 @@ pub extern "C" fn wasmtime_linker_instantiate(
     super::instance::handle_instantiate(result, instance_ptr, trap_ptr)
 }
 
+pub struct wasmtime_instance_pre_t {
+    underlying: InstancePre<crate::StoreData>,
+}
+
+wasmtime_c_api_macros::declare_own!(wasmtime_instance_pre_t);
+
+#[no_mangle]
+pub extern "C" fn wasmtime_linker_instantiate_pre(
+    linker: &wasmtime_linker_t,
+    store: CStoreContextMut<'_>,
+    module: &wasmtime_module_t,
+    instance_pre: &mut *mut wasmtime_instance_pre_t,
+) -> Option<Box<wasmtime_error_t>> {
+    handle_result(
+        linker.linker.instantiate_pre(store, &module.module),
+        |underlying| {
+            *instance_pre = Box::into_raw(Box::new(wasmtime_instance_pre_t { underlying }));
+        },
+    )
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_instance_pre_instantiate(
+    instance_pre: &wasmtime_instance_pre_t,
+    store: CStoreContextMut<'_>,
+    instance_ptr: &mut Instance,
+    trap_ptr: &mut *mut wasm_trap_t,
+) -> Option<Box<wasmtime_error_t>> {
+    let result = instance_pre.underlying.instantiate(store);
+    super::instance::handle_instantiate(result, instance_ptr, trap_ptr)
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn wasmtime_linker_module(
     linker: &mut wasmtime_linker_t,
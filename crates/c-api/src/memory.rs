@@ -3,6 +3,7 @@ use crate::{
     CStoreContextMut,
 };
 use std::convert::TryFrom;
+use std::io::{IoSlice, IoSliceMut};
 use wasmtime::{Extern, Memory};
 
 #[derive(Clone)]
@@ -127,3 +128,81 @@ pub extern "C" fn wasmtime_memory_grow(
 ) -> Option<Box<wasmtime_error_t>> {
     handle_result(mem.grow(store, delta), |prev| *prev_size = prev)
 }
+
+#[no_mangle]
+pub extern "C" fn wasmtime_memory_decommit_range(
+    store: CStoreContextMut<'_>,
+    mem: &Memory,
+    offset: usize,
+    len: usize,
+) -> Option<Box<wasmtime_error_t>> {
+    handle_result(mem.decommit(store, offset, len), |()| {})
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_memory_reset(
+    store: CStoreContextMut<'_>,
+    mem: &Memory,
+) -> Option<Box<wasmtime_error_t>> {
+    handle_result(mem.reset(store), |()| {})
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_memory_read(
+    store: CStoreContext<'_>,
+    mem: &Memory,
+    offset: usize,
+    buf: *mut u8,
+    len: usize,
+) -> bool {
+    mem.read(store, offset, crate::slice_from_raw_parts_mut(buf, len))
+        .is_ok()
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_memory_write(
+    store: CStoreContextMut<'_>,
+    mem: &Memory,
+    offset: usize,
+    buf: *const u8,
+    len: usize,
+) -> bool {
+    mem.write(store, offset, crate::slice_from_raw_parts(buf, len))
+        .is_ok()
+}
+
+#[repr(C)]
+pub struct wasmtime_iovec_t {
+    data: *mut u8,
+    len: usize,
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_memory_readv(
+    store: CStoreContext<'_>,
+    mem: &Memory,
+    offset: usize,
+    iovs: *const wasmtime_iovec_t,
+    iovs_len: usize,
+) -> bool {
+    let mut bufs = crate::slice_from_raw_parts(iovs, iovs_len)
+        .iter()
+        .map(|iov| IoSliceMut::new(crate::slice_from_raw_parts_mut(iov.data, iov.len)))
+        .collect::<Vec<_>>();
+    mem.read_vectored(store, offset, &mut bufs).is_ok()
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_memory_writev(
+    store: CStoreContextMut<'_>,
+    mem: &Memory,
+    offset: usize,
+    iovs: *const wasmtime_iovec_t,
+    iovs_len: usize,
+) -> bool {
+    let bufs = crate::slice_from_raw_parts(iovs, iovs_len)
+        .iter()
+        .map(|iov| IoSlice::new(crate::slice_from_raw_parts(iov.data, iov.len)))
+        .collect::<Vec<_>>();
+    mem.write_vectored(store, offset, &bufs).is_ok()
+}
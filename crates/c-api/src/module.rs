@@ -2,8 +2,8 @@ use crate::{
     handle_result, wasm_byte_vec_t, wasm_engine_t, wasm_exporttype_t, wasm_exporttype_vec_t,
     wasm_importtype_t, wasm_importtype_vec_t, wasm_store_t, wasmtime_error_t,
 };
-use anyhow::Context;
-use std::ffi::CStr;
+use anyhow::{bail, Context};
+use std::ffi::{c_void, CStr};
 use std::os::raw::c_char;
 use wasmtime::{Engine, Module};
 
@@ -142,6 +142,55 @@ pub unsafe extern "C" fn wasmtime_module_new(
     )
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_module_new_tier_up(
+    engine: &wasm_engine_t,
+    wasm: *const u8,
+    len: usize,
+    out: &mut *mut wasmtime_module_t,
+) -> Option<Box<wasmtime_error_t>> {
+    handle_result(
+        Module::from_binary_tier_up(&engine.engine, crate::slice_from_raw_parts(wasm, len)),
+        |module| {
+            *out = Box::into_raw(Box::new(wasmtime_module_t { module }));
+        },
+    )
+}
+
+pub type wasmtime_module_compile_progress_callback_t =
+    extern "C" fn(env: *mut c_void, completed: usize, total: usize);
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_module_new_with_callback(
+    engine: &wasm_engine_t,
+    wasm: *const u8,
+    len: usize,
+    callback: wasmtime_module_compile_progress_callback_t,
+    env: *mut c_void,
+    out: &mut *mut wasmtime_module_t,
+) -> Option<Box<wasmtime_error_t>> {
+    struct CallbackEnv(*mut c_void);
+    unsafe impl Send for CallbackEnv {}
+    unsafe impl Sync for CallbackEnv {}
+    impl CallbackEnv {
+        fn get(&self) -> *mut c_void {
+            self.0
+        }
+    }
+
+    let env = CallbackEnv(env);
+    handle_result(
+        Module::from_binary_with_progress(
+            &engine.engine,
+            crate::slice_from_raw_parts(wasm, len),
+            move |completed, total| callback(env.get(), completed, total),
+        ),
+        |module| {
+            *out = Box::into_raw(Box::new(wasmtime_module_t { module }));
+        },
+    )
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_module_delete(_module: Box<wasmtime_module_t>) {}
 
@@ -158,6 +207,27 @@ pub extern "C" fn wasmtime_module_exports(
     fill_exports(&module.module, out);
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_module_export_index(
+    module: &wasmtime_module_t,
+    name: *const u8,
+    name_len: usize,
+    index: &mut usize,
+) -> bool {
+    let name = crate::slice_from_raw_parts(name, name_len);
+    let name = match std::str::from_utf8(name) {
+        Ok(name) => name,
+        Err(_) => return false,
+    };
+    match module.module.get_export_index(name) {
+        Some(i) => {
+            *index = i;
+            true
+        }
+        None => false,
+    }
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_module_imports(
     module: &wasmtime_module_t,
@@ -184,6 +254,83 @@ pub extern "C" fn wasmtime_module_serialize(
     handle_result(module.module.serialize(), |buf| ret.set_buffer(buf))
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_module_serialized_size(
+    module: &wasmtime_module_t,
+    size: &mut usize,
+) -> Option<Box<wasmtime_error_t>> {
+    handle_result(module.module.serialized_size(), |s| *size = s)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_module_serialize_into(
+    module: &wasmtime_module_t,
+    buf: *mut u8,
+    len: usize,
+    written: &mut usize,
+) -> Option<Box<wasmtime_error_t>> {
+    let mut buf = crate::slice_from_raw_parts_mut(buf, len);
+    let result = module.module.serialized_size().and_then(|size| {
+        if size > len {
+            bail!(
+                "buffer is too small to serialize the module into: {} bytes are needed but only {} are available",
+                size,
+                len
+            );
+        }
+        module.module.serialize_to(&mut buf)
+    });
+    handle_result(result, |()| *written = len - buf.len())
+}
+
+/// The largest chunk handed to the callback of
+/// `wasmtime_module_serialize_stream` at once.
+const SERIALIZE_CHUNK_SIZE: usize = 1 << 20;
+
+#[no_mangle]
+pub extern "C" fn wasmtime_module_serialize_stream(
+    module: &wasmtime_module_t,
+    callback: extern "C" fn(*mut c_void, *const u8, usize) -> Option<Box<wasmtime_error_t>>,
+    data: *mut c_void,
+) -> Option<Box<wasmtime_error_t>> {
+    struct CallbackWriter {
+        callback: extern "C" fn(*mut c_void, *const u8, usize) -> Option<Box<wasmtime_error_t>>,
+        data: *mut c_void,
+        error: Option<Box<wasmtime_error_t>>,
+    }
+
+    impl std::io::Write for CallbackWriter {
+        fn write(&mut self, buf: &[u8]) -> std::io::Result<usize> {
+            let chunk = &buf[..buf.len().min(SERIALIZE_CHUNK_SIZE)];
+            match (self.callback)(self.data, chunk.as_ptr(), chunk.len()) {
+                None => Ok(chunk.len()),
+                Some(err) => {
+                    self.error = Some(err);
+                    Err(std::io::Error::new(
+                        std::io::ErrorKind::Other,
+                        "serialization callback failed",
+                    ))
+                }
+            }
+        }
+
+        fn flush(&mut self) -> std::io::Result<()> {
+            Ok(())
+        }
+    }
+
+    let mut writer = CallbackWriter {
+        callback,
+        data,
+        error: None,
+    };
+    let result = module.module.serialize_to(&mut writer);
+    match writer.error {
+        Some(err) => Some(err),
+        None => handle_result(result, |()| {}),
+    }
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn wasmtime_module_deserialize(
     engine: &wasm_engine_t,
@@ -212,3 +359,31 @@ pub unsafe extern "C" fn wasmtime_module_deserialize_file(
         *out = Box::into_raw(Box::new(wasmtime_module_t { module }));
     })
 }
+
+#[no_mangle]
+pub extern "C" fn wasmtime_module_has_memory_image(
+    module: &wasmtime_module_t,
+    ret: &mut bool,
+) -> Option<Box<wasmtime_error_t>> {
+    handle_result(module.module.has_memory_image(), |has_image| {
+        *ret = has_image
+    })
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_module_image_range(
+    module: &wasmtime_module_t,
+    start: &mut *const u8,
+    end: &mut *const u8,
+) {
+    let range = module.module.image_range();
+    *start = range.start as *const u8;
+    *end = range.end as *const u8;
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_module_register_debug(
+    module: &wasmtime_module_t,
+) -> Option<Box<wasmtime_error_t>> {
+    handle_result(module.module.register_debug_info(), |()| {})
+}
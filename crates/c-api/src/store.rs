@@ -1,8 +1,11 @@
-use crate::{wasm_engine_t, wasmtime_error_t, wasmtime_val_t, ForeignData};
+use crate::{wasm_engine_t, wasm_name_t, wasmtime_error_t, wasmtime_val_t, ForeignData};
 use std::cell::UnsafeCell;
 use std::ffi::c_void;
 use std::sync::Arc;
-use wasmtime::{AsContext, AsContextMut, Store, StoreContext, StoreContextMut, Val};
+use wasmtime::{
+    AsContext, AsContextMut, DeadlineAction, Engine, FuelAction, ResourceLimiter, Store,
+    StoreContext, StoreContextMut, Val,
+};
 
 /// This representation of a `Store` is used to implement the `wasm.h` API.
 ///
@@ -75,6 +78,41 @@ pub struct StoreData {
     /// Temporary storage for usage during host->wasm calls, same as above but
     /// for a different direction.
     pub wasm_val_storage: Vec<Val>,
+
+    /// Limiter configured with `wasmtime_store_limiter`, if any.
+    limiter: Option<CResourceLimiter>,
+}
+
+struct CResourceLimiter {
+    memory_growing: Option<extern "C" fn(*mut c_void, usize, usize, usize) -> bool>,
+    table_growing: Option<extern "C" fn(*mut c_void, u32, u32, u32) -> bool>,
+    foreign: ForeignData,
+}
+
+impl ResourceLimiter for CResourceLimiter {
+    fn memory_growing(&mut self, current: usize, desired: usize, maximum: Option<usize>) -> bool {
+        match self.memory_growing {
+            Some(f) => f(
+                self.foreign.data,
+                current,
+                desired,
+                maximum.unwrap_or(usize::MAX),
+            ),
+            None => true,
+        }
+    }
+
+    fn table_growing(&mut self, current: u32, desired: u32, maximum: Option<u32>) -> bool {
+        match self.table_growing {
+            Some(f) => f(
+                self.foreign.data,
+                current,
+                desired,
+                maximum.unwrap_or(u32::MAX),
+            ),
+            None => true,
+        }
+    }
 }
 
 #[no_mangle]
@@ -85,21 +123,114 @@ pub extern "C" fn wasmtime_store_new(
     engine: &wasm_engine_t,
     data: *mut c_void,
     finalizer: Option<extern "C" fn(*mut c_void)>,
+) -> Box<wasmtime_store_t> {
+    new_store(&engine.engine, data, finalizer)
+}
+
+fn new_store(
+    engine: &Engine,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
 ) -> Box<wasmtime_store_t> {
     Box::new(wasmtime_store_t {
         store: Store::new(
-            &engine.engine,
+            engine,
             StoreData {
                 foreign: ForeignData { data, finalizer },
                 #[cfg(feature = "wasi")]
                 wasi: None,
                 hostcall_val_storage: Vec::new(),
                 wasm_val_storage: Vec::new(),
+                limiter: None,
             },
         ),
     })
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_store_reset(
+    store: &mut wasmtime_store_t,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) {
+    // Reset the store first so host functions, which may refer to the old
+    // foreign data, are dropped before that data's finalizer runs.
+    store.store.reset();
+    let store_data = store.store.data_mut();
+    store_data.foreign = ForeignData { data, finalizer };
+    #[cfg(feature = "wasi")]
+    {
+        store_data.wasi = None;
+    }
+    store_data.hostcall_val_storage.clear();
+    store_data.wasm_val_storage.clear();
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_store_limiter(
+    store: &mut wasmtime_store_t,
+    memory_growing: Option<extern "C" fn(*mut c_void, usize, usize, usize) -> bool>,
+    table_growing: Option<extern "C" fn(*mut c_void, u32, u32, u32) -> bool>,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) {
+    store.store.data_mut().limiter = Some(CResourceLimiter {
+        memory_growing,
+        table_growing,
+        foreign: ForeignData { data, finalizer },
+    });
+    store
+        .store
+        .limiter(|data| data.limiter.as_mut().unwrap() as &mut dyn ResourceLimiter);
+}
+
+pub struct wasmtime_store_pool_t {
+    engine: Engine,
+    stores: Vec<Box<wasmtime_store_t>>,
+    max_stores: usize,
+}
+
+wasmtime_c_api_macros::declare_own!(wasmtime_store_pool_t);
+
+#[no_mangle]
+pub extern "C" fn wasmtime_store_pool_new(
+    engine: &wasm_engine_t,
+    max_stores: usize,
+) -> Box<wasmtime_store_pool_t> {
+    Box::new(wasmtime_store_pool_t {
+        engine: engine.engine.clone(),
+        stores: Vec::new(),
+        max_stores,
+    })
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_store_pool_take(
+    pool: &mut wasmtime_store_pool_t,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) -> Box<wasmtime_store_t> {
+    match pool.stores.pop() {
+        Some(mut store) => {
+            store.store.data_mut().foreign = ForeignData { data, finalizer };
+            store
+        }
+        None => new_store(&pool.engine, data, finalizer),
+    }
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_store_pool_put(
+    pool: &mut wasmtime_store_pool_t,
+    mut store: Box<wasmtime_store_t>,
+) {
+    if pool.stores.len() >= pool.max_stores || !Engine::same(store.store.engine(), &pool.engine) {
+        return;
+    }
+    wasmtime_store_reset(&mut store, std::ptr::null_mut(), None);
+    pool.stores.push(store);
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_store_context(store: &mut wasmtime_store_t) -> CStoreContextMut<'_> {
     store.store.as_context_mut()
@@ -131,6 +262,34 @@ pub extern "C" fn wasmtime_context_gc(mut context: CStoreContextMut<'_>) {
     context.gc();
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_context_gc_stats(
+    context: CStoreContext<'_>,
+    collections: &mut u64,
+    total_pause_ns: &mut u64,
+    max_pause_ns: &mut u64,
+) {
+    let stats = context.gc_stats();
+    *collections = stats.collections();
+    *total_pause_ns = stats.total_pause().as_nanos() as u64;
+    *max_pause_ns = stats.max_pause().as_nanos() as u64;
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_context_resource_usage(
+    context: CStoreContext<'_>,
+    instances: &mut usize,
+    memory_bytes_committed: &mut usize,
+    memory_bytes_reserved: &mut usize,
+    table_elements: &mut usize,
+) {
+    let usage = context.resource_usage();
+    *instances = usage.instances();
+    *memory_bytes_committed = usage.memory_bytes_committed();
+    *memory_bytes_reserved = usage.memory_bytes_reserved();
+    *table_elements = usage.table_elements();
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_context_add_fuel(
     mut store: CStoreContextMut<'_>,
@@ -161,6 +320,70 @@ pub extern "C" fn wasmtime_context_consume_fuel(
     })
 }
 
+pub type wasmtime_fuel_action_t = u8;
+pub const WASMTIME_FUEL_ACTION_REFUEL: wasmtime_fuel_action_t = 0;
+pub const WASMTIME_FUEL_ACTION_YIELD_AND_REFUEL: wasmtime_fuel_action_t = 1;
+
+#[no_mangle]
+pub extern "C" fn wasmtime_context_out_of_fuel_callback(
+    mut store: CStoreContextMut<'_>,
+    callback: extern "C" fn(
+        CStoreContextMut<'_>,
+        *mut c_void,
+        &mut u64,
+        &mut wasmtime_fuel_action_t,
+    ) -> Option<Box<wasmtime_error_t>>,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) {
+    let foreign = ForeignData { data, finalizer };
+    store.out_of_fuel_callback(move |store| {
+        drop(&foreign); // move entire foreign into this closure
+        let mut fuel = 0;
+        let mut action = WASMTIME_FUEL_ACTION_REFUEL;
+        if let Some(err) = callback(store, foreign.data, &mut fuel, &mut action) {
+            return Err((*err).into());
+        }
+        match action {
+            WASMTIME_FUEL_ACTION_REFUEL => Ok(FuelAction::Refuel(fuel)),
+            WASMTIME_FUEL_ACTION_YIELD_AND_REFUEL => Ok(FuelAction::YieldAndRefuel(fuel)),
+            other => anyhow::bail!("unknown fuel action: {}", other),
+        }
+    });
+}
+
+pub type wasmtime_deadline_action_t = u8;
+pub const WASMTIME_DEADLINE_ACTION_EXTEND: wasmtime_deadline_action_t = 0;
+pub const WASMTIME_DEADLINE_ACTION_YIELD_AND_EXTEND: wasmtime_deadline_action_t = 1;
+
+#[no_mangle]
+pub extern "C" fn wasmtime_context_epoch_deadline_callback(
+    mut store: CStoreContextMut<'_>,
+    callback: extern "C" fn(
+        CStoreContextMut<'_>,
+        *mut c_void,
+        &mut u64,
+        &mut wasmtime_deadline_action_t,
+    ) -> Option<Box<wasmtime_error_t>>,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) {
+    let foreign = ForeignData { data, finalizer };
+    store.epoch_deadline_callback(move |store| {
+        drop(&foreign); // move entire foreign into this closure
+        let mut delta = 0;
+        let mut action = WASMTIME_DEADLINE_ACTION_EXTEND;
+        if let Some(err) = callback(store, foreign.data, &mut delta, &mut action) {
+            return Err((*err).into());
+        }
+        match action {
+            WASMTIME_DEADLINE_ACTION_EXTEND => Ok(DeadlineAction::Extend(delta)),
+            WASMTIME_DEADLINE_ACTION_YIELD_AND_EXTEND => Ok(DeadlineAction::YieldAndExtend(delta)),
+            other => anyhow::bail!("unknown deadline action: {}", other),
+        }
+    });
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_context_set_epoch_deadline(
     mut store: CStoreContextMut<'_>,
@@ -168,3 +391,86 @@ pub extern "C" fn wasmtime_context_set_epoch_deadline(
 ) {
     store.set_epoch_deadline(ticks_beyond_current);
 }
+
+#[no_mangle]
+pub extern "C" fn wasmtime_context_epoch_deadline_sample_and_update(
+    mut store: CStoreContextMut<'_>,
+    delta: u64,
+) {
+    store.epoch_deadline_sample_and_update(delta);
+}
+
+pub struct wasmtime_profile_t {
+    funcs: Vec<ProfileFunc>,
+}
+
+struct ProfileFunc {
+    module_name: Option<wasm_name_t>,
+    func_index: u32,
+    func_name: Option<wasm_name_t>,
+    samples: u64,
+}
+
+wasmtime_c_api_macros::declare_own!(wasmtime_profile_t);
+
+#[no_mangle]
+pub extern "C" fn wasmtime_context_profile_snapshot(
+    store: CStoreContextMut<'_>,
+) -> Box<wasmtime_profile_t> {
+    let funcs = store
+        .profile_samples()
+        .into_iter()
+        .map(|f| ProfileFunc {
+            module_name: f
+                .module_name()
+                .map(|s| wasm_name_t::from_name(s.to_string())),
+            func_index: f.func_index(),
+            func_name: f.func_name().map(|s| wasm_name_t::from_name(s.to_string())),
+            samples: f.samples(),
+        })
+        .collect();
+    Box::new(wasmtime_profile_t { funcs })
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_context_clear_profile(mut store: CStoreContextMut<'_>) {
+    store.clear_profile_samples();
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_profile_len(profile: &wasmtime_profile_t) -> usize {
+    profile.funcs.len()
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_profile_func(
+    profile: &wasmtime_profile_t,
+    index: usize,
+    func_index: &mut u32,
+    samples: &mut u64,
+) -> bool {
+    match profile.funcs.get(index) {
+        Some(f) => {
+            *func_index = f.func_index;
+            *samples = f.samples;
+            true
+        }
+        None => false,
+    }
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_profile_func_name(
+    profile: &wasmtime_profile_t,
+    index: usize,
+) -> Option<&wasm_name_t> {
+    profile.funcs.get(index)?.func_name.as_ref()
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_profile_module_name(
+    profile: &wasmtime_profile_t,
+    index: usize,
+) -> Option<&wasm_name_t> {
+    profile.funcs.get(index)?.module_name.as_ref()
+}
@@ -179,3 +179,44 @@ pub unsafe extern "C" fn wasmtime_table_grow(
         *prev_size = prev
     })
 }
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_table_set_range(
+    store: CStoreContextMut<'_>,
+    table: &Table,
+    dst: u32,
+    vals: *const wasmtime_val_t,
+    len: usize,
+) -> Option<Box<wasmtime_error_t>> {
+    let vals = crate::slice_from_raw_parts(vals, len)
+        .iter()
+        .map(|v| v.to_val())
+        .collect::<Vec<_>>();
+    handle_result(table.set_range(store, dst, &vals), |()| {})
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_table_fill(
+    store: CStoreContextMut<'_>,
+    table: &Table,
+    dst: u32,
+    val: &wasmtime_val_t,
+    len: u32,
+) -> Option<Box<wasmtime_error_t>> {
+    handle_result(table.fill(store, dst, val.to_val(), len), |()| {})
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_table_copy(
+    store: CStoreContextMut<'_>,
+    dst_table: &Table,
+    dst_index: u32,
+    src_table: &Table,
+    src_index: u32,
+    len: u32,
+) -> Option<Box<wasmtime_error_t>> {
+    handle_result(
+        Table::copy(store, dst_table, dst_index, src_table, src_index, len),
+        |()| {},
+    )
+}
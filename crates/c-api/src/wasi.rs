@@ -1,12 +1,17 @@
 //! The WASI embedding API definitions for Wasmtime.
 
+use crate::wasm_byte_vec_t;
 use anyhow::Result;
 use cap_std::ambient_authority;
 use std::ffi::CStr;
 use std::fs::File;
+use std::io::Cursor;
+use std::mem;
 use std::os::raw::{c_char, c_int};
 use std::path::{Path, PathBuf};
 use std::slice;
+use std::sync::{Arc, RwLock};
+use wasi_common::pipe::{ReadPipe, WritePipe};
 use wasmtime_wasi::{
     sync::{Dir, WasiCtxBuilder},
     WasiCtx,
@@ -29,15 +34,43 @@ unsafe fn create_file(path: *const c_char) -> Option<File> {
 pub struct wasi_config_t {
     args: Vec<Vec<u8>>,
     env: Vec<(Vec<u8>, Vec<u8>)>,
-    stdin: Option<File>,
-    stdout: Option<File>,
-    stderr: Option<File>,
+    stdin: WasiConfigReadPipe,
+    stdout: WasiConfigWritePipe,
+    stderr: WasiConfigWritePipe,
     preopens: Vec<(Dir, PathBuf)>,
     inherit_args: bool,
     inherit_env: bool,
-    inherit_stdin: bool,
-    inherit_stdout: bool,
-    inherit_stderr: bool,
+}
+
+enum WasiConfigReadPipe {
+    None,
+    Inherit,
+    File(File),
+    Bytes(Vec<u8>),
+}
+
+impl Default for WasiConfigReadPipe {
+    fn default() -> Self {
+        WasiConfigReadPipe::None
+    }
+}
+
+enum WasiConfigWritePipe {
+    None,
+    Inherit,
+    File(File),
+    Pipe(Arc<RwLock<Vec<u8>>>),
+}
+
+impl Default for WasiConfigWritePipe {
+    fn default() -> Self {
+        WasiConfigWritePipe::None
+    }
+}
+
+fn file_from_std(file: File) -> Box<wasi_cap_std_sync::file::File> {
+    let file = cap_std::fs::File::from_std(file);
+    Box::new(wasi_cap_std_sync::file::File::from_cap_std(file))
 }
 
 impl wasi_config_t {
@@ -67,27 +100,26 @@ impl wasi_config_t {
                 .collect::<Result<Vec<(String, String)>>>()?;
             builder = builder.envs(&env)?;
         }
-        if self.inherit_stdin {
-            builder = builder.inherit_stdin();
-        } else if let Some(file) = self.stdin {
-            let file = cap_std::fs::File::from_std(file);
-            let file = wasi_cap_std_sync::file::File::from_cap_std(file);
-            builder = builder.stdin(Box::new(file));
-        }
-        if self.inherit_stdout {
-            builder = builder.inherit_stdout();
-        } else if let Some(file) = self.stdout {
-            let file = cap_std::fs::File::from_std(file);
-            let file = wasi_cap_std_sync::file::File::from_cap_std(file);
-            builder = builder.stdout(Box::new(file));
-        }
-        if self.inherit_stderr {
-            builder = builder.inherit_stderr();
-        } else if let Some(file) = self.stderr {
-            let file = cap_std::fs::File::from_std(file);
-            let file = wasi_cap_std_sync::file::File::from_cap_std(file);
-            builder = builder.stderr(Box::new(file));
-        }
+        builder = match self.stdin {
+            WasiConfigReadPipe::None => builder,
+            WasiConfigReadPipe::Inherit => builder.inherit_stdin(),
+            WasiConfigReadPipe::File(file) => builder.stdin(file_from_std(file)),
+            WasiConfigReadPipe::Bytes(bytes) => {
+                builder.stdin(Box::new(ReadPipe::new(Cursor::new(bytes))))
+            }
+        };
+        builder = match self.stdout {
+            WasiConfigWritePipe::None => builder,
+            WasiConfigWritePipe::Inherit => builder.inherit_stdout(),
+            WasiConfigWritePipe::File(file) => builder.stdout(file_from_std(file)),
+            WasiConfigWritePipe::Pipe(buf) => builder.stdout(Box::new(WritePipe::from_shared(buf))),
+        };
+        builder = match self.stderr {
+            WasiConfigWritePipe::None => builder,
+            WasiConfigWritePipe::Inherit => builder.inherit_stderr(),
+            WasiConfigWritePipe::File(file) => builder.stderr(file_from_std(file)),
+            WasiConfigWritePipe::Pipe(buf) => builder.stderr(Box::new(WritePipe::from_shared(buf))),
+        };
         for (dir, path) in self.preopens {
             builder = builder.preopened_dir(dir, path)?;
         }
@@ -160,16 +192,22 @@ pub unsafe extern "C" fn wasi_config_set_stdin_file(
         None => return false,
     };
 
-    config.stdin = Some(file);
-    config.inherit_stdin = false;
+    config.stdin = WasiConfigReadPipe::File(file);
 
     true
 }
 
+#[no_mangle]
+pub extern "C" fn wasi_config_set_stdin_bytes(
+    config: &mut wasi_config_t,
+    binary: &mut wasm_byte_vec_t,
+) {
+    config.stdin = WasiConfigReadPipe::Bytes(binary.take());
+}
+
 #[no_mangle]
 pub extern "C" fn wasi_config_inherit_stdin(config: &mut wasi_config_t) {
-    config.stdin = None;
-    config.inherit_stdin = true;
+    config.stdin = WasiConfigReadPipe::Inherit;
 }
 
 #[no_mangle]
@@ -182,16 +220,22 @@ pub unsafe extern "C" fn wasi_config_set_stdout_file(
         None => return false,
     };
 
-    config.stdout = Some(file);
-    config.inherit_stdout = false;
+    config.stdout = WasiConfigWritePipe::File(file);
 
     true
 }
 
+#[no_mangle]
+pub extern "C" fn wasi_config_set_stdout_pipe(
+    config: &mut wasi_config_t,
+    pipe: &wasi_write_pipe_t,
+) {
+    config.stdout = WasiConfigWritePipe::Pipe(pipe.contents.clone());
+}
+
 #[no_mangle]
 pub extern "C" fn wasi_config_inherit_stdout(config: &mut wasi_config_t) {
-    config.stdout = None;
-    config.inherit_stdout = true;
+    config.stdout = WasiConfigWritePipe::Inherit;
 }
 
 #[no_mangle]
@@ -204,16 +248,22 @@ pub unsafe extern "C" fn wasi_config_set_stderr_file(
         None => return false,
     };
 
-    (*config).stderr = Some(file);
-    (*config).inherit_stderr = false;
+    (*config).stderr = WasiConfigWritePipe::File(file);
 
     true
 }
 
+#[no_mangle]
+pub extern "C" fn wasi_config_set_stderr_pipe(
+    config: &mut wasi_config_t,
+    pipe: &wasi_write_pipe_t,
+) {
+    config.stderr = WasiConfigWritePipe::Pipe(pipe.contents.clone());
+}
+
 #[no_mangle]
 pub extern "C" fn wasi_config_inherit_stderr(config: &mut wasi_config_t) {
-    config.stderr = None;
-    config.inherit_stderr = true;
+    config.stderr = WasiConfigWritePipe::Inherit;
 }
 
 #[no_mangle]
@@ -239,3 +289,32 @@ pub unsafe extern "C" fn wasi_config_preopen_dir(
 
     true
 }
+
+/// A growable in-memory buffer that the stdout or stderr of WASI programs can
+/// be written to.
+///
+/// The buffer is shared with every configuration it's installed into, so the
+/// embedder can read what was written after the program runs.
+#[repr(C)]
+#[derive(Default)]
+pub struct wasi_write_pipe_t {
+    contents: Arc<RwLock<Vec<u8>>>,
+}
+
+#[no_mangle]
+pub extern "C" fn wasi_write_pipe_new() -> Box<wasi_write_pipe_t> {
+    Box::new(wasi_write_pipe_t::default())
+}
+
+#[no_mangle]
+pub extern "C" fn wasi_write_pipe_delete(_pipe: Box<wasi_write_pipe_t>) {}
+
+#[no_mangle]
+pub extern "C" fn wasi_write_pipe_contents(pipe: &wasi_write_pipe_t, out: &mut wasm_byte_vec_t) {
+    out.set_buffer(pipe.contents.read().unwrap().clone());
+}
+
+#[no_mangle]
+pub extern "C" fn wasi_write_pipe_take(pipe: &wasi_write_pipe_t, out: &mut wasm_byte_vec_t) {
+    out.set_buffer(mem::take(&mut *pipe.contents.write().unwrap()));
+}
@@ -1,6 +1,7 @@
 use log::{debug, trace, warn};
 use serde::{Deserialize, Serialize};
 use sha2::{Digest, Sha256};
+use std::fmt;
 use std::fs;
 use std::hash::Hash;
 use std::hash::Hasher;
@@ -14,8 +15,37 @@ mod worker;
 pub use config::{create_new_config, CacheConfig};
 use worker::Worker;
 
+/// A storage backend for compiled modules, used in place of the
+/// filesystem-based cache configured through [`CacheConfig`].
+///
+/// Implementations can keep artifacts anywhere, for example in an in-process
+/// LRU or in a remote store shared between machines. Keys are derived from a
+/// hash of the compilation inputs along with the compiler's name and version,
+/// so entries can be shared by any process running the same build.
+///
+/// Both methods may be called concurrently from multiple threads.
+pub trait CacheStore: Send + Sync + fmt::Debug {
+    /// Returns the artifact previously stored for `key`, if any.
+    fn get(&self, key: &str) -> Option<Vec<u8>>;
+
+    /// Stores `value` as the artifact for `key`, returning whether it was
+    /// stored successfully.
+    ///
+    /// Failure to store an artifact isn't an error for the caller, it only
+    /// means the artifact will need to be recomputed next time.
+    fn insert(&self, key: &str, value: Vec<u8>) -> bool;
+}
+
 /// Module level cache entry.
-pub struct ModuleCacheEntry<'config>(Option<ModuleCacheEntryInner<'config>>);
+pub struct ModuleCacheEntry<'config>(Option<Backend<'config>>);
+
+enum Backend<'config> {
+    Fs(ModuleCacheEntryInner<'config>),
+    Store {
+        compiler_dir: String,
+        store: &'config dyn CacheStore,
+    },
+}
 
 struct ModuleCacheEntryInner<'config> {
     root_path: PathBuf,
@@ -28,18 +58,33 @@ impl<'config> ModuleCacheEntry<'config> {
     /// Create the cache entry.
     pub fn new<'data>(compiler_name: &str, cache_config: &'config CacheConfig) -> Self {
         if cache_config.enabled() {
-            Self(Some(ModuleCacheEntryInner::new(
+            Self(Some(Backend::Fs(ModuleCacheEntryInner::new(
                 compiler_name,
                 cache_config,
-            )))
+            ))))
         } else {
             Self(None)
         }
     }
 
+    /// Create the cache entry backed by a custom [`CacheStore`] rather than
+    /// the filesystem.
+    pub fn with_store(compiler_name: &str, store: &'config dyn CacheStore) -> Self {
+        Self(Some(Backend::Store {
+            compiler_dir: compiler_dir(compiler_name),
+            store,
+        }))
+    }
+
+    /// Returns whether this entry is backed by a cache, as opposed to always
+    /// computing data from scratch.
+    pub fn is_enabled(&self) -> bool {
+        self.0.is_some()
+    }
+
     #[cfg(test)]
     fn from_inner(inner: ModuleCacheEntryInner<'config>) -> Self {
-        Self(Some(inner))
+        Self(Some(Backend::Fs(inner)))
     }
 
     /// Gets cached data if state matches, otherwise calls `compute`.
@@ -77,8 +122,8 @@ impl<'config> ModuleCacheEntry<'config> {
     where
         T: Hash,
     {
-        let inner = match &self.0 {
-            Some(inner) => inner,
+        let backend = match &self.0 {
+            Some(backend) => backend,
             None => return compute(state),
         };
 
@@ -88,6 +133,28 @@ impl<'config> ModuleCacheEntry<'config> {
         // standard encoding uses '/' which can't be used for filename
         let hash = base64::encode_config(&hash, base64::URL_SAFE_NO_PAD);
 
+        let inner = match backend {
+            Backend::Fs(inner) => inner,
+            Backend::Store {
+                compiler_dir,
+                store,
+            } => {
+                let key = format!("{}/{}", compiler_dir, hash);
+                trace!("get_data() for key: {}", key);
+                if let Some(cached_val) = store.get(&key) {
+                    if let Some(val) = deserialize(state, cached_val) {
+                        return Ok(val);
+                    }
+                }
+                let val_to_cache = compute(state)?;
+                if let Some(bytes) = serialize(state, &val_to_cache) {
+                    trace!("update_data() for key: {}", key);
+                    store.insert(&key, bytes);
+                }
+                return Ok(val_to_cache);
+            }
+        };
+
         if let Some(cached_val) = inner.get_data(&hash) {
             if let Some(val) = deserialize(state, cached_val) {
                 let mod_cache_path = inner.root_path.join(&hash);
@@ -108,39 +175,7 @@ impl<'config> ModuleCacheEntry<'config> {
 
 impl<'config> ModuleCacheEntryInner<'config> {
     fn new<'data>(compiler_name: &str, cache_config: &'config CacheConfig) -> Self {
-        // If debug assertions are enabled then assume that we're some sort of
-        // local build. We don't want local builds to stomp over caches between
-        // builds, so just use a separate cache directory based on the mtime of
-        // our executable, which should roughly correlate with "you changed the
-        // source code so you get a different directory".
-        //
-        // Otherwise if this is a release build we use the `GIT_REV` env var
-        // which is either the git rev if installed from git or the crate
-        // version if installed from crates.io.
-        let compiler_dir = if cfg!(debug_assertions) {
-            fn self_mtime() -> Option<String> {
-                let path = std::env::current_exe().ok()?;
-                let metadata = path.metadata().ok()?;
-                let mtime = metadata.modified().ok()?;
-                Some(match mtime.duration_since(std::time::UNIX_EPOCH) {
-                    Ok(dur) => format!("{}", dur.as_millis()),
-                    Err(err) => format!("m{}", err.duration().as_millis()),
-                })
-            }
-            let self_mtime = self_mtime().unwrap_or("no-mtime".to_string());
-            format!(
-                "{comp_name}-{comp_ver}-{comp_mtime}",
-                comp_name = compiler_name,
-                comp_ver = env!("GIT_REV"),
-                comp_mtime = self_mtime,
-            )
-        } else {
-            format!(
-                "{comp_name}-{comp_ver}",
-                comp_name = compiler_name,
-                comp_ver = env!("GIT_REV"),
-            )
-        };
+        let compiler_dir = compiler_dir(compiler_name);
         let root_path = cache_config.directory().join("modules").join(compiler_dir);
 
         Self {
@@ -200,6 +235,44 @@ impl<'config> ModuleCacheEntryInner<'config> {
     }
 }
 
+/// Returns the name of the directory, or key prefix, that cache entries for
+/// `compiler_name` are placed under.
+fn compiler_dir(compiler_name: &str) -> String {
+    // If debug assertions are enabled then assume that we're some sort of
+    // local build. We don't want local builds to stomp over caches between
+    // builds, so just use a separate cache directory based on the mtime of
+    // our executable, which should roughly correlate with "you changed the
+    // source code so you get a different directory".
+    //
+    // Otherwise if this is a release build we use the `GIT_REV` env var
+    // which is either the git rev if installed from git or the crate
+    // version if installed from crates.io.
+    if cfg!(debug_assertions) {
+        fn self_mtime() -> Option<String> {
+            let path = std::env::current_exe().ok()?;
+            let metadata = path.metadata().ok()?;
+            let mtime = metadata.modified().ok()?;
+            Some(match mtime.duration_since(std::time::UNIX_EPOCH) {
+                Ok(dur) => format!("{}", dur.as_millis()),
+                Err(err) => format!("m{}", err.duration().as_millis()),
+            })
+        }
+        let self_mtime = self_mtime().unwrap_or("no-mtime".to_string());
+        format!(
+            "{comp_name}-{comp_ver}-{comp_mtime}",
+            comp_name = compiler_name,
+            comp_ver = env!("GIT_REV"),
+            comp_mtime = self_mtime,
+        )
+    } else {
+        format!(
+            "{comp_name}-{comp_ver}",
+            comp_name = compiler_name,
+            comp_ver = env!("GIT_REV"),
+        )
+    }
+}
+
 impl Hasher for Sha256Hasher {
     fn finish(&self) -> u64 {
         panic!("Sha256Hasher doesn't support finish!");
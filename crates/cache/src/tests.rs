@@ -90,3 +90,37 @@ fn test_write_read_cache() {
     entry1.get_data::<_, i32, i32>(4, |_| panic!()).unwrap();
     entry2.get_data::<_, i32, i32>(1, |_| panic!()).unwrap();
 }
+
+#[test]
+fn test_write_read_cache_store() {
+    #[derive(Debug, Default)]
+    struct MemoryStore(std::sync::Mutex<std::collections::HashMap<String, Vec<u8>>>);
+
+    impl CacheStore for MemoryStore {
+        fn get(&self, key: &str) -> Option<Vec<u8>> {
+            self.0.lock().unwrap().get(key).cloned()
+        }
+
+        fn insert(&self, key: &str, value: Vec<u8>) -> bool {
+            self.0.lock().unwrap().insert(key.to_string(), value);
+            true
+        }
+    }
+
+    let store = MemoryStore::default();
+    let entry1 = ModuleCacheEntry::with_store("test-1", &store);
+    let entry2 = ModuleCacheEntry::with_store("test-2", &store);
+
+    entry1.get_data::<_, i32, i32>(1, |_| Ok(100)).unwrap();
+    assert_eq!(entry1.get_data::<_, i32, i32>(1, |_| panic!()), Ok(100));
+
+    entry1.get_data::<_, i32, i32>(2, |_| Ok(200)).unwrap();
+    assert_eq!(entry1.get_data::<_, i32, i32>(1, |_| panic!()), Ok(100));
+    assert_eq!(entry1.get_data::<_, i32, i32>(2, |_| panic!()), Ok(200));
+
+    // Entries are keyed by compiler as well as by state.
+    entry2.get_data::<_, i32, i32>(1, |_| Ok(300)).unwrap();
+    assert_eq!(entry1.get_data::<_, i32, i32>(1, |_| panic!()), Ok(100));
+    assert_eq!(entry2.get_data::<_, i32, i32>(1, |_| panic!()), Ok(300));
+    assert_eq!(store.0.lock().unwrap().len(), 3);
+}
@@ -86,6 +86,24 @@ impl Drop for GdbJitImageRegistration {
 unsafe impl Send for GdbJitImageRegistration {}
 unsafe impl Sync for GdbJitImageRegistration {}
 
+/// Returns whether a debugger appears to be attached to this process.
+///
+/// This is only detected on Linux, by looking for a tracer in
+/// `/proc/self/status`. On other platforms this always returns `false`.
+pub fn debugger_attached() -> bool {
+    #[cfg(target_os = "linux")]
+    {
+        if let Ok(status) = std::fs::read_to_string("/proc/self/status") {
+            for line in status.lines() {
+                if let Some(pid) = line.strip_prefix("TracerPid:") {
+                    return pid.trim() != "0";
+                }
+            }
+        }
+    }
+    false
+}
+
 unsafe fn register_gdb_jit_image(entry: *mut JITCodeEntry) {
     let _lock = GDB_REGISTRATION.lock().unwrap();
     let desc = &mut *wasmtime_jit_debug_descriptor();
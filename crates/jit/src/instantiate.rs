@@ -13,7 +13,7 @@ use serde::{Deserialize, Serialize};
 use std::convert::TryFrom;
 use std::ops::Range;
 use std::str;
-use std::sync::Arc;
+use std::sync::{Arc, Mutex};
 use thiserror::Error;
 use wasmtime_environ::{
     CompileError, DefinedFuncIndex, FuncIndex, FunctionInfo, Module, ModuleTranslation, PrimaryMap,
@@ -21,8 +21,8 @@ use wasmtime_environ::{
     ELF_WASMTIME_TRAPS,
 };
 use wasmtime_runtime::{
-    CompiledModuleId, CompiledModuleIdAllocator, GdbJitImageRegistration, InstantiationError,
-    MmapVec, VMFunctionBody, VMTrampoline,
+    debugger_attached, CompiledModuleId, CompiledModuleIdAllocator, GdbJitImageRegistration,
+    InstantiationError, MmapVec, VMFunctionBody, VMTrampoline,
 };
 
 /// This is the name of the section in the final ELF image which contains
@@ -369,7 +369,7 @@ pub struct CompiledModule {
     meta: Metadata,
     code: Range<usize>,
     code_memory: CodeMemory,
-    dbg_jit_registration: Option<GdbJitImageRegistration>,
+    dbg_jit_registration: Mutex<Option<GdbJitImageRegistration>>,
     /// A unique ID used to register this module with the engine.
     unique_id: CompiledModuleId,
     func_names: Vec<FunctionName>,
@@ -393,11 +393,17 @@ impl CompiledModule {
     ///
     /// The `profiler` argument here is used to inform JIT profiling runtimes
     /// about new code that is loaded.
+    ///
+    /// If `lazy_debug_registration` is set then native debug information, if
+    /// present, is only registered with debuggers here if a debugger is
+    /// currently attached to the process. Otherwise registration is deferred
+    /// until `register_debug_image` is called.
     pub fn from_artifacts(
         mmap: MmapVec,
         info: Option<CompiledModuleInfo>,
         profiler: &dyn ProfilingAgent,
         id_allocator: &CompiledModuleIdAllocator,
+        lazy_debug_registration: bool,
     ) -> Result<Arc<Self>> {
         // Transfer ownership of `obj` to a `CodeMemory` object which will
         // manage permissions, such as the executable bit. Once it's located
@@ -445,33 +451,62 @@ impl CompiledModule {
                 .unwrap_or(0..0),
             trap_data: subslice_range(section(ELF_WASMTIME_TRAPS)?, code.mmap),
             code: subslice_range(code.text, code.mmap),
-            dbg_jit_registration: None,
+            dbg_jit_registration: Mutex::new(None),
             code_memory,
             meta: info.meta,
             unique_id: id_allocator.alloc(),
             func_names: info.func_names,
             func_name_data,
         };
-        ret.register_debug_and_profiling(profiler)?;
+        ret.register_debug_and_profiling(profiler, lazy_debug_registration)?;
 
         Ok(Arc::new(ret))
     }
 
-    fn register_debug_and_profiling(&mut self, profiler: &dyn ProfilingAgent) -> Result<()> {
+    fn register_debug_and_profiling(
+        &mut self,
+        profiler: &dyn ProfilingAgent,
+        lazy_debug_registration: bool,
+    ) -> Result<()> {
         // Register GDB JIT images; initialize profiler and load the wasm module.
-        if self.meta.native_debug_info_present {
-            let code = self.code();
-            let bytes = create_gdbjit_image(self.mmap().to_vec(), (code.as_ptr(), code.len()))
-                .map_err(SetupError::DebugInfo)?;
+        if self.meta.native_debug_info_present && (!lazy_debug_registration || debugger_attached())
+        {
+            let bytes = self.create_debug_image()?;
             profiler.module_load(self, Some(&bytes));
             let reg = GdbJitImageRegistration::register(bytes);
-            self.dbg_jit_registration = Some(reg);
+            *self.dbg_jit_registration.get_mut().unwrap() = Some(reg);
         } else {
             profiler.module_load(self, None);
         }
         Ok(())
     }
 
+    fn create_debug_image(&self) -> Result<Vec<u8>> {
+        let code = self.code();
+        let bytes = create_gdbjit_image(self.mmap().to_vec(), (code.as_ptr(), code.len()))
+            .map_err(SetupError::DebugInfo)?;
+        Ok(bytes)
+    }
+
+    /// Registers this module's native debug information with debuggers, if
+    /// it hasn't been registered already.
+    ///
+    /// This does nothing if the module was compiled without native debug
+    /// information. Registration happens automatically when the module is
+    /// created unless it was created with `lazy_debug_registration`, in which
+    /// case this can be used to register the module once a debugger attaches.
+    pub fn register_debug_image(&self) -> Result<()> {
+        if !self.meta.native_debug_info_present {
+            return Ok(());
+        }
+        let mut registration = self.dbg_jit_registration.lock().unwrap();
+        if registration.is_none() {
+            let bytes = self.create_debug_image()?;
+            *registration = Some(GdbJitImageRegistration::register(bytes));
+        }
+        Ok(())
+    }
+
     /// Get this module's unique ID. It is unique with respect to a
     /// single allocator (which is ordinarily held on a Wasm engine).
     pub fn unique_id(&self) -> CompiledModuleId {
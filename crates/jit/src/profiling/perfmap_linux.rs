@@ -0,0 +1,90 @@
+//! Support for perf map files which can be used by `perf` to symbolize jitted
+//! code without any post-processing.
+//!
+//! Each line of `/tmp/perf-<pid>.map` describes one function as
+//! `START SIZE symbolname`, with `START` and `SIZE` in hexadecimal. See
+//! <https://git.kernel.org/pub/scm/linux/kernel/git/torvalds/linux.git/tree/tools/perf/Documentation/jit-interface.txt>
+//!
+//! Usage Example:
+//!     Record
+//!         perf record -k 1 -e instructions:u target/debug/wasmtime --perfmap test.wasm
+//!     Report
+//!         perf report
+//! Note: unlike jitdump, `perf top` can also be run directly against a live
+//! process, since `perf` reads the map file whenever it needs symbols.
+
+use crate::{CompiledModule, ProfilingAgent};
+use anyhow::Result;
+use std::fs::{File, OpenOptions};
+use std::io::{self, Write};
+use std::process;
+use std::sync::Mutex;
+use wasmtime_environ::EntityRef;
+
+/// Interface for driving the creation of perf map files
+pub struct PerfMapAgent {
+    // Note that we use a mutex internally to serialize writing out to our
+    // `perf_map_file` within this process, since multiple threads may be
+    // sharing this agent and each line must be written atomically.
+    perf_map_file: Mutex<File>,
+}
+
+impl PerfMapAgent {
+    /// Intialize a PerfMapAgent, opening the perf map file for this process.
+    pub fn new() -> Result<Self> {
+        let filename = format!("/tmp/perf-{}.map", process::id());
+        let perf_map_file = OpenOptions::new()
+            .create(true)
+            .append(true)
+            .open(&filename)?;
+        Ok(PerfMapAgent {
+            perf_map_file: Mutex::new(perf_map_file),
+        })
+    }
+
+    fn write_entries(&self, entries: &[u8]) {
+        if let Err(e) = self.perf_map_file.lock().unwrap().write_all(entries) {
+            println!("Error when writing perf map file: {}", e);
+        }
+    }
+}
+
+fn write_entry(out: &mut Vec<u8>, addr: *const u8, size: usize, name: &str) -> io::Result<()> {
+    // Symbol names end at the end of the line, so make sure they're a single
+    // line.
+    let name = name.replace('\n', " ");
+    writeln!(out, "{:x} {:x} {}", addr as usize, size, name)
+}
+
+impl ProfilingAgent for PerfMapAgent {
+    fn module_load(&self, module: &CompiledModule, _dbg_image: Option<&[u8]>) {
+        // Build all entries for the module up front so they're written with
+        // a single `write` call and only hold the lock briefly.
+        let mut entries = Vec::new();
+        for (idx, func) in module.finished_functions() {
+            let (addr, len) = unsafe { ((*func).as_ptr().cast::<u8>(), (*func).len()) };
+            let name = super::debug_name(module, idx);
+            write_entry(&mut entries, addr, len, &name).unwrap();
+        }
+
+        // Note: these are the trampolines into exported functions.
+        for (idx, func, len) in module.trampolines() {
+            let name = format!("wasm::trampoline[{}]", idx.index());
+            write_entry(&mut entries, func as usize as *const u8, len, &name).unwrap();
+        }
+        self.write_entries(&entries);
+    }
+
+    fn load_single_trampoline(
+        &self,
+        name: &str,
+        addr: *const u8,
+        size: usize,
+        _pid: u32,
+        _tid: u32,
+    ) {
+        let mut entries = Vec::new();
+        write_entry(&mut entries, addr, size, name).unwrap();
+        self.write_entries(&entries);
+    }
+}
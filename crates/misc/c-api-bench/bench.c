@@ -0,0 +1,422 @@
+/*
+Benchmarks of the overhead of Wasmtime's C API.
+
+These mirror the Rust API's benchmarks in `benches/call.rs` and
+`benches/instantiation.rs`, but measure the costs embedders using the C API
+see, such as converting to and from `wasmtime_val_t` and looking up exports
+of a caller.
+
+This is built and run by `cargo run -p c-api-bench [filter]`, which passes the
+filter and the instantiation inputs as arguments.
+*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wasm.h>
+#include <wasi.h>
+#include <wasmtime.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static void exit_with_error(const char *message, wasmtime_error_t *error, wasm_trap_t *trap);
+
+static const char *filter = "";
+
+static uint64_t now_ns() {
+#ifdef _WIN32
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (uint64_t) ((double) counter.QuadPart * 1e9 / (double) frequency.QuadPart);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+// Runs `f` with an increasing number of iterations until a run takes at least
+// 100ms, and reports the time per iteration of that run.
+static void bench(const char *name, void (*f)(void *ctx, uint64_t iters), void *ctx) {
+  if (strstr(name, filter) == NULL)
+    return;
+  f(ctx, 1);
+  uint64_t iters = 1;
+  for (;;) {
+    uint64_t start = now_ns();
+    f(ctx, iters);
+    uint64_t elapsed = now_ns() - start;
+    if (elapsed >= 100000000 || iters >= ((uint64_t) 1 << 40)) {
+      printf("%-60s %12.1f ns/iter\n", name, (double) elapsed / (double) iters);
+      return;
+    }
+    iters *= 2;
+  }
+}
+
+static void read_file(const char *path, wasm_byte_vec_t *ret) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    fprintf(stderr, "error: failed to open %s\n", path);
+    exit(1);
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_new_uninitialized(ret, file_size);
+  size_t nread = file_size > 0 ? fread(ret->data, file_size, 1, file) : 1;
+  fclose(file);
+  if (nread != 1) {
+    fprintf(stderr, "error: failed to read %s\n", path);
+    exit(1);
+  }
+}
+
+static wasmtime_module_t *compile_wat(wasm_engine_t *engine, const char *wat) {
+  wasm_byte_vec_t wasm;
+  wasmtime_error_t *error = wasmtime_wat2wasm(wat, strlen(wat), &wasm);
+  if (error != NULL)
+    exit_with_error("failed to parse wat", error, NULL);
+  wasmtime_module_t *module = NULL;
+  error = wasmtime_module_new(engine, (uint8_t*) wasm.data, wasm.size, &module);
+  wasm_byte_vec_delete(&wasm);
+  if (error != NULL)
+    exit_with_error("failed to compile module", error, NULL);
+  return module;
+}
+
+static wasmtime_func_t get_func(wasmtime_context_t *context, const wasmtime_instance_t *instance, const char *name) {
+  wasmtime_extern_t item;
+  bool ok = wasmtime_instance_export_get(context, instance, name, strlen(name), &item);
+  assert(ok);
+  assert(item.kind == WASMTIME_EXTERN_FUNC);
+  return item.of.func;
+}
+
+// Host-to-wasm calls
+
+struct call_ctx {
+  wasmtime_context_t *context;
+  wasmtime_func_t func;
+};
+
+static void call_nop(void *ctx, uint64_t iters) {
+  struct call_ctx *c = ctx;
+  for (uint64_t i = 0; i < iters; i++) {
+    wasm_trap_t *trap = NULL;
+    wasmtime_error_t *error = wasmtime_func_call(c->context, &c->func, NULL, 0, NULL, 0, &trap);
+    if (error != NULL || trap != NULL)
+      exit_with_error("failed to call function", error, trap);
+  }
+}
+
+static void call_nop_unchecked(void *ctx, uint64_t iters) {
+  struct call_ctx *c = ctx;
+  for (uint64_t i = 0; i < iters; i++) {
+    wasm_trap_t *trap = wasmtime_func_call_unchecked(c->context, &c->func, NULL);
+    if (trap != NULL)
+      exit_with_error("failed to call function", NULL, trap);
+  }
+}
+
+static void call_i32(void *ctx, uint64_t iters) {
+  struct call_ctx *c = ctx;
+  for (uint64_t i = 0; i < iters; i++) {
+    wasmtime_val_t arg, result;
+    arg.kind = WASMTIME_I32;
+    arg.of.i32 = (int32_t) i;
+    wasm_trap_t *trap = NULL;
+    wasmtime_error_t *error = wasmtime_func_call(c->context, &c->func, &arg, 1, &result, 1, &trap);
+    if (error != NULL || trap != NULL)
+      exit_with_error("failed to call function", error, trap);
+  }
+}
+
+static void call_i32_unchecked(void *ctx, uint64_t iters) {
+  struct call_ctx *c = ctx;
+  for (uint64_t i = 0; i < iters; i++) {
+    wasmtime_val_raw_t args_and_results[1];
+    args_and_results[0].i32 = (int32_t) i;
+    wasm_trap_t *trap = wasmtime_func_call_unchecked(c->context, &c->func, args_and_results);
+    if (trap != NULL)
+      exit_with_error("failed to call function", NULL, trap);
+  }
+}
+
+static void host_to_wasm(wasm_engine_t *engine) {
+  wasmtime_module_t *module = compile_wat(engine,
+      "(module"
+      "  (func (export \"nop\"))"
+      "  (func (export \"i32\") (param i32) (result i32) local.get 0))");
+  wasmtime_store_t *store = wasmtime_store_new(engine, NULL, NULL);
+  wasmtime_context_t *context = wasmtime_store_context(store);
+  wasmtime_instance_t instance;
+  wasm_trap_t *trap = NULL;
+  wasmtime_error_t *error = wasmtime_instance_new(context, module, NULL, 0, &instance, &trap);
+  if (error != NULL || trap != NULL)
+    exit_with_error("failed to instantiate", error, trap);
+
+  struct call_ctx ctx = { context, get_func(context, &instance, "nop") };
+  bench("host-to-wasm/nop/wasmtime_func_call", call_nop, &ctx);
+  bench("host-to-wasm/nop/wasmtime_func_call_unchecked", call_nop_unchecked, &ctx);
+  ctx.func = get_func(context, &instance, "i32");
+  bench("host-to-wasm/i32/wasmtime_func_call", call_i32, &ctx);
+  bench("host-to-wasm/i32/wasmtime_func_call_unchecked", call_i32_unchecked, &ctx);
+
+  wasmtime_store_delete(store);
+  wasmtime_module_delete(module);
+}
+
+// Wasm-to-host calls
+
+static wasm_trap_t* host_i32(
+    void *env,
+    wasmtime_caller_t *caller,
+    const wasmtime_val_t *args,
+    size_t nargs,
+    wasmtime_val_t *results,
+    size_t nresults) {
+  results[0] = args[0];
+  return NULL;
+}
+
+static wasm_trap_t* host_i32_unchecked(
+    void *env,
+    wasmtime_caller_t *caller,
+    wasmtime_val_raw_t *args_and_results) {
+  return NULL;
+}
+
+static wasm_trap_t* host_i32_caller_export(
+    void *env,
+    wasmtime_caller_t *caller,
+    const wasmtime_val_t *args,
+    size_t nargs,
+    wasmtime_val_t *results,
+    size_t nresults) {
+  wasmtime_extern_t memory;
+  bool ok = wasmtime_caller_export_get(caller, "memory", 6, &memory);
+  assert(ok);
+  results[0] = args[0];
+  return NULL;
+}
+
+static void call_loop(void *ctx, uint64_t iters) {
+  struct call_ctx *c = ctx;
+  while (iters > 0) {
+    uint64_t n = iters > INT32_MAX ? INT32_MAX : iters;
+    wasmtime_val_t arg;
+    arg.kind = WASMTIME_I32;
+    arg.of.i32 = (int32_t) n;
+    wasm_trap_t *trap = NULL;
+    wasmtime_error_t *error = wasmtime_func_call(c->context, &c->func, &arg, 1, NULL, 0, &trap);
+    if (error != NULL || trap != NULL)
+      exit_with_error("failed to call function", error, trap);
+    iters -= n;
+  }
+}
+
+static void wasm_to_host(wasm_engine_t *engine) {
+  // `run` calls the host import `n` times in a loop, so each iteration is
+  // one call from wasm to the host.
+  wasmtime_module_t *module = compile_wat(engine,
+      "(module"
+      "  (import \"\" \"host\" (func $host (param i32) (result i32)))"
+      "  (memory (export \"memory\") 1)"
+      "  (func (export \"run\") (param $n i32)"
+      "    (loop $l"
+      "      (drop (call $host (local.get $n)))"
+      "      (br_if $l (local.tee $n (i32.sub (local.get $n) (i32.const 1)))))))");
+  wasm_functype_t *ty = wasm_functype_new_1_1(wasm_valtype_new_i32(), wasm_valtype_new_i32());
+
+  struct {
+    const char *name;
+    wasmtime_func_callback_t callback;
+    wasmtime_func_unchecked_callback_t unchecked;
+  } hosts[] = {
+    { "wasm-to-host/wasmtime_func_new", host_i32, NULL },
+    { "wasm-to-host/wasmtime_func_new_unchecked", NULL, host_i32_unchecked },
+    { "wasm-to-host/wasmtime_caller_export_get", host_i32_caller_export, NULL },
+  };
+  for (size_t i = 0; i < sizeof(hosts) / sizeof(hosts[0]); i++) {
+    wasmtime_store_t *store = wasmtime_store_new(engine, NULL, NULL);
+    wasmtime_context_t *context = wasmtime_store_context(store);
+    wasmtime_extern_t import;
+    import.kind = WASMTIME_EXTERN_FUNC;
+    if (hosts[i].callback != NULL)
+      wasmtime_func_new(context, ty, hosts[i].callback, NULL, NULL, &import.of.func);
+    else
+      wasmtime_func_new_unchecked(context, ty, hosts[i].unchecked, NULL, NULL, &import.of.func);
+
+    wasmtime_instance_t instance;
+    wasm_trap_t *trap = NULL;
+    wasmtime_error_t *error = wasmtime_instance_new(context, module, &import, 1, &instance, &trap);
+    if (error != NULL || trap != NULL)
+      exit_with_error("failed to instantiate", error, trap);
+
+    struct call_ctx ctx = { context, get_func(context, &instance, "run") };
+    bench(hosts[i].name, call_loop, &ctx);
+    wasmtime_store_delete(store);
+  }
+
+  wasm_functype_delete(ty);
+  wasmtime_module_delete(module);
+}
+
+// Instantiation and serialization
+
+struct module_ctx {
+  wasm_engine_t *engine;
+  wasmtime_linker_t *linker;
+  wasmtime_module_t *module;
+  wasmtime_instance_pre_t *instance_pre;
+  wasm_byte_vec_t serialized;
+};
+
+static wasmtime_store_t *new_wasi_store(wasm_engine_t *engine) {
+  wasmtime_store_t *store = wasmtime_store_new(engine, NULL, NULL);
+  wasmtime_error_t *error = wasmtime_context_set_wasi(wasmtime_store_context(store), wasi_config_new());
+  if (error != NULL)
+    exit_with_error("failed to configure wasi", error, NULL);
+  return store;
+}
+
+static void linker_instantiate(void *ctx, uint64_t iters) {
+  struct module_ctx *c = ctx;
+  for (uint64_t i = 0; i < iters; i++) {
+    wasmtime_store_t *store = new_wasi_store(c->engine);
+    wasmtime_instance_t instance;
+    wasm_trap_t *trap = NULL;
+    wasmtime_error_t *error = wasmtime_linker_instantiate(c->linker, wasmtime_store_context(store), c->module, &instance, &trap);
+    if (error != NULL || trap != NULL)
+      exit_with_error("failed to instantiate", error, trap);
+    wasmtime_store_delete(store);
+  }
+}
+
+static void instance_pre_instantiate(void *ctx, uint64_t iters) {
+  struct module_ctx *c = ctx;
+  for (uint64_t i = 0; i < iters; i++) {
+    wasmtime_store_t *store = new_wasi_store(c->engine);
+    wasmtime_instance_t instance;
+    wasm_trap_t *trap = NULL;
+    wasmtime_error_t *error = wasmtime_instance_pre_instantiate(c->instance_pre, wasmtime_store_context(store), &instance, &trap);
+    if (error != NULL || trap != NULL)
+      exit_with_error("failed to instantiate", error, trap);
+    wasmtime_store_delete(store);
+  }
+}
+
+static void module_serialize(void *ctx, uint64_t iters) {
+  struct module_ctx *c = ctx;
+  for (uint64_t i = 0; i < iters; i++) {
+    wasm_byte_vec_t serialized;
+    wasmtime_error_t *error = wasmtime_module_serialize(c->module, &serialized);
+    if (error != NULL)
+      exit_with_error("failed to serialize module", error, NULL);
+    wasm_byte_vec_delete(&serialized);
+  }
+}
+
+static void module_deserialize(void *ctx, uint64_t iters) {
+  struct module_ctx *c = ctx;
+  for (uint64_t i = 0; i < iters; i++) {
+    wasmtime_module_t *module = NULL;
+    wasmtime_error_t *error = wasmtime_module_deserialize(c->engine, (uint8_t*) c->serialized.data, c->serialized.size, &module);
+    if (error != NULL)
+      exit_with_error("failed to deserialize module", error, NULL);
+    wasmtime_module_delete(module);
+  }
+}
+
+static void instantiation(wasm_engine_t *engine, const char *path) {
+  wasm_byte_vec_t bytes;
+  read_file(path, &bytes);
+  size_t len = strlen(path);
+  if (len > 4 && strcmp(path + len - 4, ".wat") == 0) {
+    wasm_byte_vec_t wasm;
+    wasmtime_error_t *error = wasmtime_wat2wasm(bytes.data, bytes.size, &wasm);
+    if (error != NULL)
+      exit_with_error("failed to parse wat", error, NULL);
+    wasm_byte_vec_delete(&bytes);
+    bytes = wasm;
+  }
+
+  struct module_ctx ctx;
+  ctx.engine = engine;
+  wasmtime_error_t *error = wasmtime_module_new(engine, (uint8_t*) bytes.data, bytes.size, &ctx.module);
+  wasm_byte_vec_delete(&bytes);
+  if (error != NULL)
+    exit_with_error("failed to compile module", error, NULL);
+  error = wasmtime_module_serialize(ctx.module, &ctx.serialized);
+  if (error != NULL)
+    exit_with_error("failed to serialize module", error, NULL);
+
+  ctx.linker = wasmtime_linker_new(engine);
+  error = wasmtime_linker_define_wasi(ctx.linker);
+  if (error != NULL)
+    exit_with_error("failed to define wasi", error, NULL);
+  wasmtime_store_t *store = new_wasi_store(engine);
+  error = wasmtime_linker_instantiate_pre(ctx.linker, wasmtime_store_context(store), ctx.module, &ctx.instance_pre);
+  wasmtime_store_delete(store);
+  if (error != NULL)
+    exit_with_error("failed to pre-instantiate", error, NULL);
+
+  // Name benchmarks after the file name, without its directory.
+  const char *file = path;
+  for (const char *p = path; *p != '\0'; p++)
+    if (*p == '/' || *p == '\\')
+      file = p + 1;
+  char name[256];
+  snprintf(name, sizeof(name), "instantiate/%s/wasmtime_linker_instantiate", file);
+  bench(name, linker_instantiate, &ctx);
+  snprintf(name, sizeof(name), "instantiate/%s/wasmtime_instance_pre_instantiate", file);
+  bench(name, instance_pre_instantiate, &ctx);
+  snprintf(name, sizeof(name), "serialize/%s/wasmtime_module_serialize", file);
+  bench(name, module_serialize, &ctx);
+  snprintf(name, sizeof(name), "deserialize/%s/wasmtime_module_deserialize", file);
+  bench(name, module_deserialize, &ctx);
+
+  wasmtime_instance_pre_delete(ctx.instance_pre);
+  wasmtime_linker_delete(ctx.linker);
+  wasm_byte_vec_delete(&ctx.serialized);
+  wasmtime_module_delete(ctx.module);
+}
+
+int main(int argc, const char *argv[]) {
+  if (argc > 1)
+    filter = argv[1];
+
+  wasm_engine_t *engine = wasm_engine_new();
+  assert(engine != NULL);
+
+  host_to_wasm(engine);
+  wasm_to_host(engine);
+  for (int i = 2; i < argc; i++)
+    instantiation(engine, argv[i]);
+
+  wasm_engine_delete(engine);
+  return 0;
+}
+
+static void exit_with_error(const char *message, wasmtime_error_t *error, wasm_trap_t *trap) {
+  fprintf(stderr, "error: %s\n", message);
+  wasm_byte_vec_t error_message;
+  if (error != NULL) {
+    wasmtime_error_message(error, &error_message);
+    wasmtime_error_delete(error);
+  } else {
+    wasm_trap_message(trap, &error_message);
+    wasm_trap_delete(trap);
+  }
+  fprintf(stderr, "%.*s\n", (int) error_message.size, error_message.data);
+  wasm_byte_vec_delete(&error_message);
+  exit(1);
+}
@@ -0,0 +1,7 @@
+fn main() {
+    println!(
+        "cargo:rustc-env=TARGET={}",
+        std::env::var("TARGET").unwrap()
+    );
+    println!("cargo:rerun-if-changed=build.rs");
+}
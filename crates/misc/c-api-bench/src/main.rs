@@ -0,0 +1,81 @@
+//! Builds and runs the benchmarks of Wasmtime's C API in `bench.c`.
+//!
+//! Usage, from the root of the repository:
+//!
+//! ```text
+//! cargo run -p c-api-bench [filter]
+//! ```
+//!
+//! Only benchmarks whose name contains `filter` are run, if it's given. The
+//! instantiation benchmarks are run for each module in
+//! `benches/instantiation`, like the Rust API's `instantiation` benchmark.
+
+use anyhow::Context;
+use std::process::Command;
+
+fn main() -> anyhow::Result<()> {
+    let filter = std::env::args().nth(1).unwrap_or_default();
+
+    println!("======== Building libwasmtime.a ===========");
+    run(Command::new("cargo")
+        .args(&["build", "--release"])
+        .current_dir("crates/c-api"))?;
+
+    println!("======== Building benchmarks ===========");
+    let mut cmd = cc::Build::new()
+        .opt_level(2)
+        .cargo_metadata(false)
+        .target(env!("TARGET"))
+        .host(env!("TARGET"))
+        .include("crates/c-api/include")
+        .include("crates/c-api/wasm-c-api/include")
+        .define("WASM_API_EXTERN", Some("")) // static linkage, not dynamic
+        .warnings(false)
+        .get_compiler()
+        .to_command();
+    cmd.arg("crates/misc/c-api-bench/bench.c");
+    let exe = if cfg!(windows) {
+        cmd.arg("target/release/wasmtime.lib")
+            .arg("ws2_32.lib")
+            .arg("advapi32.lib")
+            .arg("userenv.lib")
+            .arg("ntdll.lib")
+            .arg("shell32.lib")
+            .arg("ole32.lib")
+            .arg("bcrypt.lib");
+        "./bench.exe"
+    } else {
+        cmd.arg("target/release/libwasmtime.a")
+            .arg("-o")
+            .arg("c-api-bench");
+        "./c-api-bench"
+    };
+    if cfg!(target_os = "linux") {
+        cmd.arg("-lpthread").arg("-ldl").arg("-lm");
+    }
+    run(&mut cmd)?;
+
+    let mut inputs = Vec::new();
+    for file in std::fs::read_dir("benches/instantiation")? {
+        let path = file?.path();
+        match path.extension().and_then(|s| s.to_str()) {
+            Some("wat") | Some("wasm") => inputs.push(path),
+            _ => {}
+        }
+    }
+    inputs.sort();
+
+    println!("======== Running benchmarks ===========");
+    run(Command::new(exe).arg(&filter).args(&inputs))
+}
+
+fn run(cmd: &mut Command) -> anyhow::Result<()> {
+    (|| -> anyhow::Result<()> {
+        let s = cmd.status()?;
+        if !s.success() {
+            anyhow::bail!("Exited with failure status: {}", s);
+        }
+        Ok(())
+    })()
+    .with_context(|| format!("failed to run `{:?}`", cmd))
+}
@@ -298,6 +298,10 @@ pub struct MemoryImageSlot {
     /// from offset 0 to `initial_size` are accessible R+W and the
     /// rest of the slot is inaccessible.
     dirty: bool,
+    /// Whether `decommit` replaced part of the mapping of `image` with
+    /// anonymous memory, in which case the image can no longer be restored
+    /// by `clear_and_remain_ready` with `madvise`.
+    remapped: bool,
     /// Whether this MemoryImageSlot is responsible for mapping anonymous
     /// memory (to hold the reservation while overwriting mappings
     /// specific to this slot) in place when it is dropped. Default
@@ -317,6 +321,7 @@ impl MemoryImageSlot {
             cur_size: initial_size,
             image: None,
             dirty: false,
+            remapped: false,
             clear_on_drop: true,
         }
     }
@@ -470,18 +475,32 @@ impl MemoryImageSlot {
 
         cfg_if::cfg_if! {
             if #[cfg(target_os = "linux")] {
-                // On Linux we can use `madvise` to reset the virtual memory
-                // back to its original state. This means back to all zeros for
-                // anonymous-backed pages and back to the original contents for
-                // CoW memory (the initial heap image). This has the precise
-                // semantics we want for reuse between instances, so it's all we
-                // need to do.
-                unsafe {
-                    rustix::io::madvise(
-                        self.base as *mut c_void,
-                        self.cur_size,
-                        rustix::io::Advice::LinuxDontNeed,
+                if self.remapped {
+                    // Part of the image was replaced with zeros by
+                    // `decommit`, so resetting the pages wouldn't restore
+                    // it. Start over with an empty slot instead, with the
+                    // initial heap accessible as usual.
+                    self.reset_with_anon_memory()?;
+                    self.set_protection(
+                        0..self.initial_size,
+                        rustix::io::MprotectFlags::READ | rustix::io::MprotectFlags::WRITE,
                     )?;
+                    self.image = None;
+                    self.remapped = false;
+                } else {
+                    // On Linux we can use `madvise` to reset the virtual memory
+                    // back to its original state. This means back to all zeros for
+                    // anonymous-backed pages and back to the original contents for
+                    // CoW memory (the initial heap image). This has the precise
+                    // semantics we want for reuse between instances, so it's all we
+                    // need to do.
+                    unsafe {
+                        rustix::io::madvise(
+                            self.base as *mut c_void,
+                            self.cur_size,
+                            rustix::io::Advice::LinuxDontNeed,
+                        )?;
+                    }
                 }
             } else {
                 // If we're not on Linux, however, then there's no generic
@@ -493,6 +512,7 @@ impl MemoryImageSlot {
                 // since it's no longer applicable to this mapping.
                 self.reset_with_anon_memory()?;
                 self.image = None;
+                self.remapped = false;
             }
         }
 
@@ -506,6 +526,26 @@ impl MemoryImageSlot {
         Ok(())
     }
 
+    /// Zeroes the bytes in `range` of the heap, releasing the pages wholly
+    /// within it.
+    pub(crate) fn decommit(&mut self, range: Range<usize>) -> Result<()> {
+        assert!(self.dirty);
+        assert!(range.end <= self.cur_size);
+
+        // Discarding pages of the image's private mapping would restore the
+        // image's contents, so if the range overlaps the image its pages are
+        // replaced with anonymous memory instead.
+        let overlaps_image = self.image.as_ref().map_or(false, |image| {
+            range.start < image.linear_memory_offset + image.len
+                && image.linear_memory_offset < range.end
+        });
+        unsafe {
+            crate::memory::decommit_range(self.base as *mut u8, range, overlaps_image)?;
+        }
+        self.remapped |= overlaps_image;
+        Ok(())
+    }
+
     fn set_protection(&self, range: Range<usize>, flags: rustix::io::MprotectFlags) -> Result<()> {
         assert!(range.start <= range.end);
         assert!(range.end <= self.static_size);
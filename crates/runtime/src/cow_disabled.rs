@@ -70,4 +70,8 @@ impl MemoryImageSlot {
     pub(crate) fn set_heap_limit(&mut self, _: usize) -> Result<()> {
         match *self {}
     }
+
+    pub(crate) fn decommit(&mut self, _: std::ops::Range<usize>) -> Result<()> {
+        match *self {}
+    }
 }
@@ -108,6 +108,7 @@ use std::mem;
 use std::ops::Deref;
 use std::ptr::{self, NonNull};
 use std::sync::atomic::{self, AtomicUsize, Ordering};
+use std::time::{Duration, Instant};
 use std::{alloc::Layout, sync::Arc};
 use wasmtime_environ::StackMap;
 
@@ -523,12 +524,56 @@ pub struct VMExternRefActivationsTable {
     /// those missed roots, and use after free.
     stack_canary: Option<usize>,
 
+    /// Statistics about the GCs that have been performed on this table.
+    stats: GcStats,
+
     /// A debug-only field for asserting that we are in a region of code where
     /// GC is okay to preform.
     #[cfg(debug_assertions)]
     gc_okay: bool,
 }
 
+/// Statistics about the garbage collections performed on a
+/// `VMExternRefActivationsTable`.
+#[derive(Debug, Default, Clone, Copy)]
+pub struct GcStats {
+    collections: u64,
+    total_pause: Duration,
+    max_pause: Duration,
+    live_roots: usize,
+    chunk_capacity: usize,
+}
+
+impl GcStats {
+    /// Returns the number of garbage collections performed so far.
+    pub fn collections(&self) -> u64 {
+        self.collections
+    }
+
+    /// Returns the total amount of time spent in garbage collection.
+    pub fn total_pause(&self) -> Duration {
+        self.total_pause
+    }
+
+    /// Returns the longest single garbage collection pause.
+    pub fn max_pause(&self) -> Duration {
+        self.max_pause
+    }
+
+    /// Returns the number of on-stack roots that survived the most recent
+    /// garbage collection.
+    pub fn live_roots(&self) -> usize {
+        self.live_roots
+    }
+
+    /// Returns the number of references that can be inserted into the table
+    /// before the next garbage collection is triggered, as sized by the most
+    /// recent garbage collection.
+    pub fn chunk_capacity(&self) -> usize {
+        self.chunk_capacity
+    }
+}
+
 #[repr(C)] // This is accessed from JIT code.
 struct VMExternRefTableAlloc {
     /// Bump-allocation finger within the `chunk`.
@@ -564,6 +609,10 @@ fn _assert_send_sync() {
 impl VMExternRefActivationsTable {
     const CHUNK_SIZE: usize = 4096 / mem::size_of::<usize>();
 
+    /// The largest size that the bump chunk will grow to, 1MiB on 64-bit
+    /// platforms.
+    const MAX_CHUNK_SIZE: usize = Self::CHUNK_SIZE * 256;
+
     /// Create a new `VMExternRefActivationsTable`.
     pub fn new() -> Self {
         // Start with an empty chunk in case this activations table isn't used.
@@ -584,6 +633,7 @@ impl VMExternRefActivationsTable {
             over_approximated_stack_roots: HashSet::new(),
             precise_stack_roots: HashSet::new(),
             stack_canary: None,
+            stats: GcStats::default(),
             #[cfg(debug_assertions)]
             gc_okay: true,
         }
@@ -594,12 +644,19 @@ impl VMExternRefActivationsTable {
         (0..size).map(|_| UnsafeCell::new(None)).collect()
     }
 
-    /// Get the available capacity in the bump allocation chunk.
+    /// Returns statistics about the garbage collections performed on this
+    /// table so far.
+    pub fn gc_stats(&self) -> GcStats {
+        self.stats
+    }
+
+    /// Get the available capacity, in number of references, in the bump
+    /// allocation chunk.
     #[inline]
     pub fn bump_capacity_remaining(&self) -> usize {
         let end = self.alloc.end.as_ptr() as usize;
         let next = unsafe { *self.alloc.next.get() };
-        end - next.as_ptr() as usize
+        (end - next.as_ptr() as usize) / mem::size_of::<TableElem>()
     }
 
     /// Try and insert a `VMExternRef` into this table.
@@ -734,10 +791,26 @@ impl VMExternRefActivationsTable {
             "after sweeping the bump chunk, all slots should be `None`"
         );
 
-        // If this is the first instance of gc then the initial chunk is empty,
-        // so we lazily allocate space for fast bump-allocation in the future.
-        if self.alloc.chunk.is_empty() {
-            self.alloc.chunk = Self::new_chunk(Self::CHUNK_SIZE);
+        // Pick the size of the bump chunk for the next GC cycle. If this is
+        // the first instance of gc then the initial chunk is empty, so we
+        // lazily allocate space for fast bump-allocation in the future. After
+        // that the chunk doubles in size whenever it filled up entirely, up to
+        // `MAX_CHUNK_SIZE`, so that workloads passing many references into
+        // Wasm trigger GCs less frequently. The chunk is shrunk again once it
+        // is mostly unused so that quiet stores don't hold on to large
+        // chunks.
+        let capacity = self.alloc.chunk.len();
+        let new_capacity = if capacity == 0 {
+            Self::CHUNK_SIZE
+        } else if num_filled == capacity {
+            cmp::min(capacity * 2, Self::MAX_CHUNK_SIZE)
+        } else if num_filled < capacity / 8 {
+            cmp::max(capacity / 2, Self::CHUNK_SIZE)
+        } else {
+            capacity
+        };
+        if new_capacity != capacity {
+            self.alloc.chunk = Self::new_chunk(new_capacity);
             self.alloc.end =
                 NonNull::new(unsafe { self.alloc.chunk.as_mut_ptr().add(self.alloc.chunk.len()) })
                     .unwrap();
@@ -757,6 +830,9 @@ impl VMExternRefActivationsTable {
             &mut self.over_approximated_stack_roots,
         );
 
+        self.stats.live_roots = self.over_approximated_stack_roots.len();
+        self.stats.chunk_capacity = self.alloc.chunk.len();
+
         // And finally, the new `precise_stack_roots` should be cleared and
         // remain empty until the next GC cycle.
         //
@@ -867,10 +943,24 @@ impl<T> std::ops::DerefMut for DebugOnly<T> {
 ///
 /// Additionally, you must have registered the stack maps for every Wasm module
 /// that has frames on the stack with the given `stack_maps_registry`.
-#[cfg_attr(not(feature = "wasm-backtrace"), allow(unused_mut, unused_variables))]
 pub unsafe fn gc(
     module_info_lookup: &dyn ModuleInfoLookup,
     externref_activations_table: &mut VMExternRefActivationsTable,
+) {
+    let start = Instant::now();
+    gc_impl(module_info_lookup, externref_activations_table);
+    let pause = start.elapsed();
+
+    let stats = &mut externref_activations_table.stats;
+    stats.collections += 1;
+    stats.total_pause += pause;
+    stats.max_pause = cmp::max(stats.max_pause, pause);
+}
+
+#[cfg_attr(not(feature = "wasm-backtrace"), allow(unused_mut, unused_variables))]
+unsafe fn gc_impl(
+    module_info_lookup: &dyn ModuleInfoLookup,
+    externref_activations_table: &mut VMExternRefActivationsTable,
 ) {
     log::debug!("start GC");
 
@@ -1057,6 +1147,36 @@ mod tests {
         );
     }
 
+    #[test]
+    fn chunk_grows_and_shrinks() {
+        struct NoModules;
+        impl ModuleInfoLookup for NoModules {
+            fn lookup(&self, _pc: usize) -> Option<Arc<dyn ModuleInfo>> {
+                None
+            }
+        }
+
+        let mut table = VMExternRefActivationsTable::new();
+        unsafe { gc(&NoModules, &mut table) };
+        let initial = table.gc_stats().chunk_capacity();
+        assert_eq!(initial, VMExternRefActivationsTable::CHUNK_SIZE);
+
+        // Filling up the whole chunk doubles it at the next GC.
+        for _ in 0..initial {
+            assert!(table.try_insert(VMExternRef::new(1_u32)).is_ok());
+        }
+        unsafe { gc(&NoModules, &mut table) };
+        assert_eq!(table.gc_stats().chunk_capacity(), initial * 2);
+        assert_eq!(table.gc_stats().live_roots(), 0);
+
+        // An unused chunk shrinks back down, but not below the initial size.
+        unsafe { gc(&NoModules, &mut table) };
+        assert_eq!(table.gc_stats().chunk_capacity(), initial);
+        unsafe { gc(&NoModules, &mut table) };
+        assert_eq!(table.gc_stats().chunk_capacity(), initial);
+        assert_eq!(table.gc_stats().collections(), 4);
+    }
+
     #[test]
     fn table_next_is_at_correct_offset() {
         let table = VMExternRefActivationsTable::new();
@@ -1107,6 +1107,16 @@ impl InstanceHandle {
         self.instance().memory_index(memory)
     }
 
+    /// Returns an iterator over the memories defined within this instance.
+    pub fn defined_memories(&self) -> impl ExactSizeIterator<Item = &Memory> + '_ {
+        self.instance().memories.values()
+    }
+
+    /// Returns an iterator over the tables defined within this instance.
+    pub fn defined_tables(&self) -> impl ExactSizeIterator<Item = &Table> + '_ {
+        self.instance().tables.values()
+    }
+
     /// Get a memory defined locally within this module.
     pub fn get_defined_memory(&mut self, index: DefinedMemoryIndex) -> *mut Memory {
         self.instance_mut().get_defined_memory(index)
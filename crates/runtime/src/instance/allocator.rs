@@ -22,6 +22,9 @@ use wasmtime_environ::{
 #[cfg(feature = "pooling-allocator")]
 mod pooling;
 
+#[cfg(all(feature = "async", unix))]
+mod stack_cache;
+
 #[cfg(feature = "pooling-allocator")]
 pub use self::pooling::{InstanceLimits, PoolingAllocationStrategy, PoolingInstanceAllocator};
 
@@ -126,6 +129,43 @@ pub enum FiberStackError {
     Limit(u32),
 }
 
+/// Statistics about the fiber stacks of an instance allocator.
+///
+/// Only allocators which keep fiber stacks around for reuse report these;
+/// other allocators report all zeroes.
+#[cfg(feature = "async")]
+#[derive(Debug, Default, Clone, Copy)]
+pub struct FiberStackStats {
+    live: usize,
+    cached: usize,
+    created: u64,
+    reused: u64,
+}
+
+#[cfg(feature = "async")]
+impl FiberStackStats {
+    /// Returns the number of fiber stacks currently in use.
+    pub fn live(&self) -> usize {
+        self.live
+    }
+
+    /// Returns the number of idle fiber stacks kept around for reuse.
+    pub fn cached(&self) -> usize {
+        self.cached
+    }
+
+    /// Returns the number of fiber stacks which were created from scratch.
+    pub fn created(&self) -> u64 {
+        self.created
+    }
+
+    /// Returns the number of fiber stack allocations which reused an idle
+    /// stack.
+    pub fn reused(&self) -> u64 {
+        self.reused
+    }
+}
+
 /// Represents a runtime instance allocator.
 ///
 /// # Safety
@@ -189,6 +229,12 @@ pub unsafe trait InstanceAllocator: Send + Sync {
     /// The provided stack is required to have been allocated with `allocate_fiber_stack`.
     #[cfg(feature = "async")]
     unsafe fn deallocate_fiber_stack(&self, stack: &wasmtime_fiber::FiberStack);
+
+    /// Returns statistics about the fiber stacks of this allocator.
+    #[cfg(feature = "async")]
+    fn fiber_stack_stats(&self) -> FiberStackStats {
+        FiberStackStats::default()
+    }
 }
 
 fn get_table_init_start(
@@ -430,6 +476,8 @@ pub struct OnDemandInstanceAllocator {
     mem_creator: Option<Arc<dyn RuntimeMemoryCreator>>,
     #[cfg(feature = "async")]
     stack_size: usize,
+    #[cfg(all(feature = "async", unix))]
+    stack_cache: Option<Arc<stack_cache::StackCache>>,
 }
 
 impl OnDemandInstanceAllocator {
@@ -440,7 +488,32 @@ impl OnDemandInstanceAllocator {
             mem_creator,
             #[cfg(feature = "async")]
             stack_size,
+            #[cfg(all(feature = "async", unix))]
+            stack_cache: None,
+        }
+    }
+
+    /// Keeps up to `max_cached` deallocated fiber stacks around for reuse
+    /// instead of unmapping them.
+    ///
+    /// The pages of a cached stack are discarded, so idle stacks only consume
+    /// address space. This has no effect on Windows, where fiber stacks are
+    /// managed by the operating system.
+    #[cfg(feature = "async")]
+    #[cfg_attr(not(unix), allow(unused_mut, unused_variables))]
+    pub fn with_fiber_stack_cache(mut self, max_cached: usize) -> Self {
+        #[cfg(unix)]
+        {
+            self.stack_cache = if max_cached > 0 && self.stack_size > 0 {
+                Some(Arc::new(stack_cache::StackCache::new(
+                    self.stack_size,
+                    max_cached,
+                )))
+            } else {
+                None
+            };
         }
+        self
     }
 
     fn create_tables(
@@ -509,6 +582,8 @@ impl Default for OnDemandInstanceAllocator {
             mem_creator: None,
             #[cfg(feature = "async")]
             stack_size: 0,
+            #[cfg(all(feature = "async", unix))]
+            stack_cache: None,
         }
     }
 }
@@ -553,12 +628,33 @@ unsafe impl InstanceAllocator for OnDemandInstanceAllocator {
             return Err(FiberStackError::NotSupported);
         }
 
+        #[cfg(unix)]
+        if let Some(cache) = &self.stack_cache {
+            return cache.allocate();
+        }
+
         wasmtime_fiber::FiberStack::new(self.stack_size)
             .map_err(|e| FiberStackError::Resource(e.into()))
     }
 
     #[cfg(feature = "async")]
-    unsafe fn deallocate_fiber_stack(&self, _stack: &wasmtime_fiber::FiberStack) {
-        // The on-demand allocator has no further bookkeeping for fiber stacks
+    unsafe fn deallocate_fiber_stack(&self, stack: &wasmtime_fiber::FiberStack) {
+        #[cfg(unix)]
+        if let Some(cache) = &self.stack_cache {
+            return cache.deallocate(stack);
+        }
+
+        // Otherwise the on-demand allocator has no further bookkeeping for
+        // fiber stacks
+        let _ = stack;
+    }
+
+    #[cfg(feature = "async")]
+    fn fiber_stack_stats(&self) -> FiberStackStats {
+        #[cfg(unix)]
+        if let Some(cache) = &self.stack_cache {
+            return cache.stats();
+        }
+        FiberStackStats::default()
     }
 }
@@ -0,0 +1,176 @@
+//! A bounded cache of fiber stacks for the on-demand instance allocator.
+//!
+//! Creating a fiber stack from scratch maps a fresh region of memory and sets
+//! up its guard page, and destroying it unmaps the region again, which
+//! involves TLB shootdowns on multi-threaded hosts. When many short-lived
+//! async calls are made this dominates the cost of the call itself, so
+//! instead of unmapping stacks on deallocation up to a configured number of
+//! them are kept around for reuse. A cached stack's pages are discarded when
+//! it's returned, so it doesn't keep any memory committed and a reused stack
+//! starts out zeroed just like a fresh one.
+
+use super::{FiberStackError, FiberStackStats};
+use crate::Mmap;
+use anyhow::{Context, Result};
+use std::collections::HashMap;
+use std::sync::Mutex;
+
+#[derive(Debug)]
+pub(super) struct StackCache {
+    stack_size: usize,
+    max_cached: usize,
+    page_size: usize,
+    state: Mutex<StackCacheState>,
+}
+
+#[derive(Debug, Default)]
+struct StackCacheState {
+    /// Stacks which can be handed out again.
+    idle: Vec<Mmap>,
+    /// Stacks which are currently in use, keyed by the address of their top.
+    live: HashMap<usize, Mmap>,
+    created: u64,
+    reused: u64,
+}
+
+impl StackCache {
+    pub(super) fn new(stack_size: usize, max_cached: usize) -> Self {
+        let page_size = region::page::size();
+        Self {
+            stack_size: round_up_to_page_size(stack_size.max(1), page_size),
+            max_cached,
+            page_size,
+            state: Mutex::new(StackCacheState::default()),
+        }
+    }
+
+    pub(super) fn allocate(&self) -> Result<wasmtime_fiber::FiberStack, FiberStackError> {
+        let mut state = self.state.lock().unwrap();
+        let mapping = match state.idle.pop() {
+            Some(mapping) => {
+                state.reused += 1;
+                mapping
+            }
+            None => {
+                let mapping = self.create().map_err(FiberStackError::Resource)?;
+                state.created += 1;
+                mapping
+            }
+        };
+
+        unsafe {
+            let top = mapping.as_mut_ptr().add(mapping.len());
+            let stack = wasmtime_fiber::FiberStack::from_top_ptr(top)
+                .map_err(|e| FiberStackError::Resource(e.into()))?;
+            state.live.insert(top as usize, mapping);
+            Ok(stack)
+        }
+    }
+
+    pub(super) fn deallocate(&self, stack: &wasmtime_fiber::FiberStack) {
+        let top = stack
+            .top()
+            .expect("fiber stack not allocated from the cache") as usize;
+
+        let mut state = self.state.lock().unwrap();
+        let mapping = state
+            .live
+            .remove(&top)
+            .expect("fiber stack not allocated from the cache");
+        if state.idle.len() >= self.max_cached {
+            return;
+        }
+
+        // Discard the pages used by the stack, and if that fails simply let
+        // it be unmapped instead of caching it.
+        let stack_start = unsafe { mapping.as_mut_ptr().add(self.page_size) };
+        if reset_stack_pages(stack_start, self.stack_size).is_ok() {
+            state.idle.push(mapping);
+        }
+    }
+
+    pub(super) fn stats(&self) -> FiberStackStats {
+        let state = self.state.lock().unwrap();
+        FiberStackStats {
+            live: state.live.len(),
+            cached: state.idle.len(),
+            created: state.created,
+            reused: state.reused,
+        }
+    }
+
+    /// Maps a new stack with its guard page at the bottom.
+    fn create(&self) -> Result<Mmap> {
+        let len = self
+            .stack_size
+            .checked_add(self.page_size)
+            .context("fiber stack size exceeds addressable memory")?;
+        let mut mapping =
+            Mmap::accessible_reserved(0, len).context("failed to allocate a fiber stack")?;
+        mapping.make_accessible(self.page_size, self.stack_size)?;
+        Ok(mapping)
+    }
+}
+
+fn round_up_to_page_size(size: usize, page_size: usize) -> usize {
+    (size + (page_size - 1)) & !(page_size - 1)
+}
+
+#[cfg(target_os = "linux")]
+fn reset_stack_pages(addr: *mut u8, len: usize) -> Result<()> {
+    // On Linux, discarding anonymous private pages makes them read as zero the
+    // next time they're accessed.
+    unsafe {
+        rustix::io::madvise(addr as _, len, rustix::io::Advice::LinuxDontNeed)
+            .context("madvise failed to discard fiber stack pages")?;
+    }
+    Ok(())
+}
+
+#[cfg(not(target_os = "linux"))]
+fn reset_stack_pages(addr: *mut u8, len: usize) -> Result<()> {
+    // Elsewhere `MADV_DONTNEED` may leave the pages' contents intact, so
+    // replace them with a new zeroed mapping instead.
+    unsafe {
+        rustix::io::mmap_anonymous(
+            addr as _,
+            len,
+            rustix::io::ProtFlags::READ | rustix::io::ProtFlags::WRITE,
+            rustix::io::MapFlags::PRIVATE | rustix::io::MapFlags::FIXED,
+        )
+        .context("mmap failed to remap fiber stack pages")?;
+    }
+    Ok(())
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn reuses_and_zeroes_stacks() -> Result<()> {
+        let cache = StackCache::new(64 << 10, 1);
+
+        let first = cache.allocate()?;
+        let second = cache.allocate()?;
+        let top = first.top().unwrap();
+        unsafe {
+            *top.sub(1) = 1;
+        }
+        assert_eq!(cache.stats().live, 2);
+
+        // Only one stack fits in the cache, the other is unmapped.
+        cache.deallocate(&first);
+        cache.deallocate(&second);
+        let stats = cache.stats();
+        assert_eq!((stats.live, stats.cached), (0, 1));
+        assert_eq!((stats.created, stats.reused), (2, 0));
+
+        let third = cache.allocate()?;
+        assert_eq!(third.top(), Some(top));
+        assert_eq!(unsafe { *top.sub(1) }, 0);
+        assert_eq!(cache.stats().reused, 1);
+        cache.deallocate(&third);
+        Ok(())
+    }
+}
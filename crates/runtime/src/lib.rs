@@ -44,11 +44,13 @@ mod vmcontext;
 pub mod debug_builtins;
 pub mod libcalls;
 
-pub use wasmtime_jit_debug::gdb_jit_int::GdbJitImageRegistration;
+pub use wasmtime_jit_debug::gdb_jit_int::{debugger_attached, GdbJitImageRegistration};
 
 pub use crate::export::*;
 pub use crate::externref::*;
 pub use crate::imports::Imports;
+#[cfg(feature = "async")]
+pub use crate::instance::FiberStackStats;
 pub use crate::instance::{
     InstanceAllocationRequest, InstanceAllocator, InstanceHandle, InstantiationError, LinkError,
     OnDemandInstanceAllocator, StorePtr,
@@ -11,6 +11,7 @@ use anyhow::Error;
 use anyhow::{bail, format_err, Result};
 use more_asserts::{assert_ge, assert_le};
 use std::convert::TryFrom;
+use std::ops::Range;
 use std::sync::Arc;
 use wasmtime_environ::{MemoryPlan, MemoryStyle, WASM32_MAX_PAGES, WASM64_MAX_PAGES};
 
@@ -60,6 +61,10 @@ pub trait RuntimeLinearMemory: Send + Sync {
     /// Returns `None` if the memory is unbounded.
     fn maximum_byte_size(&self) -> Option<usize>;
 
+    /// Returns the number of bytes of address space reserved for this memory,
+    /// including any guard regions.
+    fn reserved_byte_size(&self) -> usize;
+
     /// Grow memory to the specified amount of bytes.
     ///
     /// Returns an error if memory can't be grown by the specified amount
@@ -74,6 +79,82 @@ pub trait RuntimeLinearMemory: Send + Sync {
     /// has initial contents courtesy of the `MemoryImage` passed to
     /// `RuntimeMemoryCreator::new_memory()`.
     fn needs_init(&self) -> bool;
+
+    /// Zeroes the bytes in `range`, which is within the current size of this
+    /// memory, releasing the physical pages backing them where possible.
+    ///
+    /// The default implementation only zeroes the bytes in place.
+    fn decommit(&mut self, range: Range<usize>) -> Result<()> {
+        let vm = self.vmmemory();
+        unsafe {
+            std::ptr::write_bytes(vm.base.add(range.start), 0, range.len());
+        }
+        Ok(())
+    }
+}
+
+/// Zeroes the bytes in `range` of the memory at `base`, returning the pages
+/// wholly within the range to the operating system. Bytes of pages which are
+/// only partially covered are zeroed in place.
+///
+/// If `remap` is set the pages are replaced with fresh anonymous memory rather
+/// than discarded, which is required when they may be part of a CoW mapping
+/// of a file since discarding those would restore the file's contents.
+///
+/// # Safety
+///
+/// The range must be accessible and read/write, and not in use by anything
+/// else.
+pub(crate) unsafe fn decommit_range(base: *mut u8, range: Range<usize>, remap: bool) -> Result<()> {
+    let page_size = region::page::size();
+    let start = base as usize + range.start;
+    let end = base as usize + range.end;
+    let page_start = (start + (page_size - 1)) & !(page_size - 1);
+    let page_end = end & !(page_size - 1);
+    if page_start >= page_end {
+        std::ptr::write_bytes(start as *mut u8, 0, end - start);
+        return Ok(());
+    }
+    std::ptr::write_bytes(start as *mut u8, 0, page_start - start);
+    std::ptr::write_bytes(page_end as *mut u8, 0, end - page_end);
+    decommit_pages(page_start as *mut u8, page_end - page_start, remap)
+}
+
+#[cfg(target_os = "linux")]
+unsafe fn decommit_pages(addr: *mut u8, len: usize, remap: bool) -> Result<()> {
+    if remap {
+        remap_pages(addr, len)
+    } else {
+        // Discarded anonymous private pages read as zero the next time
+        // they're accessed.
+        rustix::io::madvise(addr.cast(), len, rustix::io::Advice::LinuxDontNeed)?;
+        Ok(())
+    }
+}
+
+#[cfg(all(unix, not(target_os = "linux")))]
+unsafe fn decommit_pages(addr: *mut u8, len: usize, _remap: bool) -> Result<()> {
+    // Elsewhere `MADV_DONTNEED` may leave the pages' contents intact, so
+    // always replace them with a new zeroed mapping.
+    remap_pages(addr, len)
+}
+
+#[cfg(unix)]
+unsafe fn remap_pages(addr: *mut u8, len: usize) -> Result<()> {
+    let ptr = rustix::io::mmap_anonymous(
+        addr.cast(),
+        len,
+        rustix::io::ProtFlags::READ | rustix::io::ProtFlags::WRITE,
+        rustix::io::MapFlags::PRIVATE | rustix::io::MapFlags::FIXED,
+    )?;
+    assert_eq!(ptr, addr.cast());
+    Ok(())
+}
+
+#[cfg(windows)]
+unsafe fn decommit_pages(addr: *mut u8, len: usize, _remap: bool) -> Result<()> {
+    std::ptr::write_bytes(addr, 0, len);
+    Ok(())
 }
 
 /// A linear memory instance.
@@ -192,6 +273,10 @@ impl RuntimeLinearMemory for MmapMemory {
         self.maximum
     }
 
+    fn reserved_byte_size(&self) -> usize {
+        self.mmap.len()
+    }
+
     fn grow_to(&mut self, new_size: usize) -> Result<()> {
         if new_size > self.mmap.len() - self.offset_guard_size - self.pre_guard_size {
             // If the new size of this heap exceeds the current size of the
@@ -254,6 +339,19 @@ impl RuntimeLinearMemory for MmapMemory {
         // is needed.
         self.memory_image.is_none()
     }
+
+    fn decommit(&mut self, range: Range<usize>) -> Result<()> {
+        match self.memory_image.as_mut() {
+            Some(image) => image.decommit(range),
+            None => unsafe {
+                decommit_range(
+                    self.mmap.as_mut_ptr().add(self.pre_guard_size),
+                    range,
+                    false,
+                )
+            },
+        }
+    }
 }
 
 /// Representation of a runtime wasm linear memory.
@@ -449,6 +547,17 @@ impl Memory {
         }
     }
 
+    /// Returns the number of bytes of address space reserved for this memory.
+    ///
+    /// For static memories this is the size of the slot the memory was
+    /// allocated in, excluding the slot's guard region.
+    pub fn reserved_byte_size(&self) -> usize {
+        match self {
+            Memory::Static { base, .. } => base.len(),
+            Memory::Dynamic(mem) => mem.reserved_byte_size(),
+        }
+    }
+
     /// Returns whether or not the underlying storage of the memory is "static".
     #[cfg(feature = "pooling-allocator")]
     pub(crate) fn is_static(&self) -> bool {
@@ -596,6 +705,34 @@ impl Memory {
         Ok(Some(old_byte_size))
     }
 
+    /// Zeroes the bytes in `range` of this memory, releasing the physical
+    /// pages backing them back to the operating system where possible.
+    ///
+    /// The size of the memory is unchanged, and pages are committed again on
+    /// demand when they're next accessed.
+    pub fn decommit(&mut self, range: Range<usize>) -> Result<()> {
+        assert!(range.start <= range.end);
+        assert_le!(range.end, self.byte_size());
+        match self {
+            Memory::Static {
+                memory_image: Some(image),
+                ..
+            } => image.decommit(range),
+            Memory::Static { base, .. } => {
+                // Pages of memories initialized lazily by the uffd handler
+                // would be initialized again when next accessed, so they're
+                // only zeroed.
+                if cfg!(all(feature = "uffd", target_os = "linux")) {
+                    base[range].fill(0);
+                    Ok(())
+                } else {
+                    unsafe { decommit_range(base.as_mut_ptr(), range, false) }
+                }
+            }
+            Memory::Dynamic(mem) => mem.decommit(range),
+        }
+    }
+
     /// Return a `VMMemoryDefinition` for exposing the memory to compiled wasm code.
     pub fn vmmemory(&mut self) -> VMMemoryDefinition {
         match self {
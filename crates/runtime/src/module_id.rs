@@ -5,22 +5,26 @@ use std::{
     sync::atomic::{AtomicU64, Ordering},
 };
 
-/// A unique identifier (within an engine or similar) for a compiled
-/// module.
+/// A unique identifier for a compiled module.
+///
+/// Identifiers are unique within the whole process rather than just within
+/// the allocator that created them, since compiled modules may be shared
+/// between engines.
 #[derive(Clone, Copy, Debug, PartialEq, Eq, PartialOrd, Ord, Hash)]
 pub struct CompiledModuleId(NonZeroU64);
 
 /// An allocator for compiled module IDs.
 pub struct CompiledModuleIdAllocator {
-    next: AtomicU64,
+    _private: (),
 }
 
+/// The next ID to hand out, shared by all allocators.
+static NEXT_ID: AtomicU64 = AtomicU64::new(1);
+
 impl CompiledModuleIdAllocator {
     /// Create a compiled-module ID allocator.
     pub fn new() -> Self {
-        Self {
-            next: AtomicU64::new(1),
-        }
+        Self { _private: () }
     }
 
     /// Allocate a new ID.
@@ -34,10 +38,10 @@ impl CompiledModuleIdAllocator {
         // synchronization (ordering) with respect to any other memory
         // access in the program. However, `fetch_add` is always
         // atomic with respect to other accesses to this variable
-        // (`self.next`). So we will always hand out separate, unique
+        // (`NEXT_ID`). So we will always hand out separate, unique
         // IDs correctly, just in some possibly arbitrary order (which
         // is fine).
-        let id = self.next.fetch_add(1, Ordering::Relaxed);
+        let id = NEXT_ID.fetch_add(1, Ordering::Relaxed);
         CompiledModuleId(NonZeroU64::new(id).unwrap())
     }
 }
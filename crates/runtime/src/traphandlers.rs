@@ -140,20 +140,22 @@ pub enum Trap {
 impl Trap {
     /// Construct a new Wasm trap with the given source location and trap code.
     ///
-    /// Internally saves a backtrace when constructed.
+    /// Internally saves a backtrace when constructed, unless backtrace capture
+    /// was disabled for the current call into wasm.
     pub fn wasm(trap_code: TrapCode) -> Self {
         Trap::Wasm {
             trap_code,
-            backtrace: Backtrace::new(),
+            backtrace: Backtrace::new_for_trap(),
         }
     }
 
     /// Construct a new OOM trap with the given source location and trap code.
     ///
-    /// Internally saves a backtrace when constructed.
+    /// Internally saves a backtrace when constructed, unless backtrace capture
+    /// was disabled for the current call into wasm.
     pub fn oom() -> Self {
         Trap::OOM {
-            backtrace: Backtrace::new(),
+            backtrace: Backtrace::new_for_trap(),
         }
     }
 }
@@ -178,6 +180,27 @@ impl Backtrace {
         }
     }
 
+    /// Returns a backtrace with no frames, used when capturing backtraces is
+    /// disabled.
+    pub fn empty() -> Backtrace {
+        Backtrace {
+            #[cfg(feature = "wasm-backtrace")]
+            trace: Vec::new().into(),
+        }
+    }
+
+    /// Captures a new backtrace for a trap raised in wasm, or returns an
+    /// empty backtrace if the current `catch_traps` call was configured to
+    /// not capture backtraces.
+    fn new_for_trap() -> Backtrace {
+        let capture = tls::with(|state| state.map_or(true, |s| s.capture_backtraces));
+        if capture {
+            Backtrace::new()
+        } else {
+            Backtrace::empty()
+        }
+    }
+
     /// Returns the backtrace frames associated with this backtrace. Note that
     /// this is conditionally defined and not present when `wasm-backtrace` is
     /// not present.
@@ -190,16 +213,21 @@ impl Backtrace {
 /// Catches any wasm traps that happen within the execution of `closure`,
 /// returning them as a `Result`.
 ///
+/// If `capture_backtrace` is `false` then traps are returned with an empty
+/// `Backtrace`, which avoids the cost of walking the stack when a trap
+/// happens.
+///
 /// Highly unsafe since `closure` won't have any dtors run.
 pub unsafe fn catch_traps<'a, F>(
     signal_handler: Option<*const SignalHandler<'static>>,
+    capture_backtrace: bool,
     callee: *mut VMContext,
     mut closure: F,
 ) -> Result<(), Box<Trap>>
 where
     F: FnMut(*mut VMContext),
 {
-    return CallThreadState::new(signal_handler).with(|cx| {
+    return CallThreadState::new(signal_handler, capture_backtrace).with(|cx| {
         wasmtime_setjmp(
             cx.jmp_buf.as_ptr(),
             call_closure::<F>,
@@ -223,6 +251,7 @@ pub struct CallThreadState {
     jmp_buf: Cell<*const u8>,
     handling_trap: Cell<bool>,
     signal_handler: Option<*const SignalHandler<'static>>,
+    capture_backtraces: bool,
     prev: Cell<tls::Ptr>,
 }
 
@@ -235,12 +264,16 @@ enum UnwindReason {
 
 impl CallThreadState {
     #[inline]
-    fn new(signal_handler: Option<*const SignalHandler<'static>>) -> CallThreadState {
+    fn new(
+        signal_handler: Option<*const SignalHandler<'static>>,
+        capture_backtrace: bool,
+    ) -> CallThreadState {
         CallThreadState {
             unwind: UnsafeCell::new(MaybeUninit::uninit()),
             jmp_buf: Cell::new(ptr::null()),
             handling_trap: Cell::new(false),
             signal_handler,
+            capture_backtraces: capture_backtrace,
             prev: Cell::new(ptr::null()),
         }
     }
@@ -327,7 +360,11 @@ impl CallThreadState {
     }
 
     fn capture_backtrace(&self, pc: *const u8) {
-        let backtrace = Backtrace::new();
+        let backtrace = if self.capture_backtraces {
+            Backtrace::new()
+        } else {
+            Backtrace::empty()
+        };
         unsafe {
             (*self.unwind.get())
                 .as_mut_ptr()
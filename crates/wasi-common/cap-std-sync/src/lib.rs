@@ -135,6 +135,14 @@ impl WasiCtxBuilder {
         self.0.insert_file(fd, file, caps);
         Ok(self)
     }
+    /// Use a scheduler that keeps files registered with epoll across
+    /// `poll_oneoff` calls, which scales better than the default scheduler for
+    /// guests that repeatedly wait on many files.
+    #[cfg(target_os = "linux")]
+    pub fn epoll_sched(mut self) -> Result<Self, Error> {
+        self.0.sched = Box::new(sched::EpollSched::new()?);
+        Ok(self)
+    }
     pub fn build(self) -> WasiCtx {
         self.0
     }
@@ -8,6 +8,11 @@ pub mod windows;
 #[cfg(windows)]
 pub use windows::poll_oneoff;
 
+#[cfg(target_os = "linux")]
+pub mod linux;
+#[cfg(target_os = "linux")]
+pub use linux::EpollSched;
+
 use std::thread;
 use std::time::Duration;
 use wasi_common::{
@@ -0,0 +1,356 @@
+//! A `poll_oneoff` scheduler that keeps a persistent epoll registration.
+//!
+//! The `poll(2)`-based scheduler in the `unix` module hands every subscribed
+//! file to the kernel on each `poll_oneoff` call, so each call costs time
+//! proportional to the number of subscriptions. Event-driven guests typically
+//! wait on the same set of files over and over, though, so this scheduler
+//! instead keeps each file registered with an epoll instance across calls and
+//! only issues `epoll_ctl` syscalls for files whose interest changed since the
+//! previous call. Waking up then costs time proportional to the number of
+//! ready files.
+
+use cap_std::time::Duration;
+use rustix::fd::AsRawFd;
+use std::collections::HashMap;
+use std::convert::TryInto;
+use std::io;
+use std::os::unix::io::RawFd;
+use std::sync::Mutex;
+use std::thread;
+use wasi_common::sched::subscription::{RwEventFlags, Subscription};
+use wasi_common::{
+    sched::{Poll, WasiSched},
+    Error, ErrorExt, WasiFile,
+};
+
+pub struct EpollSched {
+    epoll: RawFd,
+    state: Mutex<EpollState>,
+}
+
+#[derive(Default)]
+struct EpollState {
+    /// The interest each file is currently registered with, keyed by its raw
+    /// file descriptor.
+    registered: HashMap<RawFd, u32>,
+    /// Buffer for `epoll_wait` results, reused across calls.
+    events: Vec<libc::epoll_event>,
+}
+
+impl EpollSched {
+    pub fn new() -> Result<Self, Error> {
+        let epoll = unsafe { libc::epoll_create1(libc::EPOLL_CLOEXEC) };
+        if epoll < 0 {
+            return Err(io::Error::last_os_error().into());
+        }
+        Ok(EpollSched {
+            epoll,
+            state: Mutex::new(EpollState::default()),
+        })
+    }
+
+    fn ctl(&self, op: libc::c_int, fd: RawFd, events: u32) -> io::Result<()> {
+        let mut event = libc::epoll_event {
+            events,
+            u64: fd as u64,
+        };
+        if unsafe { libc::epoll_ctl(self.epoll, op, fd, &mut event) } < 0 {
+            return Err(io::Error::last_os_error());
+        }
+        Ok(())
+    }
+
+    pub async fn poll_oneoff<'a>(&self, poll: &mut Poll<'a>) -> Result<(), Error> {
+        if poll.is_empty() {
+            return Ok(());
+        }
+        let (fds, ready) = self.update_and_wait(poll)?;
+
+        if ready.is_empty() {
+            poll.earliest_clock_deadline()
+                .expect("timed out")
+                .result()
+                .expect("timer deadline is past")
+                .unwrap();
+            return Ok(());
+        }
+
+        // Only the subscriptions of ready files need to be completed.
+        for (rwsub, fd) in poll.rw_subscriptions().zip(fds) {
+            let revents = match ready.get(&fd) {
+                Some(&revents) => revents,
+                None => continue,
+            };
+            let failed = revents & (libc::EPOLLERR | libc::EPOLLHUP) as u32 != 0;
+            let (nbytes, rwsub) = match rwsub {
+                Subscription::Read(sub) => {
+                    if revents & libc::EPOLLIN as u32 == 0 && !failed {
+                        continue;
+                    }
+                    let ready = sub.file.num_ready_bytes().await?;
+                    (std::cmp::max(ready, 1), sub)
+                }
+                Subscription::Write(sub) => {
+                    if revents & libc::EPOLLOUT as u32 == 0 && !failed {
+                        continue;
+                    }
+                    (0, sub)
+                }
+                _ => unreachable!(),
+            };
+            if revents & libc::EPOLLERR as u32 != 0 {
+                rwsub.error(Error::io());
+            } else if revents & libc::EPOLLHUP as u32 != 0 {
+                rwsub.complete(nbytes, RwEventFlags::HANGUP);
+            } else {
+                rwsub.complete(nbytes, RwEventFlags::empty());
+            }
+        }
+        Ok(())
+    }
+
+    /// Brings the epoll registration up to date with the subscriptions of
+    /// `poll` and waits for any of them to become ready.
+    ///
+    /// Returns the file descriptor of each read/write subscription, in order,
+    /// and the events of every ready file descriptor.
+    fn update_and_wait(
+        &self,
+        poll: &mut Poll<'_>,
+    ) -> Result<(Vec<RawFd>, HashMap<RawFd, u32>), Error> {
+        let mut state = self.state.lock().unwrap();
+
+        // Collect the interest of this call for every file. A file may be
+        // subscribed to more than once, for reading and for writing.
+        let mut wanted = HashMap::new();
+        let mut fds = Vec::new();
+        for s in poll.rw_subscriptions() {
+            let (file, events) = match s {
+                Subscription::Read(f) => (f.file, libc::EPOLLIN as u32),
+                Subscription::Write(f) => (f.file, libc::EPOLLOUT as u32),
+                Subscription::MonotonicClock { .. } => unreachable!(),
+            };
+            let fd = file
+                .pollable()
+                .ok_or(Error::invalid_argument().context("file is not pollable"))?
+                .as_raw_fd();
+            *wanted.entry(fd).or_insert(0) |= events;
+            fds.push(fd);
+        }
+
+        // Files which were registered in a previous call but aren't part of
+        // this one are removed, since level-triggered readiness of a file
+        // nobody waits on would otherwise wake up every call.
+        let stale = state
+            .registered
+            .keys()
+            .filter(|fd| !wanted.contains_key(fd))
+            .copied()
+            .collect::<Vec<_>>();
+        for fd in stale {
+            state.registered.remove(&fd);
+            let _ = self.ctl(libc::EPOLL_CTL_DEL, fd, 0);
+        }
+
+        // Update the registration of every file whose interest changed. Files
+        // that epoll can't wait on, such as regular files, are always ready,
+        // just like with `poll(2)`, and files that fail to register otherwise
+        // are reported through their subscriptions.
+        let mut always_ready = HashMap::new();
+        for (&fd, &events) in wanted.iter() {
+            let result = match state.registered.get(&fd) {
+                Some(&registered) if registered == events => continue,
+                Some(_) => self.ctl(libc::EPOLL_CTL_MOD, fd, events),
+                None => self.ctl(libc::EPOLL_CTL_ADD, fd, events),
+            };
+            match result {
+                Ok(()) => {
+                    state.registered.insert(fd, events);
+                }
+                Err(e) if e.raw_os_error() == Some(libc::EPERM) => {
+                    always_ready.insert(fd, events);
+                }
+                Err(e) => {
+                    state.registered.remove(&fd);
+                    always_ready.insert(fd, libc::EPOLLERR as u32);
+                    tracing::debug!(fd, error = tracing::field::debug(&e), "epoll_ctl");
+                }
+            }
+        }
+
+        let mut ready = always_ready;
+        if ready.is_empty() {
+            let EpollState {
+                registered, events, ..
+            } = &mut *state;
+            events.clear();
+            events.reserve(registered.len().max(1));
+            let n = loop {
+                let timeout = if let Some(t) = poll.earliest_clock_deadline() {
+                    let duration = t.duration_until().unwrap_or(Duration::from_secs(0));
+                    (duration.as_millis() + 1)
+                        .try_into()
+                        .map_err(|_| Error::overflow().context("poll timeout"))?
+                } else {
+                    -1
+                };
+                tracing::debug!(
+                    poll_timeout = tracing::field::debug(timeout),
+                    registered = registered.len(),
+                    "epoll_wait"
+                );
+                let n = unsafe {
+                    libc::epoll_wait(
+                        self.epoll,
+                        events.as_mut_ptr(),
+                        events.capacity().try_into().unwrap_or(libc::c_int::MAX),
+                        timeout,
+                    )
+                };
+                if n >= 0 {
+                    break n as usize;
+                }
+                let err = io::Error::last_os_error();
+                if err.raw_os_error() != Some(libc::EINTR) {
+                    return Err(err.into());
+                }
+            };
+            unsafe {
+                events.set_len(n);
+            }
+            for event in events.iter() {
+                let (fd, events) = (event.u64 as RawFd, event.events);
+                *ready.entry(fd).or_insert(0) |= events;
+            }
+        }
+        Ok((fds, ready))
+    }
+}
+
+impl Drop for EpollSched {
+    fn drop(&mut self) {
+        unsafe {
+            libc::close(self.epoll);
+        }
+    }
+}
+
+#[async_trait::async_trait]
+impl WasiSched for EpollSched {
+    async fn poll_oneoff<'a>(&self, poll: &mut Poll<'a>) -> Result<(), Error> {
+        EpollSched::poll_oneoff(self, poll).await
+    }
+    async fn sched_yield(&self) -> Result<(), Error> {
+        thread::yield_now();
+        Ok(())
+    }
+    async fn sleep(&self, duration: Duration) -> Result<(), Error> {
+        std::thread::sleep(duration);
+        Ok(())
+    }
+    fn file_closing(&self, file: &dyn WasiFile) {
+        let fd = match file.pollable() {
+            Some(fd) => fd.as_raw_fd(),
+            None => return,
+        };
+        let mut state = self.state.lock().unwrap();
+        if state.registered.remove(&fd).is_some() {
+            let _ = self.ctl(libc::EPOLL_CTL_DEL, fd, 0);
+        }
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::EpollSched;
+    use crate::net::UnixStream;
+    use std::io::Write;
+    use std::os::unix::io::AsRawFd;
+    use wasi_common::sched::{Poll, SubscriptionResult, Userdata, WasiSched};
+
+    #[test]
+    fn persistent_registration() {
+        let sched = EpollSched::new().unwrap();
+        let (a, b) = std::os::unix::net::UnixStream::pair().unwrap();
+        let mut a_std = a.try_clone().unwrap();
+        let b_fd = b.as_raw_fd();
+        let a = UnixStream::from_cap_std(cap_std::os::unix::net::UnixStream::from_std(a));
+        let b = UnixStream::from_cap_std(cap_std::os::unix::net::UnixStream::from_std(b));
+
+        // `b` is immediately writable but `a` has nothing to read yet.
+        let mut poll = Poll::new();
+        poll.subscribe_read(&a, Userdata::from(1));
+        poll.subscribe_write(&b, Userdata::from(2));
+        run(sched.poll_oneoff(&mut poll)).unwrap();
+        let results = poll.results();
+        assert_eq!(results.len(), 1);
+        assert!(matches!(results[0], (SubscriptionResult::Write(Ok(_)), ud) if ud == 2.into()));
+
+        // Writing to `a` makes `b` readable. `a` isn't subscribed to this time
+        // so it's deregistered as stale, and `b` switches from writing to
+        // reading with `EPOLL_CTL_MOD`.
+        a_std.write_all(b"hello").unwrap();
+        let mut poll = Poll::new();
+        poll.subscribe_read(&b, Userdata::from(3));
+        run(sched.poll_oneoff(&mut poll)).unwrap();
+        let results = poll.results();
+        assert_eq!(results.len(), 1);
+        assert!(matches!(results[0], (SubscriptionResult::Read(Ok((5, _))), ud) if ud == 3.into()));
+        assert_eq!(
+            sched.state.lock().unwrap().registered,
+            [(b_fd, libc::EPOLLIN as u32)].into_iter().collect()
+        );
+
+        // Subscribing with the same interest again reuses the registration
+        // as-is, and the unread data is still reported.
+        let mut poll = Poll::new();
+        poll.subscribe_read(&b, Userdata::from(4));
+        run(sched.poll_oneoff(&mut poll)).unwrap();
+        let results = poll.results();
+        assert_eq!(results.len(), 1);
+        assert!(matches!(results[0], (SubscriptionResult::Read(Ok((5, _))), ud) if ud == 4.into()));
+        assert_eq!(
+            sched.state.lock().unwrap().registered,
+            [(b_fd, libc::EPOLLIN as u32)].into_iter().collect()
+        );
+
+        sched.file_closing(&a);
+        sched.file_closing(&b);
+        assert!(sched.state.lock().unwrap().registered.is_empty());
+    }
+
+    fn run<F: std::future::Future>(future: F) -> F::Output {
+        use std::pin::Pin;
+        use std::task::{Context, Poll, RawWaker, RawWakerVTable, Waker};
+
+        let mut f = Pin::from(Box::new(future));
+        let waker = dummy_waker();
+        let mut cx = Context::from_waker(&waker);
+        match f.as_mut().poll(&mut cx) {
+            Poll::Ready(val) => return val,
+            Poll::Pending => panic!("epoll scheduler futures are always ready"),
+        }
+
+        fn dummy_waker() -> Waker {
+            return unsafe { Waker::from_raw(clone(5 as *const _)) };
+
+            unsafe fn clone(ptr: *const ()) -> RawWaker {
+                assert_eq!(ptr as usize, 5);
+                const VTABLE: RawWakerVTable = RawWakerVTable::new(clone, wake, wake_by_ref, drop);
+                RawWaker::new(ptr, &VTABLE)
+            }
+
+            unsafe fn wake(ptr: *const ()) {
+                assert_eq!(ptr as usize, 5);
+            }
+
+            unsafe fn wake_by_ref(ptr: *const ()) {
+                assert_eq!(ptr as usize, 5);
+            }
+
+            unsafe fn drop(ptr: *const ()) {
+                assert_eq!(ptr as usize, 5);
+            }
+        }
+    }
+}
@@ -1,6 +1,6 @@
 use crate::clocks::WasiClocks;
 use crate::dir::{DirCaps, DirEntry, WasiDir};
-use crate::file::{FileCaps, FileEntry, WasiFile};
+use crate::file::{FileCaps, FileEntry, TableFileExt, WasiFile};
 use crate::sched::WasiSched;
 use crate::string_array::{StringArray, StringArrayError};
 use crate::table::Table;
@@ -39,6 +39,9 @@ impl WasiCtx {
     }
 
     pub fn insert_file(&mut self, fd: u32, file: Box<dyn WasiFile>, caps: FileCaps) {
+        if let Ok(old) = self.table.get_file(fd) {
+            self.sched.file_closing(old.file());
+        }
         self.table()
             .insert_at(fd, Box::new(FileEntry::new(caps, file)));
     }
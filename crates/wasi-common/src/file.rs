@@ -189,6 +189,12 @@ impl FileEntry {
         FileEntry { caps, file }
     }
 
+    /// Get the file regardless of this entry's capabilities, for bookkeeping
+    /// that isn't done on behalf of the guest.
+    pub fn file(&self) -> &dyn WasiFile {
+        &*self.file
+    }
+
     pub fn capable_of(&self, caps: FileCaps) -> Result<(), Error> {
         if self.caps.contains(caps) {
             Ok(())
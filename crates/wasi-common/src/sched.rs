@@ -14,6 +14,14 @@ pub trait WasiSched: Send + Sync {
     async fn poll_oneoff<'a>(&self, poll: &mut Poll<'a>) -> Result<(), Error>;
     async fn sched_yield(&self) -> Result<(), Error>;
     async fn sleep(&self, duration: Duration) -> Result<(), Error>;
+
+    /// Called right before `file` is closed by the WASI context.
+    ///
+    /// Schedulers that keep state about files across `poll_oneoff` calls,
+    /// such as a persistent OS readiness registration, use this to discard
+    /// that state before the underlying OS handle is released and possibly
+    /// reused for a different file.
+    fn file_closing(&self, _file: &dyn WasiFile) {}
 }
 
 #[derive(Debug, Copy, Clone, PartialEq, Eq)]
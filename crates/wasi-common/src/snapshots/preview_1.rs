@@ -282,7 +282,7 @@ impl wasi_snapshot_preview1::WasiSnapshotPreview1 for WasiCtx {
     }
 
     async fn fd_close(&mut self, fd: types::Fd) -> Result<(), Error> {
-        let table = self.table();
+        let table = &mut self.table;
         let fd = u32::from(fd);
 
         // Fail fast: If not present in table, Badf
@@ -291,6 +291,7 @@ impl wasi_snapshot_preview1::WasiSnapshotPreview1 for WasiCtx {
         }
         // fd_close must close either a File or a Dir handle
         if table.is::<FileEntry>(fd) {
+            self.sched.file_closing(table.get_file(fd)?.file());
             let _ = table.delete(fd);
         } else if table.is::<DirEntry>(fd) {
             // We cannot close preopened directories
@@ -589,7 +590,7 @@ impl wasi_snapshot_preview1::WasiSnapshotPreview1 for WasiCtx {
         }
     }
     async fn fd_renumber(&mut self, from: types::Fd, to: types::Fd) -> Result<(), Error> {
-        let table = self.table();
+        let table = &mut self.table;
         let from = u32::from(from);
         let to = u32::from(to);
         if !table.contains_key(from) {
@@ -598,6 +599,9 @@ impl wasi_snapshot_preview1::WasiSnapshotPreview1 for WasiCtx {
         if table.is_preopen(from) || table.is_preopen(to) {
             return Err(Error::not_supported().context("cannot renumber a preopen"));
         }
+        if let Ok(to_entry) = table.get_file(to) {
+            self.sched.file_closing(to_entry.file());
+        }
         let from_entry = table
             .delete(from)
             .expect("we checked that table contains from");
@@ -24,7 +24,10 @@ pub(crate) trait BackendGraph {
 
 /// A [BackendExecutionContext] performs the actual inference; this is the
 /// backing implementation for a [crate::witx::types::GraphExecutionContext].
-pub(crate) trait BackendExecutionContext {
+///
+/// Execution contexts must be `Send` so that, with asynchronous compute
+/// enabled, inference can run on a background thread.
+pub(crate) trait BackendExecutionContext: Send {
     fn set_input(&mut self, index: u32, tensor: &Tensor<'_>) -> Result<(), BackendError>;
     fn compute(&mut self) -> Result<(), BackendError>;
     fn get_output(&mut self, index: u32, destination: &mut [u8]) -> Result<u32, BackendError>;
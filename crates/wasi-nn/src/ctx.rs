@@ -7,6 +7,9 @@ use crate::witx::types::{Graph, GraphEncoding, GraphExecutionContext};
 use std::cell::RefCell;
 use std::collections::HashMap;
 use std::hash::Hash;
+use std::mem;
+use std::sync::mpsc::{self, Receiver, Sender};
+use std::thread;
 use thiserror::Error;
 use wiggle::GuestError;
 
@@ -14,7 +17,8 @@ use wiggle::GuestError;
 pub struct Ctx {
     pub(crate) backends: HashMap<u8, Box<dyn Backend>>,
     pub(crate) graphs: Table<Graph, Box<dyn BackendGraph>>,
-    pub(crate) executions: Table<GraphExecutionContext, Box<dyn BackendExecutionContext>>,
+    pub(crate) executions: Table<GraphExecutionContext, Execution>,
+    pub(crate) async_compute: bool,
 }
 
 impl Ctx {
@@ -31,10 +35,112 @@ impl Ctx {
             backends,
             graphs: Table::default(),
             executions: Table::default(),
+            async_compute: false,
         })
     }
 }
 
+type ComputeResult = (Box<dyn BackendExecutionContext>, Result<(), BackendError>);
+
+/// An execution context, which may be running inference on a background thread
+/// when asynchronous compute is enabled.
+pub(crate) struct Execution {
+    state: ExecutionState,
+    /// The thread running this context's background inference, started the
+    /// first time it's needed and reused for every later `compute`.
+    worker: Option<Worker>,
+}
+
+enum ExecutionState {
+    Ready(Box<dyn BackendExecutionContext>),
+    /// The execution context was handed to the worker thread.
+    Computing,
+    /// The worker thread panicked, taking the execution context with it.
+    Poisoned,
+}
+
+/// A long-lived thread that computes inference for one execution context.
+///
+/// The context is sent to the thread for every inference and sent back once
+/// it's done, so it's only ever used by one thread at a time.
+struct Worker {
+    contexts: Sender<Box<dyn BackendExecutionContext>>,
+    results: Receiver<ComputeResult>,
+}
+
+impl Worker {
+    fn spawn() -> Result<Self, BackendError> {
+        let (contexts, requests) = mpsc::channel::<Box<dyn BackendExecutionContext>>();
+        let (done, results) = mpsc::channel();
+        thread::Builder::new()
+            .name("wasi-nn-compute".into())
+            .spawn(move || {
+                // The loop ends once the `Execution` owning this worker is
+                // dropped.
+                for mut context in requests {
+                    let result = context.compute();
+                    if done.send((context, result)).is_err() {
+                        break;
+                    }
+                }
+            })
+            .map_err(anyhow::Error::from)?;
+        Ok(Worker { contexts, results })
+    }
+}
+
+impl Execution {
+    pub fn new(context: Box<dyn BackendExecutionContext>) -> Self {
+        Execution {
+            state: ExecutionState::Ready(context),
+            worker: None,
+        }
+    }
+
+    /// Start running inference on this context's worker thread.
+    ///
+    /// Any previous inference is waited on first, and its error, if any, is
+    /// returned instead of starting a new one.
+    pub fn compute_in_background(&mut self) -> Result<(), BackendError> {
+        self.wait()?;
+        if self.worker.is_none() {
+            self.worker = Some(Worker::spawn()?);
+        }
+        let context = match mem::replace(&mut self.state, ExecutionState::Poisoned) {
+            ExecutionState::Ready(context) => context,
+            _ => unreachable!(),
+        };
+        let worker = self.worker.as_ref().unwrap();
+        if worker.contexts.send(context).is_err() {
+            return Err(anyhow::anyhow!("inference thread panicked").into());
+        }
+        self.state = ExecutionState::Computing;
+        Ok(())
+    }
+
+    /// Wait for any inference running in the background to finish and return
+    /// the execution context.
+    ///
+    /// If the background inference failed its error is returned here, once.
+    pub fn wait(&mut self) -> Result<&mut Box<dyn BackendExecutionContext>, BackendError> {
+        if let ExecutionState::Computing = self.state {
+            self.state = ExecutionState::Poisoned;
+            let worker = self.worker.as_ref().unwrap();
+            let (context, result) = worker
+                .results
+                .recv()
+                .map_err(|_| anyhow::anyhow!("inference thread panicked"))?;
+            self.state = ExecutionState::Ready(context);
+            result?;
+        }
+        match &mut self.state {
+            ExecutionState::Ready(context) => Ok(context),
+            ExecutionState::Computing => unreachable!(),
+            ExecutionState::Poisoned => Err(anyhow::anyhow!("inference thread panicked").into()),
+        }
+    }
+}
+
 /// This struct solely wraps [Ctx] in a `RefCell`.
 pub struct WasiNnCtx {
     pub(crate) ctx: RefCell<Ctx>,
@@ -47,6 +153,21 @@ impl WasiNnCtx {
             ctx: RefCell::new(Ctx::new()?),
         })
     }
+
+    /// Configure whether `compute` runs inference on a background thread
+    /// instead of blocking the calling thread; disabled by default. Each
+    /// execution context gets its own worker thread, which is started on its
+    /// first `compute` and kept until the context is dropped.
+    ///
+    /// When enabled, `compute` returns as soon as inference has started and
+    /// the guest may keep running, e.g. to start inference on other execution
+    /// contexts so that several requests are in flight at once. The next
+    /// `set_input`, `compute` or `get_output` on the same execution context
+    /// waits for the inference to finish and reports any error it hit.
+    pub fn async_compute(self, enable: bool) -> Self {
+        self.ctx.borrow_mut().async_compute = enable;
+        self
+    }
 }
 
 /// Possible errors while interacting with [WasiNnCtx].
@@ -106,4 +227,71 @@ mod test {
     fn instantiate() {
         WasiNnCtx::new().unwrap();
     }
+
+    struct Counter {
+        computed: u32,
+        fail: bool,
+        threads: Vec<thread::ThreadId>,
+    }
+
+    fn counter(fail: bool) -> Box<Counter> {
+        Box::new(Counter {
+            computed: 0,
+            fail,
+            threads: Vec::new(),
+        })
+    }
+
+    impl BackendExecutionContext for Counter {
+        fn set_input(
+            &mut self,
+            _: u32,
+            _: &crate::witx::types::Tensor<'_>,
+        ) -> Result<(), BackendError> {
+            Ok(())
+        }
+        fn compute(&mut self) -> Result<(), BackendError> {
+            self.computed += 1;
+            self.threads.push(thread::current().id());
+            if self.fail {
+                return Err(anyhow::anyhow!("failed").into());
+            }
+            Ok(())
+        }
+        fn get_output(&mut self, index: u32, destination: &mut [u8]) -> Result<u32, BackendError> {
+            destination[0] = match index {
+                0 => self.computed as u8,
+                _ => {
+                    // Every inference ran on the same worker thread, and not
+                    // on the thread that started it.
+                    let first = self.threads[0];
+                    let same = self.threads.iter().all(|t| *t == first);
+                    (same && first != thread::current().id()) as u8
+                }
+            };
+            Ok(1)
+        }
+    }
+
+    #[test]
+    fn background_compute() {
+        let mut execution = Execution::new(counter(false));
+        execution.compute_in_background().unwrap();
+        execution.compute_in_background().unwrap();
+        execution.compute_in_background().unwrap();
+        let mut out = [0];
+        execution.wait().unwrap().get_output(0, &mut out).unwrap();
+        assert_eq!(out, [3]);
+        execution.wait().unwrap().get_output(1, &mut out).unwrap();
+        assert_eq!(out, [1]);
+    }
+
+    #[test]
+    fn background_compute_error() {
+        let mut execution = Execution::new(counter(true));
+        execution.compute_in_background().unwrap();
+        assert!(execution.wait().is_err());
+        // The error is only reported once.
+        assert!(execution.wait().is_ok());
+    }
 }
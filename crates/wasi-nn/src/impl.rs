@@ -1,4 +1,5 @@
 //! Implements the wasi-nn API.
+use crate::ctx::Execution;
 use crate::ctx::WasiNnResult as Result;
 use crate::witx::types::{
     ExecutionTarget, Graph, GraphBuilderArray, GraphEncoding, GraphExecutionContext, Tensor,
@@ -48,7 +49,11 @@ impl<'a> WasiEphemeralNn for WasiNnCtx {
             return Err(UsageError::InvalidGraphHandle.into());
         };
 
-        let exec_context_id = self.ctx.borrow_mut().executions.insert(exec_context);
+        let exec_context_id = self
+            .ctx
+            .borrow_mut()
+            .executions
+            .insert(Execution::new(exec_context));
         Ok(exec_context_id)
     }
 
@@ -59,15 +64,21 @@ impl<'a> WasiEphemeralNn for WasiNnCtx {
         tensor: &Tensor<'b>,
     ) -> Result<()> {
         if let Some(exec_context) = self.ctx.borrow_mut().executions.get_mut(exec_context_id) {
-            Ok(exec_context.set_input(index, tensor)?)
+            Ok(exec_context.wait()?.set_input(index, tensor)?)
         } else {
             Err(UsageError::InvalidGraphHandle.into())
         }
     }
 
     fn compute(&mut self, exec_context_id: GraphExecutionContext) -> Result<()> {
-        if let Some(exec_context) = self.ctx.borrow_mut().executions.get_mut(exec_context_id) {
-            Ok(exec_context.compute()?)
+        let mut ctx = self.ctx.borrow_mut();
+        let async_compute = ctx.async_compute;
+        if let Some(exec_context) = ctx.executions.get_mut(exec_context_id) {
+            if async_compute {
+                Ok(exec_context.compute_in_background()?)
+            } else {
+                Ok(exec_context.wait()?.compute()?)
+            }
         } else {
             Err(UsageError::InvalidExecutionContextHandle.into())
         }
@@ -82,7 +93,7 @@ impl<'a> WasiEphemeralNn for WasiNnCtx {
     ) -> Result<u32> {
         let mut destination = out_buffer.as_array(out_buffer_max_size).as_slice_mut()?;
         if let Some(exec_context) = self.ctx.borrow_mut().executions.get_mut(exec_context_id) {
-            Ok(exec_context.get_output(index, &mut destination)?)
+            Ok(exec_context.wait()?.get_output(index, &mut destination)?)
         } else {
             Err(UsageError::InvalidGraphHandle.into())
         }
@@ -70,6 +70,13 @@ impl BackendGraph for OpenvinoGraph {
 
 struct OpenvinoExecutionContext(Arc<openvino::CNNNetwork>, openvino::InferRequest);
 
+// The OpenVINO objects wrapped here are not tied to the thread that created
+// them. An execution context is only ever used by the guest's thread and, with
+// background compute, by its execution's single worker thread, and it's handed
+// between the two over a channel so they never use it at once. The shared
+// network is only read from.
+unsafe impl Send for OpenvinoExecutionContext {}
+
 impl BackendExecutionContext for OpenvinoExecutionContext {
     fn set_input(&mut self, index: u32, tensor: &Tensor<'_>) -> Result<(), BackendError> {
         let input_name = self.0.get_input_name(index as usize)?;
@@ -10,8 +10,10 @@ use std::sync::Arc;
 use wasmparser::WasmFeatures;
 #[cfg(feature = "cache")]
 use wasmtime_cache::CacheConfig;
+#[cfg(feature = "cache")]
+pub use wasmtime_cache::CacheStore;
 use wasmtime_environ::{CompilerBuilder, Tunables};
-use wasmtime_jit::{JitDumpAgent, NullProfilerAgent, ProfilingAgent, VTuneAgent};
+use wasmtime_jit::{JitDumpAgent, NullProfilerAgent, PerfMapAgent, ProfilingAgent, VTuneAgent};
 use wasmtime_runtime::{InstanceAllocator, OnDemandInstanceAllocator, RuntimeMemoryCreator};
 
 #[cfg(feature = "pooling-allocator")]
@@ -86,21 +88,31 @@ pub struct Config {
     pub(crate) tunables: Tunables,
     #[cfg(feature = "cache")]
     pub(crate) cache_config: CacheConfig,
+    #[cfg(feature = "cache")]
+    pub(crate) cache_store: Option<Arc<dyn CacheStore>>,
     pub(crate) profiler: Arc<dyn ProfilingAgent>,
     pub(crate) mem_creator: Option<Arc<dyn RuntimeMemoryCreator>>,
     pub(crate) allocation_strategy: InstanceAllocationStrategy,
     pub(crate) max_wasm_stack: usize,
     pub(crate) features: WasmFeatures,
     pub(crate) wasm_backtrace_details_env_used: bool,
+    pub(crate) wasm_backtrace: bool,
     #[cfg(feature = "async")]
     pub(crate) async_stack_size: usize,
+    #[cfg(feature = "async")]
+    pub(crate) async_stack_cache_size: usize,
     pub(crate) async_support: bool,
     pub(crate) module_version: ModuleVersionStrategy,
     pub(crate) parallel_compilation: bool,
+    pub(crate) parallel_compilation_threads: usize,
+    #[cfg(compiler)]
+    pub(crate) tier_up_opt_level: OptLevel,
     pub(crate) paged_memory_initialization: bool,
     pub(crate) memory_init_cow: bool,
     pub(crate) memory_guaranteed_dense_image_size: u64,
     pub(crate) force_memory_init_memfd: bool,
+    pub(crate) lazy_debug_registration: bool,
+    pub(crate) share_deserialized_code: bool,
 }
 
 impl Config {
@@ -113,6 +125,8 @@ impl Config {
             compiler: compiler_builder(Strategy::Auto).unwrap(),
             #[cfg(feature = "cache")]
             cache_config: CacheConfig::new_cache_disabled(),
+            #[cfg(feature = "cache")]
+            cache_store: None,
             profiler: Arc::new(NullProfilerAgent),
             mem_creator: None,
             allocation_strategy: InstanceAllocationStrategy::OnDemand,
@@ -126,17 +140,25 @@ impl Config {
             // committed.
             max_wasm_stack: 512 * 1024,
             wasm_backtrace_details_env_used: false,
+            wasm_backtrace: true,
             features: WasmFeatures::default(),
             #[cfg(feature = "async")]
             async_stack_size: 2 << 20,
+            #[cfg(feature = "async")]
+            async_stack_cache_size: 0,
             async_support: false,
             module_version: ModuleVersionStrategy::default(),
             parallel_compilation: true,
+            parallel_compilation_threads: 0,
+            #[cfg(compiler)]
+            tier_up_opt_level: OptLevel::Speed,
             // Default to paged memory initialization when using uffd on linux
             paged_memory_initialization: cfg!(all(target_os = "linux", feature = "uffd")),
             memory_init_cow: true,
             memory_guaranteed_dense_image_size: 16 << 20,
             force_memory_init_memfd: false,
+            lazy_debug_registration: false,
+            share_deserialized_code: false,
         };
         #[cfg(compiler)]
         {
@@ -282,6 +304,72 @@ impl Config {
         self
     }
 
+    /// Configures whether the DWARF debug information emitted with
+    /// [`Config::debug_info`] is registered with native debuggers lazily.
+    ///
+    /// Normally each module with debug information has a debug image built
+    /// and registered through the GDB JIT interface as soon as it's loaded,
+    /// which adds to load time and slows down debuggers when many modules
+    /// are loaded. When this option is enabled modules are only registered
+    /// when loaded if a debugger is attached to the process at that time
+    /// (which is only detected on Linux). Otherwise registration is deferred
+    /// until [`Module::register_debug_info`](crate::Module::register_debug_info)
+    /// is called, for example once a debugger attaches.
+    ///
+    /// Note that profilers configured with [`Config::profiler`] don't receive
+    /// the debug image of modules whose registration was deferred.
+    ///
+    /// By default this option is `false`.
+    pub fn lazy_debug_registration(&mut self, enable: bool) -> &mut Self {
+        self.lazy_debug_registration = enable;
+        self
+    }
+
+    /// Configures whether modules loaded with
+    /// [`Module::deserialize_file`](crate::Module::deserialize_file) share
+    /// their compiled code with other engines in the same process.
+    ///
+    /// Code loaded from a file is mapped directly from the file, so processes
+    /// loading the same file already share its pages through the page cache.
+    /// Within one process however each load of a file creates a new mapping
+    /// and its own copy of module metadata. When this option is enabled
+    /// loading a file which is already loaded by an engine that also enabled
+    /// this option reuses the existing compiled module instead, including its
+    /// mapping of the file. The file must have been produced with compilation
+    /// settings that are compatible with both engines, which is checked as
+    /// usual. Type information and memory images are still kept per engine.
+    ///
+    /// Files are identified by their device, inode, size and modification
+    /// time, so this has no effect on platforms other than Unix. Note that a
+    /// shared module is only reported once to profilers configured with
+    /// [`Config::profiler`], by the engine which loaded it first.
+    ///
+    /// By default this option is `false`.
+    pub fn share_deserialized_code(&mut self, enable: bool) -> &mut Self {
+        self.share_deserialized_code = enable;
+        self
+    }
+
+    /// Configures whether a backtrace of WebAssembly frames is captured when
+    /// a trap happens in WebAssembly code.
+    ///
+    /// Capturing a backtrace walks the native stack and looks up each frame,
+    /// which can dominate the cost of a trap. Embeddings which use traps for
+    /// routine control flow, for example to reject untrusted input with a
+    /// bounds check, can disable this so [`Trap::trace`](crate::Trap::trace)
+    /// is empty for traps raised by WebAssembly and trapping is cheap.
+    ///
+    /// Traps created by the host with [`Trap::new`](crate::Trap::new) still
+    /// capture a backtrace, and when the `wasm-backtrace` feature of this
+    /// crate is disabled backtraces are never captured regardless of this
+    /// setting.
+    ///
+    /// By default this option is `true`.
+    pub fn wasm_backtrace(&mut self, enable: bool) -> &mut Self {
+        self.wasm_backtrace = enable;
+        self
+    }
+
     /// Configures whether backtraces in `Trap` will parse debug info in the wasm file to
     /// have filename/line number information.
     ///
@@ -468,6 +556,33 @@ impl Config {
         Ok(self)
     }
 
+    /// Configures how many stacks used for asynchronous execution are kept
+    /// around for reuse.
+    ///
+    /// With the default on-demand instance allocator every asynchronous call
+    /// maps a fresh stack, with a guard page, and unmaps it once the call
+    /// finishes. For workloads which make many short asynchronous calls this
+    /// can be a significant part of each call's cost. When this is set to a
+    /// nonzero value, up to `size` stacks are cached by the engine after use
+    /// and handed out again to later calls. The pages of a cached stack are
+    /// discarded when it's returned to the cache, so cached stacks only
+    /// consume address space and a reused stack starts out zeroed.
+    ///
+    /// Statistics about the cache are available through
+    /// [`Engine::fiber_stack_stats`](crate::Engine::fiber_stack_stats).
+    ///
+    /// This has no effect with the pooling instance allocator, which always
+    /// reuses its stacks, or on Windows, where stacks are managed by the
+    /// operating system.
+    ///
+    /// By default this option is 0, and stacks are not cached.
+    #[cfg(feature = "async")]
+    #[cfg_attr(nightlydoc, doc(cfg(feature = "async")))]
+    pub fn async_stack_cache_size(&mut self, size: usize) -> &mut Self {
+        self.async_stack_cache_size = size;
+        self
+    }
+
     /// Configures whether the WebAssembly threads proposal will be enabled for
     /// compilation.
     ///
@@ -645,6 +760,7 @@ impl Config {
         self.profiler = match profile {
             ProfilingStrategy::JitDump => Arc::new(JitDumpAgent::new()?) as Arc<dyn ProfilingAgent>,
             ProfilingStrategy::VTune => Arc::new(VTuneAgent::new()?) as Arc<dyn ProfilingAgent>,
+            ProfilingStrategy::PerfMap => Arc::new(PerfMapAgent::new()?) as Arc<dyn ProfilingAgent>,
             ProfilingStrategy::None => Arc::new(NullProfilerAgent),
         };
         Ok(self)
@@ -678,17 +794,34 @@ impl Config {
     #[cfg(compiler)]
     #[cfg_attr(nightlydoc, doc(cfg(feature = "cranelift")))] // see build.rs
     pub fn cranelift_opt_level(&mut self, level: OptLevel) -> &mut Self {
-        let val = match level {
-            OptLevel::None => "none",
-            OptLevel::Speed => "speed",
-            OptLevel::SpeedAndSize => "speed_and_size",
-        };
         self.compiler
-            .set("opt_level", val)
+            .set("opt_level", level.flag_value())
             .expect("should be valid flag");
         self
     }
 
+    /// Configures the optimization level used by [`Module::from_binary_tier_up`].
+    ///
+    /// Engines can compile modules at two optimization levels: the one
+    /// configured with [`Config::cranelift_opt_level`], used by constructors
+    /// such as [`Module::new`], and this "tier-up" level. This enables a
+    /// tiered compilation strategy where a module is first compiled quickly at
+    /// a low optimization level so it can start running right away, and is
+    /// then recompiled in the background at this level. Modules compiled at
+    /// either level belong to the same [`Engine`](crate::Engine) and can be
+    /// used interchangeably with its stores.
+    ///
+    /// The default value for this is `OptLevel::Speed`.
+    ///
+    /// [`Module::new`]: crate::Module::new
+    /// [`Module::from_binary_tier_up`]: crate::Module::from_binary_tier_up
+    #[cfg(compiler)]
+    #[cfg_attr(nightlydoc, doc(cfg(feature = "cranelift")))] // see build.rs
+    pub fn cranelift_tier_up_opt_level(&mut self, level: OptLevel) -> &mut Self {
+        self.tier_up_opt_level = level;
+        self
+    }
+
     /// Configures whether Cranelift should perform a NaN-canonicalization pass.
     ///
     /// When Cranelift is used as a code generation backend this will configure
@@ -801,6 +934,30 @@ impl Config {
         Ok(self)
     }
 
+    /// Configures a custom storage backend for compiled modules.
+    ///
+    /// When set, [`Module::new`](crate::Module::new) and related functions
+    /// look up compiled artifacts in `store` before compiling and insert
+    /// artifacts into it after a cache miss. This takes precedence over the
+    /// filesystem cache configured with [`Config::cache_config_load`], which
+    /// allows embedders to keep compiled modules in memory or share them
+    /// between machines.
+    ///
+    /// Cache keys incorporate a hash of the wasm binary along with all engine
+    /// settings which affect compilation, so a single `store` may be shared
+    /// between engines with different configurations.
+    ///
+    /// By default no custom cache store is configured.
+    ///
+    /// This method is only available when the `cache` feature of this crate is
+    /// enabled.
+    #[cfg(feature = "cache")]
+    #[cfg_attr(nightlydoc, doc(cfg(feature = "cache")))]
+    pub fn cache_store(&mut self, store: Arc<dyn CacheStore>) -> &mut Self {
+        self.cache_store = Some(store);
+        self
+    }
+
     /// Sets a custom memory creator.
     ///
     /// Custom memory creators are used when creating host `Memory` objects or when
@@ -1136,6 +1293,24 @@ impl Config {
         self
     }
 
+    /// Configures the maximum number of threads used to compile a module when
+    /// [`Config::parallel_compilation`] is enabled.
+    ///
+    /// When set to a nonzero value the [`Engine`](crate::Engine) created from
+    /// this configuration owns a dedicated pool of at most `threads` threads
+    /// which is used for all of its compilations, rather than sharing rayon's
+    /// global thread pool which by default has one thread per CPU. This can be
+    /// used to bound how much of a machine an engine's compilations can
+    /// consume.
+    ///
+    /// By default this is 0, meaning rayon's global thread pool is used.
+    #[cfg(feature = "parallel-compilation")]
+    #[cfg_attr(nightlydoc, doc(cfg(feature = "parallel-compilation")))]
+    pub fn parallel_compilation_threads(&mut self, threads: usize) -> &mut Self {
+        self.parallel_compilation_threads = threads;
+        self
+    }
+
     /// Configures whether compiled artifacts will contain information to map
     /// native program addresses back to the original wasm module.
     ///
@@ -1273,10 +1448,13 @@ impl Config {
         let stack_size = 0;
 
         match self.allocation_strategy {
-            InstanceAllocationStrategy::OnDemand => Ok(Box::new(OnDemandInstanceAllocator::new(
-                self.mem_creator.clone(),
-                stack_size,
-            ))),
+            InstanceAllocationStrategy::OnDemand => {
+                let allocator =
+                    OnDemandInstanceAllocator::new(self.mem_creator.clone(), stack_size);
+                #[cfg(feature = "async")]
+                let allocator = allocator.with_fiber_stack_cache(self.async_stack_cache_size);
+                Ok(Box::new(allocator))
+            }
             #[cfg(feature = "pooling-allocator")]
             InstanceAllocationStrategy::Pooling {
                 strategy,
@@ -1331,21 +1509,31 @@ impl Clone for Config {
             tunables: self.tunables.clone(),
             #[cfg(feature = "cache")]
             cache_config: self.cache_config.clone(),
+            #[cfg(feature = "cache")]
+            cache_store: self.cache_store.clone(),
             profiler: self.profiler.clone(),
             features: self.features.clone(),
             mem_creator: self.mem_creator.clone(),
             allocation_strategy: self.allocation_strategy.clone(),
             max_wasm_stack: self.max_wasm_stack,
             wasm_backtrace_details_env_used: self.wasm_backtrace_details_env_used,
+            wasm_backtrace: self.wasm_backtrace,
             async_support: self.async_support,
             #[cfg(feature = "async")]
             async_stack_size: self.async_stack_size,
+            #[cfg(feature = "async")]
+            async_stack_cache_size: self.async_stack_cache_size,
             module_version: self.module_version.clone(),
             parallel_compilation: self.parallel_compilation,
+            parallel_compilation_threads: self.parallel_compilation_threads,
+            #[cfg(compiler)]
+            tier_up_opt_level: self.tier_up_opt_level.clone(),
             paged_memory_initialization: self.paged_memory_initialization,
             memory_init_cow: self.memory_init_cow,
             memory_guaranteed_dense_image_size: self.memory_guaranteed_dense_image_size,
             force_memory_init_memfd: self.force_memory_init_memfd,
+            lazy_debug_registration: self.lazy_debug_registration,
+            share_deserialized_code: self.share_deserialized_code,
         }
     }
 }
@@ -1354,6 +1542,9 @@ impl fmt::Debug for Config {
     fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
         let mut f = f.debug_struct("Config");
         f.field("debug_info", &self.tunables.generate_native_debuginfo)
+            .field("lazy_debug_registration", &self.lazy_debug_registration)
+            .field("share_deserialized_code", &self.share_deserialized_code)
+            .field("wasm_backtrace", &self.wasm_backtrace)
             .field("parse_wasm_debuginfo", &self.tunables.parse_wasm_debuginfo)
             .field("wasm_threads", &self.features.threads)
             .field("wasm_reference_types", &self.features.reference_types)
@@ -1377,7 +1568,11 @@ impl fmt::Debug for Config {
                 "guard_before_linear_memory",
                 &self.tunables.guard_before_linear_memory,
             )
-            .field("parallel_compilation", &self.parallel_compilation);
+            .field("parallel_compilation", &self.parallel_compilation)
+            .field(
+                "parallel_compilation_threads",
+                &self.parallel_compilation_threads,
+            );
         #[cfg(compiler)]
         {
             f.field("compiler", &self.compiler);
@@ -1422,6 +1617,18 @@ pub enum OptLevel {
     SpeedAndSize,
 }
 
+impl OptLevel {
+    /// Returns the value of Cranelift's `opt_level` setting for this level.
+    #[cfg(compiler)]
+    pub(crate) fn flag_value(&self) -> &'static str {
+        match self {
+            OptLevel::None => "none",
+            OptLevel::Speed => "speed",
+            OptLevel::SpeedAndSize => "speed_and_size",
+        }
+    }
+}
+
 /// Select which profiling technique to support.
 #[derive(Debug, Clone, Copy)]
 pub enum ProfilingStrategy {
@@ -1434,6 +1641,15 @@ pub enum ProfilingStrategy {
 
     /// Collect profiling info using the "ittapi", used with `VTune` on Linux.
     VTune,
+
+    /// Write symbols for JIT code to a "perf map" file, `/tmp/perf-<pid>.map`,
+    /// used with `perf` on Linux.
+    ///
+    /// Unlike [`ProfilingStrategy::JitDump`] this only records the name and
+    /// address range of each function, and the results can be used directly
+    /// by `perf` (including `perf top` on a running process) without first
+    /// running `perf inject`.
+    PerfMap,
 }
 
 /// Select how wasm backtrace detailed information is handled.
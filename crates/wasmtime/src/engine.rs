@@ -1,16 +1,21 @@
 use crate::signatures::SignatureRegistry;
 use crate::{Config, Trap};
-use anyhow::Result;
+use anyhow::{bail, Result};
 use once_cell::sync::OnceCell;
 #[cfg(feature = "parallel-compilation")]
 use rayon::prelude::*;
 use std::sync::atomic::{AtomicU64, Ordering};
-use std::sync::Arc;
+use std::sync::{Arc, Condvar, Mutex};
+use std::thread::JoinHandle;
+use std::time::{Duration, Instant};
 #[cfg(feature = "cache")]
 use wasmtime_cache::CacheConfig;
 use wasmtime_environ::FlagValue;
 use wasmtime_runtime::{debug_builtins, CompiledModuleIdAllocator, InstanceAllocator};
 
+#[cfg(feature = "async")]
+pub use wasmtime_runtime::FiberStackStats;
+
 /// An `Engine` which is a global context for compilation and management of wasm
 /// modules.
 ///
@@ -42,10 +47,17 @@ struct EngineInner {
     config: Config,
     #[cfg(compiler)]
     compiler: Box<dyn wasmtime_environ::Compiler>,
+    #[cfg(compiler)]
+    tier_up_compiler: OnceCell<Box<dyn wasmtime_environ::Compiler>>,
     allocator: Box<dyn InstanceAllocator>,
     signatures: SignatureRegistry,
-    epoch: AtomicU64,
+    #[cfg(compiler)]
+    host_trampolines: crate::trampoline::HostTrampolineCache,
+    epoch: Arc<AtomicU64>,
+    epoch_ticker: Mutex<Option<EpochTicker>>,
     unique_id_allocator: CompiledModuleIdAllocator,
+    #[cfg(feature = "parallel-compilation")]
+    thread_pool: Option<rayon::ThreadPool>,
 
     // One-time check of whether the compiler's settings, if present, are
     // compatible with the native host.
@@ -67,15 +79,33 @@ impl Engine {
         let allocator = config.build_allocator()?;
         allocator.adjust_tunables(&mut config.tunables);
 
+        #[cfg(feature = "parallel-compilation")]
+        let thread_pool = match config.parallel_compilation_threads {
+            0 => None,
+            n => Some(
+                rayon::ThreadPoolBuilder::new()
+                    .num_threads(n)
+                    .thread_name(|i| format!("wasmtime-compile-{}", i))
+                    .build()?,
+            ),
+        };
+
         Ok(Engine {
             inner: Arc::new(EngineInner {
                 #[cfg(compiler)]
                 compiler: config.compiler.build()?,
+                #[cfg(compiler)]
+                tier_up_compiler: OnceCell::new(),
                 config,
                 allocator,
                 signatures: registry,
-                epoch: AtomicU64::new(0),
+                #[cfg(compiler)]
+                host_trampolines: Default::default(),
+                epoch: Arc::new(AtomicU64::new(0)),
+                epoch_ticker: Mutex::new(None),
                 unique_id_allocator: CompiledModuleIdAllocator::new(),
+                #[cfg(feature = "parallel-compilation")]
+                thread_pool,
                 compatible_with_native_host: OnceCell::new(),
             }),
         })
@@ -113,6 +143,20 @@ impl Engine {
         &*self.inner.compiler
     }
 
+    /// Returns the compiler used by `Module::from_binary_tier_up`, which is the
+    /// same as this engine's compiler except for its optimization level.
+    ///
+    /// This is created lazily since most engines never use it.
+    #[cfg(compiler)]
+    pub(crate) fn tier_up_compiler(&self) -> Result<&dyn wasmtime_environ::Compiler> {
+        let compiler = self.inner.tier_up_compiler.get_or_try_init(|| {
+            let mut builder = self.config().compiler.clone();
+            builder.set("opt_level", self.config().tier_up_opt_level.flag_value())?;
+            builder.build()
+        })?;
+        Ok(&**compiler)
+    }
+
     pub(crate) fn allocator(&self) -> &dyn InstanceAllocator {
         self.inner.allocator.as_ref()
     }
@@ -131,6 +175,20 @@ impl Engine {
         &self.inner.signatures
     }
 
+    #[cfg(compiler)]
+    pub(crate) fn host_trampolines(&self) -> &crate::trampoline::HostTrampolineCache {
+        &self.inner.host_trampolines
+    }
+
+    /// Returns how many distinct host function trampolines this engine shares
+    /// between the host functions that are currently alive. Only intended for
+    /// tests.
+    #[cfg(compiler)]
+    #[doc(hidden)]
+    pub fn live_host_trampolines(&self) -> usize {
+        self.inner.host_trampolines.live_entries()
+    }
+
     pub(crate) fn epoch_counter(&self) -> &AtomicU64 {
         &self.inner.epoch
     }
@@ -162,6 +220,57 @@ impl Engine {
         self.inner.epoch.fetch_add(1, Ordering::Relaxed);
     }
 
+    /// Starts a background thread which calls
+    /// [`Engine::increment_epoch`] every `interval`.
+    ///
+    /// This saves embeddings which use epoch-based interruption from
+    /// having to run their own ticker thread. The thread is owned by this
+    /// engine: calling this method again replaces it with one ticking at
+    /// the new interval, and it is stopped by
+    /// [`Engine::stop_epoch_ticker`] or once the engine is dropped.
+    ///
+    /// Note that the interval is only approximate, since the thread is
+    /// subject to the operating system's scheduling, and that deadlines
+    /// are only as precise as the interval: a store whose deadline is one
+    /// tick away may reach it anywhere between immediately and `interval`
+    /// from now.
+    ///
+    /// See [`Config::epoch_interruption`](crate::Config::epoch_interruption)
+    /// for an introduction to epoch-based interruption.
+    pub fn start_epoch_ticker(&self, interval: Duration) -> Result<()> {
+        if interval.is_zero() {
+            bail!("epoch ticker interval cannot be zero");
+        }
+        let ticker = EpochTicker::spawn(self.inner.epoch.clone(), interval)?;
+        // The previous ticker, if any, is stopped once the lock has been
+        // released.
+        let prev = self.inner.epoch_ticker.lock().unwrap().replace(ticker);
+        drop(prev);
+        Ok(())
+    }
+
+    /// Stops the thread started by [`Engine::start_epoch_ticker`], if
+    /// any.
+    ///
+    /// The epoch is no longer incremented automatically after this
+    /// returns.
+    pub fn stop_epoch_ticker(&self) {
+        let prev = self.inner.epoch_ticker.lock().unwrap().take();
+        drop(prev);
+    }
+
+    /// Returns statistics about the stacks used for asynchronous execution
+    /// by this engine.
+    ///
+    /// Stacks are only tracked when they're cached for reuse, as configured
+    /// with [`Config::async_stack_cache_size`]; otherwise all statistics are
+    /// zero.
+    #[cfg(feature = "async")]
+    #[cfg_attr(nightlydoc, doc(cfg(feature = "async")))]
+    pub fn fiber_stack_stats(&self) -> FiberStackStats {
+        self.allocator().fiber_stack_stats()
+    }
+
     pub(crate) fn unique_id_allocator(&self) -> &CompiledModuleIdAllocator {
         &self.inner.unique_id_allocator
     }
@@ -193,7 +302,8 @@ impl Engine {
     pub fn precompile_module(&self, bytes: &[u8]) -> Result<Vec<u8>> {
         #[cfg(feature = "wat")]
         let bytes = wat::parse_bytes(&bytes)?;
-        let (mmap, _, types) = crate::Module::build_artifacts(self, &bytes)?;
+        let (mmap, _, types) =
+            crate::Module::build_artifacts(self, self.compiler(), &bytes, Default::default())?;
         crate::module::SerializedModule::from_artifacts(self, &mmap, &types)
             .to_bytes(&self.config().module_version)
     }
@@ -210,10 +320,18 @@ impl Engine {
     ) -> Result<Vec<B>, E> {
         if self.config().parallel_compilation {
             #[cfg(feature = "parallel-compilation")]
-            return input
-                .into_par_iter()
-                .map(|a| f(a))
-                .collect::<Result<Vec<B>, E>>();
+            {
+                let run = || {
+                    input
+                        .into_par_iter()
+                        .map(|a| f(a))
+                        .collect::<Result<Vec<B>, E>>()
+                };
+                return match &self.inner.thread_pool {
+                    Some(pool) => pool.install(run),
+                    None => run(),
+                };
+            }
         }
 
         // In case the parallel-compilation feature is disabled or the parallel_compilation config
@@ -430,6 +548,61 @@ impl Engine {
     }
 }
 
+/// A thread which increments an engine's epoch at a fixed interval until
+/// it's dropped.
+///
+/// The thread only holds on to the epoch counter, not the engine itself, so
+/// that it never keeps the engine alive.
+struct EpochTicker {
+    stop: Arc<(Mutex<bool>, Condvar)>,
+    thread: Option<JoinHandle<()>>,
+}
+
+impl EpochTicker {
+    fn spawn(epoch: Arc<AtomicU64>, interval: Duration) -> Result<EpochTicker> {
+        let stop = Arc::new((Mutex::new(false), Condvar::new()));
+        let thread_stop = stop.clone();
+        let thread = std::thread::Builder::new()
+            .name("wasmtime-epoch-ticker".to_string())
+            .spawn(move || {
+                let (stopped, cvar) = &*thread_stop;
+                let mut stopped = stopped.lock().unwrap();
+                let mut next = Instant::now() + interval;
+                while !*stopped {
+                    let now = Instant::now();
+                    if now < next {
+                        stopped = cvar.wait_timeout(stopped, next - now).unwrap().0;
+                        continue;
+                    }
+                    epoch.fetch_add(1, Ordering::Relaxed);
+                    // Schedule ticks relative to the previous one so they
+                    // don't drift, unless the thread fell behind by a whole
+                    // tick, in which case missed ticks are dropped rather
+                    // than delivered in a burst.
+                    next += interval;
+                    if next <= now {
+                        next = now + interval;
+                    }
+                }
+            })?;
+        Ok(EpochTicker {
+            stop,
+            thread: Some(thread),
+        })
+    }
+}
+
+impl Drop for EpochTicker {
+    fn drop(&mut self) {
+        let (stopped, cvar) = &*self.stop;
+        *stopped.lock().unwrap() = true;
+        cvar.notify_one();
+        if let Some(thread) = self.thread.take() {
+            let _ = thread.join();
+        }
+    }
+}
+
 impl Default for Engine {
     fn default() -> Engine {
         Engine::new(&Config::default()).unwrap()
@@ -316,6 +316,31 @@ impl Global {
         Ok(())
     }
 
+    /// Returns a raw pointer, in the host's address space, to the storage of
+    /// this global's value.
+    ///
+    /// This is intended for embedders which read or write numeric globals
+    /// frequently, for example to poll a counter exported by a module, without
+    /// the overhead of [`Global::get`] and [`Global::set`]. The pointer remains
+    /// valid, and keeps pointing at this global, for as long as `store` is
+    /// alive, and WebAssembly reads and writes the value in-place.
+    ///
+    /// The value is stored in native endianness: an `i32`/`f32` occupies the
+    /// first 4 bytes, an `i64`/`f64` the first 8 bytes, and a `v128` all 16
+    /// bytes. The storage of `externref` and `funcref` globals is an internal
+    /// representation which must not be read or written through this pointer.
+    ///
+    /// Writing through the pointer is only allowed for globals whose type is
+    /// [`Mutability::Var`], and must not race with the store being used
+    /// concurrently, just like access to [`Memory::data_ptr`].
+    ///
+    /// # Panics
+    ///
+    /// Panics if this global doesn't belong to `store`.
+    pub fn data_ptr(&self, store: impl AsContext) -> *mut u8 {
+        store.as_context()[self.0].definition.cast()
+    }
+
     pub(crate) unsafe fn from_wasmtime_global(
         wasmtime_export: wasmtime_runtime::ExportGlobal,
         store: &mut StoreOpaque,
@@ -518,6 +543,47 @@ impl Table {
         }
     }
 
+    /// Writes each of `vals` into this table, starting at index `dst`.
+    ///
+    /// This is equivalent to calling [`Table::set`] for each element of
+    /// `vals` in turn, but is more efficient for initializing many elements at
+    /// once. Either all elements are written or, if an error is returned, none
+    /// are.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if `table[dst..(dst + vals.len())]` is out of bounds,
+    /// if any element of `vals` does not have the right type to be stored in
+    /// this table, or if any element of `vals` belongs to a different store.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `store` does not own this table.
+    pub fn set_range(&self, mut store: impl AsContextMut, dst: u32, vals: &[Val]) -> Result<()> {
+        let store = store.as_context_mut().0;
+        let ty = self.ty(&store).element().clone();
+        let end = u32::try_from(vals.len())
+            .ok()
+            .and_then(|len| dst.checked_add(len));
+        match end {
+            Some(end) if end <= self.internal_size(store) => {}
+            _ => bail!("table element index out of bounds"),
+        }
+        let elements = vals
+            .iter()
+            .map(|val| val.clone().into_table_element(store, ty.clone()))
+            .collect::<Result<Vec<_>>>()?;
+        let table = self.wasmtime_table(store, std::iter::empty());
+        unsafe {
+            for (index, element) in (dst..).zip(elements) {
+                (*table)
+                    .set(index, element)
+                    .expect("index and type were checked above");
+            }
+        }
+        Ok(())
+    }
+
     /// Returns the current size of this table.
     ///
     /// # Panics
@@ -8,7 +8,7 @@ use std::future::Future;
 use std::mem;
 use std::panic::{self, AssertUnwindSafe};
 use std::pin::Pin;
-use std::ptr::NonNull;
+use std::ptr::{self, NonNull};
 use std::sync::Arc;
 use wasmtime_environ::FuncIndex;
 use wasmtime_runtime::{
@@ -810,6 +810,56 @@ impl Func {
         })
     }
 
+    /// Invokes this function `count` times in an "unchecked" fashion, all
+    /// within a single transition into WebAssembly.
+    ///
+    /// This is a batched version of [`Func::call_unchecked`]. The `i`th
+    /// invocation reads its parameters from, and writes its results to, the
+    /// block of values starting at `params_and_returns.add(i * stride)`. The
+    /// store entry and exit bookkeeping, call hooks, and trap handler setup
+    /// are all performed once for the entire batch rather than once per call,
+    /// which makes this suitable for invoking the same function over many
+    /// independent inputs.
+    ///
+    /// Invocations are performed in order. If the `i`th invocation traps then
+    /// no further invocations are made and `Err((i, trap))` is returned. The
+    /// blocks for all invocations before `i` will contain their results.
+    ///
+    /// # Unsafety
+    ///
+    /// This function has the same requirements as [`Func::call_unchecked`]
+    /// for each of the `count` blocks of values, and additionally `stride` must
+    /// be large enough for each block to hold all parameters and all results
+    /// (not at the same time).
+    pub unsafe fn call_unchecked_batch(
+        &self,
+        mut store: impl AsContextMut,
+        params_and_returns: *mut ValRaw,
+        stride: usize,
+        count: usize,
+    ) -> Result<(), (usize, Trap)> {
+        let mut store = store.as_context_mut();
+        let data = &store.0.store_data()[self.0];
+        let trampoline = data.trampoline();
+        let anyfunc = data.export().anyfunc;
+        let mut index = 0;
+        invoke_wasm_and_catch_traps(&mut store, |callee| {
+            for i in 0..count {
+                // A trap longjmps out of this closure, so make sure the index
+                // of the current invocation is actually in memory before
+                // calling into wasm.
+                ptr::write_volatile(&mut index, i);
+                trampoline(
+                    (*anyfunc.as_ptr()).vmctx,
+                    callee,
+                    (*anyfunc.as_ptr()).func_ptr.as_ptr(),
+                    params_and_returns.add(i * stride),
+                );
+            }
+        })
+        .map_err(|trap| (index, trap))
+    }
+
     /// Converts the raw representation of a `funcref` into an `Option<Func>`
     ///
     /// This is intended to be used in conjunction with [`Func::new_unchecked`],
@@ -1211,6 +1261,7 @@ pub(crate) fn invoke_wasm_and_catch_traps<T>(
         }
         let result = wasmtime_runtime::catch_traps(
             store.0.signal_handler(),
+            store.0.engine().config().wasm_backtrace,
             store.0.default_callee(),
             closure,
         );
@@ -1697,12 +1748,34 @@ impl<T> Caller<'_, T> {
         // back to themselves. If this caller doesn't have that `host_state`
         // then it probably means it was a host-created object like `Func::new`
         // which doesn't have any exports we want to return anyway.
-        match self
+        let export = self
             .caller
             .host_state()
             .downcast_ref::<Instance>()?
-            .get_export(&mut self.store, name)?
-        {
+            .get_export(&mut self.store, name)?;
+        Self::filter_export(export)
+    }
+
+    /// Looks up an export from the caller's module by its index in the
+    /// module's exports.
+    ///
+    /// This is the same as [`Caller::get_export`] except that the export is
+    /// identified by an index obtained from
+    /// [`Module::get_export_index`](crate::Module::get_export_index), which
+    /// avoids looking up its name on every call. Note that the index must
+    /// have been obtained from the caller's module, as an index from another
+    /// module may refer to an unrelated export.
+    pub fn get_export_by_index(&mut self, index: usize) -> Option<Extern> {
+        let export = self
+            .caller
+            .host_state()
+            .downcast_ref::<Instance>()?
+            .get_export_by_index(&mut self.store, index)?;
+        Self::filter_export(export)
+    }
+
+    fn filter_export(export: Extern) -> Option<Extern> {
+        match export {
             Extern::Func(f) => Some(Extern::Func(f)),
             Extern::Memory(f) => Some(Extern::Memory(f)),
             // Intentionally ignore other Extern items here since this API is
@@ -7,7 +7,6 @@ use crate::{
 };
 use anyhow::{anyhow, bail, Context, Error, Result};
 use std::mem;
-use std::sync::Arc;
 use wasmtime_environ::{EntityType, FuncIndex, GlobalIndex, MemoryIndex, PrimaryMap, TableIndex};
 use wasmtime_runtime::{
     Imports, InstanceAllocationRequest, InstantiationError, StorePtr, VMContext, VMFunctionBody,
@@ -374,9 +373,9 @@ impl Instance {
         // be filled in. Fill them all in now if that's the case.
         let InstanceData { exports, id, .. } = &store[self.0];
         if exports.iter().any(|e| e.is_none()) {
-            let module = Arc::clone(store.instance(*id).module());
-            for name in module.exports.keys() {
-                self._get_export(store, name);
+            let len = store.instance(*id).module().exports.len();
+            for i in 0..len {
+                self._get_export_by_index(store, i);
             }
         }
 
@@ -411,17 +410,45 @@ impl Instance {
     }
 
     fn _get_export(&self, store: &mut StoreOpaque, name: &str) -> Option<Extern> {
+        let data = &store[self.0];
+        let instance = store.instance(data.id);
+        let (i, _, _) = instance.module().exports.get_full(name)?;
+        self._get_export_by_index(store, i)
+    }
+
+    /// Looks up an exported [`Extern`] value by its index in the exports of
+    /// this instance's module.
+    ///
+    /// The `index` is typically obtained from
+    /// [`Module::get_export_index`](crate::Module::get_export_index) with the
+    /// module this instance was created from, and avoids looking up the
+    /// export's name on each access. Note that an index obtained from a
+    /// different module may refer to an unrelated export of this instance.
+    ///
+    /// Returns `None` if `index` is out of bounds.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `store` does not own this instance.
+    pub fn get_export_by_index(
+        &self,
+        mut store: impl AsContextMut,
+        index: usize,
+    ) -> Option<Extern> {
+        self._get_export_by_index(store.as_context_mut().0, index)
+    }
+
+    fn _get_export_by_index(&self, store: &mut StoreOpaque, i: usize) -> Option<Extern> {
         // Instantiated instances will lazily fill in exports, so we process
         // all that lazy logic here.
         let data = &store[self.0];
-
-        let instance = store.instance(data.id);
-        let (i, _, &index) = instance.module().exports.get_full(name)?;
-        if let Some(export) = &data.exports[i] {
+        if let Some(export) = data.exports.get(i)? {
             return Some(export.clone());
         }
 
         let id = data.id;
+        let instance = store.instance(id);
+        let (_, &index) = instance.module().exports.get_index(i)?;
         let instance = store.instance_mut(id); // reborrow the &mut Instancehandle
         let item =
             unsafe { Extern::from_wasmtime_export(instance.get_export_by_index(index), store) };
@@ -430,6 +457,53 @@ impl Instance {
         Some(item)
     }
 
+    /// Captures the current state of this instance as a new WebAssembly
+    /// module.
+    ///
+    /// This is intended for guests which spend a long time initializing
+    /// themselves, for example in their start function, before they're ready
+    /// to serve requests. Instantiating the returned module yields an
+    /// instance in the same state as this one, without running the
+    /// initialization again:
+    ///
+    /// * The start function of the module is removed.
+    /// * Globals defined by the module are initialized with their current
+    ///   values.
+    /// * Memories and tables defined by the module start out with their
+    ///   current size and contents.
+    ///
+    /// The `wasm` provided must be the module this instance was created from,
+    /// in the same format accepted by [`Module::new`], since compiled modules
+    /// don't retain their original binary. The returned binary can be
+    /// compiled with [`Module::new`] as usual. Its memory contents are
+    /// provided by data segments at constant offsets, so with
+    /// [`Config::memory_init_cow`](crate::Config::memory_init_cow) enabled
+    /// instantiating it maps the snapshot's memory rather than copying it,
+    /// and pages are only copied once they're written to.
+    ///
+    /// Imported memories, tables, and globals are not part of the snapshot,
+    /// and instances of the returned module must be given imports to the same
+    /// effect. Host state, such as the data in the store, isn't captured
+    /// either.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if `wasm` isn't the module of this instance, or if the
+    /// state of this instance can't be expressed by a module: globals and
+    /// tables may only contain null `externref` values, and function
+    /// references must refer to functions of this instance.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `store` does not own this instance.
+    pub fn snapshot(&self, mut store: impl AsContextMut, wasm: &[u8]) -> Result<Vec<u8>> {
+        #[cfg(feature = "wat")]
+        let wasm = &wat::parse_bytes(wasm)?;
+        let store = store.as_context_mut().0;
+        let id = store[self.0].id;
+        crate::snapshot::snapshot(store.instance_mut(id), wasm)
+    }
+
     /// Looks up an exported [`Func`] value by name.
     ///
     /// Returns `None` if there was no export named `name`, or if there was but
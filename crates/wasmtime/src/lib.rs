@@ -405,8 +405,10 @@ mod limits;
 mod linker;
 mod memory;
 mod module;
+mod profiling;
 mod r#ref;
 mod signatures;
+mod snapshot;
 mod store;
 mod trampoline;
 mod trap;
@@ -421,11 +423,15 @@ pub use crate::instance::{Instance, InstancePre};
 pub use crate::limits::*;
 pub use crate::linker::*;
 pub use crate::memory::*;
-pub use crate::module::{FrameInfo, FrameSymbol, Module};
+pub use crate::module::{CompileEvent, CompilePhase, FrameInfo, FrameSymbol, Module};
+pub use crate::profiling::FuncSamples;
 pub use crate::r#ref::ExternRef;
 #[cfg(feature = "async")]
 pub use crate::store::CallHookHandler;
-pub use crate::store::{AsContext, AsContextMut, CallHook, Store, StoreContext, StoreContextMut};
+pub use crate::store::{
+    AsContext, AsContextMut, CallHook, DeadlineAction, FuelAction, GcStats, Store, StoreContext,
+    StoreContextMut,
+};
 pub use crate::trap::*;
 pub use crate::types::*;
 pub use crate::values::*;
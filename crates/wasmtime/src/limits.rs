@@ -243,3 +243,65 @@ impl ResourceLimiter for StoreLimits {
         self.memories
     }
 }
+
+/// A snapshot of the resources allocated within a [`Store`](crate::Store).
+///
+/// This is returned by [`Store::resource_usage`](crate::Store::resource_usage)
+/// and is computed from the store's instances when requested, so it reflects
+/// what is actually allocated rather than what a [`ResourceLimiter`] has
+/// approved.
+#[derive(Debug, Default, Clone, Copy)]
+pub struct ResourceUsage {
+    pub(crate) instances: usize,
+    pub(crate) memories: usize,
+    pub(crate) tables: usize,
+    pub(crate) memory_bytes_committed: usize,
+    pub(crate) memory_bytes_reserved: usize,
+    pub(crate) table_elements: usize,
+}
+
+impl ResourceUsage {
+    /// Returns the number of module instances created within the store,
+    /// which is the count limited by [`ResourceLimiter::instances`].
+    pub fn instances(&self) -> usize {
+        self.instances
+    }
+
+    /// Returns the number of linear memories in the store, including those
+    /// created by the host with [`Memory::new`](crate::Memory::new).
+    pub fn memories(&self) -> usize {
+        self.memories
+    }
+
+    /// Returns the number of tables in the store, including those created by
+    /// the host with [`Table::new`](crate::Table::new).
+    pub fn tables(&self) -> usize {
+        self.tables
+    }
+
+    /// Returns the total size, in bytes, of all linear memories in the store.
+    ///
+    /// This is the memory that is accessible to WebAssembly and is backed by
+    /// physical memory once touched.
+    pub fn memory_bytes_committed(&self) -> usize {
+        self.memory_bytes_committed
+    }
+
+    /// Returns the total address space, in bytes, reserved for the linear
+    /// memories in the store.
+    ///
+    /// This includes space reserved for future growth and guard regions, and
+    /// is typically much larger than
+    /// [`memory_bytes_committed`](ResourceUsage::memory_bytes_committed).
+    /// Memories provided by a custom
+    /// [`MemoryCreator`](crate::MemoryCreator) only report their accessible
+    /// size.
+    pub fn memory_bytes_reserved(&self) -> usize {
+        self.memory_bytes_reserved
+    }
+
+    /// Returns the total number of elements of all tables in the store.
+    pub fn table_elements(&self) -> usize {
+        self.table_elements
+    }
+}
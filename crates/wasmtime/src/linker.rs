@@ -237,6 +237,19 @@ impl<T> Linker<T> {
         self
     }
 
+    /// Reserves capacity for at least `additional` more definitions in this
+    /// [`Linker`].
+    ///
+    /// This is useful when defining a large number of items at once, such as
+    /// the host functions of an embedding, to avoid repeatedly growing the
+    /// linker's internal maps.
+    pub fn reserve(&mut self, additional: usize) -> &mut Self {
+        self.map.reserve(additional);
+        self.strings.reserve(additional);
+        self.string2idx.reserve(additional);
+        self
+    }
+
     /// Defines a new item in this [`Linker`].
     ///
     /// This method will add a new definition, by name, to this instance of
@@ -3,6 +3,7 @@ use crate::trampoline::generate_memory_export;
 use crate::{AsContext, AsContextMut, MemoryType, StoreContext, StoreContextMut};
 use anyhow::{bail, Result};
 use std::convert::TryFrom;
+use std::io::{IoSlice, IoSliceMut};
 use std::slice;
 
 /// Error for out of bounds [`Memory`] access.
@@ -21,6 +22,13 @@ impl std::fmt::Display for MemoryAccessError {
 
 impl std::error::Error for MemoryAccessError {}
 
+/// Returns the total length of a sequence of buffers, or an error if the total
+/// can't possibly fit in memory.
+fn vectored_len(lens: impl Iterator<Item = usize>) -> Result<usize, MemoryAccessError> {
+    lens.fold(Some(0usize), |total, len| total?.checked_add(len))
+        .ok_or(MemoryAccessError { _private: () })
+}
+
 /// A WebAssembly linear memory.
 ///
 /// WebAssembly memories represent a contiguous array of bytes that have a size
@@ -339,6 +347,78 @@ impl Memory {
         Ok(())
     }
 
+    /// Safely reads memory contents starting at the given offset into a
+    /// sequence of buffers.
+    ///
+    /// The buffers are filled in order from consecutive regions of memory, so
+    /// this is equivalent to a [`Memory::read`] for each buffer at
+    /// successively increasing offsets, but with a single bounds check for
+    /// the whole range.
+    ///
+    /// If `offset` plus the total length of `buffers` exceeds the current
+    /// memory capacity, then the buffers are left untouched and a
+    /// [`MemoryAccessError`] is returned.
+    ///
+    /// # Panics
+    ///
+    /// Panics if this memory doesn't belong to `store`.
+    pub fn read_vectored(
+        &self,
+        store: impl AsContext,
+        offset: usize,
+        buffers: &mut [IoSliceMut<'_>],
+    ) -> Result<(), MemoryAccessError> {
+        let store = store.as_context();
+        let len = vectored_len(buffers.iter().map(|b| b.len()))?;
+        let mut slice = self
+            .data(&store)
+            .get(offset..)
+            .and_then(|s| s.get(..len))
+            .ok_or(MemoryAccessError { _private: () })?;
+        for buffer in buffers {
+            let (head, rest) = slice.split_at(buffer.len());
+            buffer.copy_from_slice(head);
+            slice = rest;
+        }
+        Ok(())
+    }
+
+    /// Safely writes the contents of a sequence of buffers to this memory
+    /// starting at the given offset.
+    ///
+    /// The buffers are written in order to consecutive regions of memory, so
+    /// this is equivalent to a [`Memory::write`] for each buffer at
+    /// successively increasing offsets, but with a single bounds check for
+    /// the whole range.
+    ///
+    /// If `offset` plus the total length of `buffers` exceeds the current
+    /// memory capacity, then none of the buffers are written to memory and a
+    /// [`MemoryAccessError`] is returned.
+    ///
+    /// # Panics
+    ///
+    /// Panics if this memory doesn't belong to `store`.
+    pub fn write_vectored(
+        &self,
+        mut store: impl AsContextMut,
+        offset: usize,
+        buffers: &[IoSlice<'_>],
+    ) -> Result<(), MemoryAccessError> {
+        let mut context = store.as_context_mut();
+        let len = vectored_len(buffers.iter().map(|b| b.len()))?;
+        let mut slice = self
+            .data_mut(&mut context)
+            .get_mut(offset..)
+            .and_then(|s| s.get_mut(..len))
+            .ok_or(MemoryAccessError { _private: () })?;
+        for buffer in buffers {
+            let (head, rest) = std::mem::take(&mut slice).split_at_mut(buffer.len());
+            head.copy_from_slice(buffer);
+            slice = rest;
+        }
+        Ok(())
+    }
+
     /// Returns this memory as a native Rust slice.
     ///
     /// Note that this method will consider the entire store context provided as
@@ -533,6 +613,55 @@ impl Memory {
         );
         store.on_fiber(|store| self.grow(store, delta)).await?
     }
+
+    /// Zeroes `len` bytes of this memory starting at `offset`, releasing the
+    /// physical memory backing them back to the operating system.
+    ///
+    /// Memories never shrink, so an instance which once touched a lot of
+    /// memory otherwise keeps all of it committed for as long as it lives.
+    /// This can be used by embedders that know a region of memory isn't
+    /// needed anymore, for example the free space of a guest's allocator, to
+    /// shrink the instance back to its working set without dropping it. The
+    /// size of the memory is unchanged and released pages read as zero, being
+    /// committed again on demand when they're next accessed.
+    ///
+    /// Only pages wholly within the range are released, the bytes of pages at
+    /// either end of the range which are only partially covered are zeroed in
+    /// place. Memories created by a custom
+    /// [`MemoryCreator`](crate::MemoryCreator) are always zeroed in place.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the range is out of bounds of this memory, in which
+    /// case nothing is zeroed, or if the operating system fails to release
+    /// the pages.
+    ///
+    /// # Panics
+    ///
+    /// Panics if this memory doesn't belong to `store`.
+    pub fn decommit(&self, mut store: impl AsContextMut, offset: usize, len: usize) -> Result<()> {
+        let store = store.as_context_mut().0;
+        let end = offset
+            .checked_add(len)
+            .filter(|end| *end <= self.internal_data_size(store))
+            .ok_or(MemoryAccessError { _private: () })?;
+        let mem = self.wasmtime_memory(store);
+        unsafe { (*mem).decommit(offset..end) }
+    }
+
+    /// Zeroes all of this memory, releasing the physical memory backing it
+    /// back to the operating system.
+    ///
+    /// This is the same as calling [`Memory::decommit`] with the whole
+    /// current size of the memory.
+    ///
+    /// # Panics
+    ///
+    /// Panics if this memory doesn't belong to `store`.
+    pub fn reset(&self, mut store: impl AsContextMut) -> Result<()> {
+        let size = self.data_size(&store);
+        self.decommit(&mut store, 0, size)
+    }
     fn wasmtime_memory(&self, store: &mut StoreOpaque) -> *mut wasmtime_runtime::Memory {
         unsafe {
             let export = &store[self.0];
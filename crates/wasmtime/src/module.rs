@@ -9,6 +9,7 @@ use std::fs;
 use std::mem;
 use std::ops::Range;
 use std::path::Path;
+use std::sync::atomic::{AtomicUsize, Ordering};
 use std::sync::Arc;
 use wasmparser::{Parser, ValidPayload, Validator};
 use wasmtime_environ::{
@@ -22,6 +23,7 @@ use wasmtime_runtime::{
 
 mod registry;
 mod serialization;
+mod shared_code;
 
 pub use registry::{FrameInfo, FrameSymbol, GlobalModuleRegistry, ModuleRegistry};
 pub use serialization::SerializedModule;
@@ -293,25 +295,127 @@ impl Module {
     #[cfg(compiler)]
     #[cfg_attr(nightlydoc, doc(cfg(feature = "cranelift")))] // see build.rs
     pub fn from_binary(engine: &Engine, binary: &[u8]) -> Result<Module> {
+        Self::from_binary_impl(engine, engine.compiler(), binary, Default::default())
+    }
+
+    /// Same as [`Module::from_binary`], except that `progress` is invoked as
+    /// compilation of the module proceeds.
+    ///
+    /// The `progress` callback is invoked once for each function in the module
+    /// after it has finished compiling, with the number of functions compiled
+    /// so far and the total number of functions to compile, in that order.
+    /// Note that with [`Config::parallel_compilation`](crate::Config::parallel_compilation)
+    /// enabled functions are compiled on multiple threads, so `progress` may be
+    /// invoked concurrently from several threads and invocations may observe
+    /// the count of completed functions out of order.
+    ///
+    /// If the compiled module is found in the compilation cache then no
+    /// functions need to be compiled and `progress` is not invoked.
+    #[cfg(compiler)]
+    #[cfg_attr(nightlydoc, doc(cfg(feature = "cranelift")))] // see build.rs
+    pub fn from_binary_with_progress(
+        engine: &Engine,
+        binary: &[u8],
+        progress: impl Fn(usize, usize) + Send + Sync,
+    ) -> Result<Module> {
+        let observer = CompileObserver {
+            progress: Some(&progress),
+            ..Default::default()
+        };
+        Self::from_binary_impl(engine, engine.compiler(), binary, observer)
+    }
+
+    /// Same as [`Module::from_binary`], except that `on_event` is informed as
+    /// each phase of compilation starts and finishes.
+    ///
+    /// This is intended for profiling compilation, for example to measure how
+    /// much time or how many hardware events each [`CompilePhase`] accounts
+    /// for. Events are reported on the calling thread in the order the phases
+    /// are listed in [`CompilePhase`]. A phase
+    /// which fails has a [`CompileEvent::Start`] without a matching
+    /// [`CompileEvent::End`].
+    ///
+    /// When a compilation cache is configured, either [`CompileEvent::CacheHit`]
+    /// or [`CompileEvent::CacheMiss`] is also reported. On a cache hit only the
+    /// [`CompilePhase::Publish`] phase happens.
+    #[cfg(compiler)]
+    #[cfg_attr(nightlydoc, doc(cfg(feature = "cranelift")))] // see build.rs
+    pub fn from_binary_with_events(
+        engine: &Engine,
+        binary: &[u8],
+        on_event: impl Fn(CompileEvent),
+    ) -> Result<Module> {
+        let observer = CompileObserver {
+            events: Some(&on_event),
+            ..Default::default()
+        };
+        Self::from_binary_impl(engine, engine.compiler(), binary, observer)
+    }
+
+    /// Same as [`Module::from_binary`], except that the module is compiled at
+    /// the optimization level configured with
+    /// [`Config::cranelift_tier_up_opt_level`](crate::Config::cranelift_tier_up_opt_level)
+    /// rather than [`Config::cranelift_opt_level`](crate::Config::cranelift_opt_level).
+    ///
+    /// This is intended for tiered compilation: an engine configured with
+    /// `OptLevel::None` can compile a module quickly with [`Module::new`] to
+    /// start executing it immediately, and then use this function on a
+    /// background thread to compile an optimized version of the same module.
+    /// Once that finishes, the optimized module can be used for all future
+    /// instantiations. Existing instances continue running the code they were
+    /// instantiated with. Both modules belong to `engine` and can be used
+    /// with any of its stores, and they can be linked together.
+    ///
+    /// Note that serializing a module created with this function produces an
+    /// artifact that can only be deserialized with an engine that has the same
+    /// configuration as `engine`, just like any other module.
+    #[cfg(compiler)]
+    #[cfg_attr(nightlydoc, doc(cfg(feature = "cranelift")))] // see build.rs
+    pub fn from_binary_tier_up(engine: &Engine, binary: &[u8]) -> Result<Module> {
+        Self::from_binary_impl(
+            engine,
+            engine.tier_up_compiler()?,
+            binary,
+            Default::default(),
+        )
+    }
+
+    #[cfg(compiler)]
+    fn from_binary_impl(
+        engine: &Engine,
+        compiler: &dyn wasmtime_environ::Compiler,
+        binary: &[u8],
+        #[allow(unused_mut)] mut observer: CompileObserver<'_>,
+    ) -> Result<Module> {
         engine
             .check_compatible_with_native_host()
             .context("compilation settings are not compatible with the native host")?;
 
         cfg_if::cfg_if! {
             if #[cfg(feature = "cache")] {
-                let state = (HashedEngineCompileEnv(engine), binary);
-                let (mmap, info, types) = wasmtime_cache::ModuleCacheEntry::new(
-                    "wasmtime",
-                    engine.cache_config(),
-                )
-                .get_data_raw(
+                let entry = match &engine.config().cache_store {
+                    Some(store) => wasmtime_cache::ModuleCacheEntry::with_store("wasmtime", &**store),
+                    None => wasmtime_cache::ModuleCacheEntry::new("wasmtime", engine.cache_config()),
+                };
+                observer.cache_enabled = entry.is_enabled();
+                let state = (
+                    HashedEngineCompileEnv(engine, compiler),
+                    binary,
+                    observer,
+                );
+                let (mmap, info, types) = entry.get_data_raw(
                     &state,
 
                     // Cache miss, compute the actual artifacts
-                    |(engine, wasm)| Module::build_artifacts(engine.0, wasm),
+                    |(engine, wasm, observer)| {
+                        if observer.cache_enabled {
+                            observer.event(CompileEvent::CacheMiss);
+                        }
+                        Module::build_artifacts(engine.0, engine.1, wasm, *observer)
+                    },
 
                     // Implementation of how to serialize artifacts
-                    |(engine, _wasm), (mmap, _info, types)| {
+                    |(engine, _wasm, _observer), (mmap, _info, types)| {
                         SerializedModule::from_artifacts(
                             engine.0,
                             mmap,
@@ -320,19 +424,24 @@ impl Module {
                     },
 
                     // Cache hit, deserialize the provided artifacts
-                    |(engine, _wasm), serialized_bytes| {
-                        SerializedModule::from_bytes(&serialized_bytes, &engine.0.config().module_version)
+                    |(engine, _wasm, observer), serialized_bytes| {
+                        let parts = SerializedModule::from_bytes(&serialized_bytes, &engine.0.config().module_version)
                             .ok()?
                             .into_parts(engine.0)
-                            .ok()
+                            .ok()?;
+                        observer.event(CompileEvent::CacheHit);
+                        Some(parts)
                     },
                 )?;
             } else {
-                let (mmap, info, types) = Module::build_artifacts(engine, binary)?;
+                let (mmap, info, types) = Module::build_artifacts(engine, compiler, binary, observer)?;
             }
         };
 
-        Self::from_parts(engine, mmap, info, Arc::new(types))
+        observer.event(CompileEvent::Start(CompilePhase::Publish));
+        let module = Self::from_parts(engine, mmap, info, Arc::new(types))?;
+        observer.event(CompileEvent::End(CompilePhase::Publish));
+        Ok(module)
     }
 
     /// Converts an input binary-encoded WebAssembly module to compilation
@@ -355,37 +464,47 @@ impl Module {
     #[cfg(compiler)]
     pub(crate) fn build_artifacts(
         engine: &Engine,
+        compiler: &dyn wasmtime_environ::Compiler,
         wasm: &[u8],
+        observer: CompileObserver<'_>,
     ) -> Result<(MmapVec, Option<CompiledModuleInfo>, TypeTables)> {
         let tunables = &engine.config().tunables;
+        let progress = observer.progress;
 
         // First a `ModuleEnvironment` is created which records type information
         // about the wasm module. This is where the WebAssembly is parsed and
         // validated. Afterwards `types` will have all the type information for
         // this module.
+        observer.event(CompileEvent::Start(CompilePhase::Translate));
         let (mut translation, types) = ModuleEnvironment::new(tunables, &engine.config().features)
             .translate(wasm)
             .context("failed to parse WebAssembly module")?;
+        observer.event(CompileEvent::End(CompilePhase::Translate));
 
         // Next compile all functions in parallel using rayon. This will perform
         // the actual validation of all the function bodies.
         let functions = mem::take(&mut translation.function_body_inputs);
         let functions = functions.into_iter().collect::<Vec<_>>();
+        let total = functions.len();
+        let completed = AtomicUsize::new(0);
+        observer.event(CompileEvent::Start(CompilePhase::Codegen));
         let funcs = engine
             .run_maybe_parallel(functions, |(index, func)| {
-                engine
-                    .compiler()
-                    .compile_function(&translation, index, func, tunables, &types)
+                let result = compiler.compile_function(&translation, index, func, tunables, &types);
+                if let (Ok(_), Some(progress)) = (&result, progress) {
+                    progress(completed.fetch_add(1, Ordering::Relaxed) + 1, total);
+                }
+                result
             })?
             .into_iter()
             .collect();
+        observer.event(CompileEvent::End(CompilePhase::Codegen));
 
         // Collect all the function results into a final ELF object.
-        let mut obj = engine.compiler().object()?;
+        observer.event(CompileEvent::Start(CompilePhase::Link));
+        let mut obj = compiler.object()?;
         let (funcs, trampolines) =
-            engine
-                .compiler()
-                .emit_obj(&translation, &types, funcs, tunables, &mut obj)?;
+            compiler.emit_obj(&translation, &types, funcs, tunables, &mut obj)?;
 
         // If configured, attempt to use paged memory initialization
         // instead of the default mode of memory initialization
@@ -398,7 +517,7 @@ impl Module {
         // initialize memory or otherwise enabling virtual-memory-tricks
         // such as mmap'ing from a file to get copy-on-write.
         if engine.config().memory_init_cow {
-            let align = engine.compiler().page_size_align();
+            let align = compiler.page_size_align();
             let max_always_allowed = engine.config().memory_guaranteed_dense_image_size;
             translation.try_static_init(align, max_always_allowed);
         }
@@ -410,6 +529,7 @@ impl Module {
 
         let (mmap, info) =
             wasmtime_jit::finish_compile(translation, obj, funcs, trampolines, tunables)?;
+        observer.event(CompileEvent::End(CompilePhase::Link));
 
         Ok((mmap, Some(info), types))
     }
@@ -484,6 +604,10 @@ impl Module {
     /// This is because the file is mapped into memory and lazily loaded pages
     /// reflect the current state of the file, not necessarily the origianl
     /// state of the file.
+    ///
+    /// Files loaded with this function may share their compiled code with
+    /// other engines in the process, see
+    /// [`Config::share_deserialized_code`](crate::Config::share_deserialized_code).
     pub unsafe fn deserialize_file(engine: &Engine, path: impl AsRef<Path>) -> Result<Module> {
         let module = SerializedModule::from_file(path.as_ref(), &engine.config().module_version)?;
         module.into_module(engine)
@@ -495,12 +619,25 @@ impl Module {
         info: Option<CompiledModuleInfo>,
         types: Arc<TypeTables>,
     ) -> Result<Self> {
-        let module = CompiledModule::from_artifacts(
-            mmap,
-            info,
-            &*engine.config().profiler,
-            engine.unique_id_allocator(),
-        )?;
+        let config = engine.config();
+        let create = |mmap| {
+            CompiledModule::from_artifacts(
+                mmap,
+                info,
+                &*config.profiler,
+                engine.unique_id_allocator(),
+                config.lazy_debug_registration,
+            )
+        };
+        let shared_key = if config.share_deserialized_code {
+            shared_code::SharedCodeKey::new(&mmap, config.lazy_debug_registration)
+        } else {
+            None
+        };
+        let module = match shared_key {
+            Some(key) => key.get_or_insert(|| create(mmap))?,
+            None => create(mmap)?,
+        };
 
         // Validate the module can be used with the current allocator
         engine.allocator().validate(module.module())?;
@@ -570,6 +707,31 @@ impl Module {
         SerializedModule::new(self).to_bytes(&self.inner.engine.config().module_version)
     }
 
+    /// Serializes this module into `writer`.
+    ///
+    /// This produces the same bytes as [`Module::serialize`], but rather than
+    /// assembling a copy of the whole artifact in memory first, the compiled
+    /// code is written to `writer` straight from where it's loaded. This is
+    /// useful to stream large modules into a file or other storage without
+    /// holding extra copies of them.
+    #[cfg(compiler)]
+    #[cfg_attr(nightlydoc, doc(cfg(feature = "cranelift")))] // see build.rs
+    pub fn serialize_to(&self, mut writer: impl std::io::Write) -> Result<()> {
+        SerializedModule::new(self)
+            .to_writer(&mut writer, &self.inner.engine.config().module_version)
+    }
+
+    /// Returns the number of bytes that [`Module::serialize`] and
+    /// [`Module::serialize_to`] produce for this module.
+    ///
+    /// This can be used to preallocate a buffer, or a file, to serialize the
+    /// module into.
+    #[cfg(compiler)]
+    #[cfg_attr(nightlydoc, doc(cfg(feature = "cranelift")))] // see build.rs
+    pub fn serialized_size(&self) -> Result<usize> {
+        SerializedModule::new(self).serialized_size(&self.inner.engine.config().module_version)
+    }
+
     pub(crate) fn compiled_module(&self) -> &Arc<CompiledModule> {
         &self.inner.module
     }
@@ -791,6 +953,23 @@ impl Module {
         ))
     }
 
+    /// Returns the index of the export named `name` in this module, if any.
+    ///
+    /// The index is the position of the export in [`Module::exports`], and
+    /// can be passed to [`Instance::get_export_by_index`] or
+    /// [`Caller::get_export_by_index`] with instances of this module. Those
+    /// lookups are plain array accesses, so embeddings which look up the
+    /// same export repeatedly can resolve its name once per module instead
+    /// of on every access.
+    ///
+    /// [`Instance::get_export_by_index`]: crate::Instance::get_export_by_index
+    /// [`Caller::get_export_by_index`]: crate::Caller::get_export_by_index
+    pub fn get_export_index(&self, name: &str) -> Option<usize> {
+        let module = self.compiled_module().module();
+        let (index, _, _) = module.exports.get_full(name)?;
+        Some(index)
+    }
+
     /// Returns the [`Engine`] that this [`Module`] was compiled by.
     pub fn engine(&self) -> &Engine {
         &self.inner.engine
@@ -821,6 +1000,54 @@ impl Module {
     pub fn image_range(&self) -> Range<usize> {
         self.compiled_module().image_range()
     }
+
+    /// Registers this module's native debug information with debuggers if it
+    /// hasn't been registered already.
+    ///
+    /// This is only necessary when the engine is configured with
+    /// [`Config::lazy_debug_registration`](crate::Config::lazy_debug_registration),
+    /// and does nothing if the module was compiled without
+    /// [`Config::debug_info`](crate::Config::debug_info) enabled.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the debug image for this module couldn't be
+    /// created.
+    pub fn register_debug_info(&self) -> Result<()> {
+        self.compiled_module().register_debug_image()
+    }
+
+    /// Returns whether instances of this module will have their linear
+    /// memories initialized with copy-on-write memory images.
+    ///
+    /// When this returns `true` instantiation maps the module's initial heap
+    /// contents into linear memory instead of copying data segments, as
+    /// described in [`Config::memory_init_cow`]. A `false` return value means
+    /// that data segments are copied eagerly, either because the feature is
+    /// disabled or because this module doesn't meet its criteria.
+    ///
+    /// Memory images are otherwise created lazily on first instantiation, so
+    /// calling this method creates them if that hasn't happened yet.
+    ///
+    /// # Errors
+    ///
+    /// This method fails if the memory images could not be created, for
+    /// example if `memfd_create` failed. Instantiation would fail with the same
+    /// error.
+    ///
+    /// [`Config::memory_init_cow`]: crate::Config::memory_init_cow
+    pub fn has_memory_image(&self) -> Result<bool> {
+        Ok(self.inner.memory_images()?.is_some())
+    }
+}
+
+impl ModuleInner {
+    fn memory_images(&self) -> Result<Option<&ModuleMemoryImages>> {
+        let images = self
+            .memory_images
+            .get_or_try_init(|| memory_images(&self.engine, &self.module))?;
+        Ok(images.as_ref())
+    }
 }
 
 fn _assert_send_sync() {
@@ -835,13 +1062,13 @@ fn _assert_send_sync() {
 /// cache and dictates whether artifacts are reused. Consequently the contents
 /// of this hash dictate when artifacts are or aren't re-used.
 #[cfg(all(feature = "cache", compiler))]
-struct HashedEngineCompileEnv<'a>(&'a Engine);
+struct HashedEngineCompileEnv<'a>(&'a Engine, &'a dyn wasmtime_environ::Compiler);
 
 #[cfg(all(feature = "cache", compiler))]
 impl std::hash::Hash for HashedEngineCompileEnv<'_> {
     fn hash<H: std::hash::Hasher>(&self, hasher: &mut H) {
         // Hash the compiler's state based on its target and configuration.
-        let compiler = self.0.compiler();
+        let compiler = self.1;
         compiler.triple().hash(hasher);
         compiler.flags().hash(hasher);
         compiler.isa_flags().hash(hasher);
@@ -856,6 +1083,68 @@ impl std::hash::Hash for HashedEngineCompileEnv<'_> {
     }
 }
 
+/// A phase of compiling a module, as reported by
+/// [`Module::from_binary_with_events`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+#[non_exhaustive]
+pub enum CompilePhase {
+    /// Parsing and validating the module, except for function bodies.
+    Translate,
+    /// Validating and compiling function bodies to machine code. With
+    /// [`Config::parallel_compilation`](crate::Config::parallel_compilation)
+    /// enabled, functions are compiled on multiple threads during this phase.
+    Codegen,
+    /// Linking the compiled functions, along with trampolines and metadata,
+    /// into an in-memory object.
+    Link,
+    /// Copying the object's code into executable memory and registering it
+    /// with the engine.
+    Publish,
+}
+
+/// An event reported while compiling a module with
+/// [`Module::from_binary_with_events`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum CompileEvent {
+    /// A phase of compilation is starting.
+    Start(CompilePhase),
+    /// A phase of compilation has finished successfully.
+    End(CompilePhase),
+    /// The module was found in the compilation cache, so it doesn't need to
+    /// be compiled.
+    CacheHit,
+    /// The module wasn't found in the compilation cache and is compiled.
+    CacheMiss,
+}
+
+/// Optional callbacks invoked during compilation, threaded through the cache's
+/// state to the compilation function.
+///
+/// The callbacks have no influence on the compiled artifacts so they
+/// deliberately don't contribute to the cache key.
+#[cfg(compiler)]
+#[derive(Default, Clone, Copy)]
+pub(crate) struct CompileObserver<'a> {
+    progress: Option<&'a (dyn Fn(usize, usize) + Sync)>,
+    events: Option<&'a dyn Fn(CompileEvent)>,
+    #[cfg(feature = "cache")]
+    cache_enabled: bool,
+}
+
+#[cfg(compiler)]
+impl CompileObserver<'_> {
+    fn event(&self, event: CompileEvent) {
+        if let Some(events) = self.events {
+            events(event);
+        }
+    }
+}
+
+#[cfg(all(feature = "cache", compiler))]
+impl std::hash::Hash for CompileObserver<'_> {
+    fn hash<H: std::hash::Hasher>(&self, _hasher: &mut H) {}
+}
+
 impl wasmtime_runtime::ModuleRuntimeInfo for ModuleInner {
     fn module(&self) -> &Arc<wasmtime_environ::Module> {
         self.module.module()
@@ -874,11 +1163,8 @@ impl wasmtime_runtime::ModuleRuntimeInfo for ModuleInner {
     }
 
     fn memory_image(&self, memory: DefinedMemoryIndex) -> Result<Option<&Arc<MemoryImage>>> {
-        let images = self
-            .memory_images
-            .get_or_try_init(|| memory_images(&self.engine, &self.module))?;
-        Ok(images
-            .as_ref()
+        Ok(self
+            .memory_images()?
             .and_then(|images| images.get_memory_image(memory)))
     }
 
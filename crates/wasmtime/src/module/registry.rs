@@ -2,15 +2,17 @@
 
 use crate::{signatures::SignatureCollection, Module};
 use std::{
-    collections::BTreeMap,
-    sync::{Arc, RwLock},
+    collections::{btree_map::Entry, BTreeMap},
+    ptr,
+    sync::atomic::{AtomicPtr, AtomicUsize, Ordering::SeqCst},
+    sync::{Arc, Mutex},
 };
 use wasmtime_environ::{EntityRef, FilePos, StackMap, TrapCode};
 use wasmtime_jit::CompiledModule;
 use wasmtime_runtime::{ModuleInfo, VMCallerCheckedAnyfunc, VMTrampoline};
 
 lazy_static::lazy_static! {
-    static ref GLOBAL_MODULES: RwLock<GlobalModuleRegistry> = Default::default();
+    static ref GLOBAL_MODULES: GlobalModules = GlobalModules::default();
 }
 
 /// Used for registering modules with a store.
@@ -90,7 +92,7 @@ impl ModuleRegistry {
         );
         assert!(prev.is_none());
 
-        GLOBAL_MODULES.write().unwrap().register(start, end, module);
+        GLOBAL_MODULES.register(start, end, module);
     }
 
     /// Looks up a trampoline from an anyfunc.
@@ -102,10 +104,7 @@ impl ModuleRegistry {
 
 impl Drop for ModuleRegistry {
     fn drop(&mut self) {
-        let mut info = GLOBAL_MODULES.write().unwrap();
-        for end in self.modules_with_code.keys() {
-            info.unregister(*end);
-        }
+        GLOBAL_MODULES.unregister(self.modules_with_code.keys().copied());
     }
 }
 
@@ -146,11 +145,6 @@ struct GlobalRegisteredModule {
     start: usize,
     module: Arc<CompiledModule>,
     wasm_backtrace_details_env_used: bool,
-    /// Note that modules can be instantiated in many stores, so the purpose of
-    /// this field is to keep track of how many stores have registered a
-    /// module. Information is only removed from the global registry when this
-    /// reference count reaches 0.
-    references: usize,
 }
 
 /// This is the global module registry that stores information for all modules
@@ -166,28 +160,31 @@ struct GlobalRegisteredModule {
 /// it is also automatically registered with the singleton global module
 /// registry. When a `ModuleRegistry` is destroyed then all of its entries
 /// are removed from the global module registry.
+///
+/// Each `GlobalModuleRegistry` is an immutable snapshot, sorted by the ending
+/// address of each module's code. See `GlobalModules` for how snapshots are
+/// replaced.
 #[derive(Default)]
-pub struct GlobalModuleRegistry(BTreeMap<usize, GlobalRegisteredModule>);
+pub struct GlobalModuleRegistry(Vec<(usize, Arc<GlobalRegisteredModule>)>);
 
 impl GlobalModuleRegistry {
     /// Returns whether the `pc`, according to globally registered information,
     /// is a wasm trap or not.
     pub(crate) fn is_wasm_trap_pc(pc: usize) -> bool {
-        let modules = GLOBAL_MODULES.read().unwrap();
-
-        match modules.module(pc) {
+        GLOBAL_MODULES.read(|modules| match modules.module(pc) {
             Some((entry, text_offset)) => {
                 wasmtime_environ::lookup_trap_code(entry.module.trap_data(), text_offset).is_some()
             }
             None => false,
-        }
+        })
     }
 
     /// Returns, if found, the corresponding module for the `pc` as well as the
     /// pc transformed to a relative offset within the text section.
     fn module(&self, pc: usize) -> Option<(&GlobalRegisteredModule, usize)> {
-        let (end, info) = self.0.range(pc..).next()?;
-        if pc < info.start || *end < pc {
+        let index = self.0.partition_point(|(end, _)| *end < pc);
+        let (_, info) = self.0.get(index)?;
+        if pc < info.start {
             return None;
         }
         Some((info, pc - info.start))
@@ -195,8 +192,11 @@ impl GlobalModuleRegistry {
 
     // Work with the global instance of `GlobalModuleRegistry`. Note that only
     // shared access is allowed, this isn't intended to mutate the contents.
+    //
+    // Modules can't be registered or unregistered from within `f`, since
+    // that waits for all active calls to this function to finish.
     pub(crate) fn with<R>(f: impl FnOnce(&GlobalModuleRegistry) -> R) -> R {
-        f(&GLOBAL_MODULES.read().unwrap())
+        GLOBAL_MODULES.read(f)
     }
 
     /// Fetches frame information about a program counter in a backtrace.
@@ -218,43 +218,196 @@ impl GlobalModuleRegistry {
         })
     }
 
+    /// Returns the function containing `pc`, if any, identified by the start
+    /// address of its module's text section and its index within the module.
+    ///
+    /// This is cheaper than `lookup_frame_info` and is used to attribute
+    /// profiling samples.
+    pub(crate) fn lookup_func(&self, pc: usize) -> Option<(usize, u32)> {
+        let (module, offset) = self.module(pc)?;
+        let (index, _func_offset) = module.module.func_by_text_offset(offset)?;
+        let index = module.module.module().func_index(index);
+        Some((module.start, index.index() as u32))
+    }
+
     /// Fetches trap information about a program counter in a backtrace.
     pub(crate) fn lookup_trap_code(&self, pc: usize) -> Option<TrapCode> {
         let (module, offset) = self.module(pc)?;
         wasmtime_environ::lookup_trap_code(module.module.trap_data(), offset)
     }
+}
+
+/// Number of counters readers of `GlobalModules` are spread across, to avoid
+/// all threads contending on a single cache line. Must be a power of two.
+const READER_SHARDS: usize = 16;
+
+/// A count of active readers, padded to its own cache line.
+#[derive(Default)]
+#[repr(align(64))]
+struct ReaderCount(AtomicUsize);
+
+/// The process-wide set of registered modules.
+///
+/// Lookups happen on every trap, including from within signal handlers, while
+/// modules are registered and unregistered as stores come and go. To keep
+/// lookups from ever blocking on, or contending with, registration, the
+/// current registrations are published as an immutable `GlobalModuleRegistry`
+/// snapshot in a read-copy-update fashion:
+///
+/// * Readers announce themselves in one of the `readers` counters, load the
+///   current snapshot, and use it without taking any locks.
+/// * Writers serialize on `writer`, publish a new snapshot, and wait for all
+///   readers which may still be using the previous snapshot to finish before
+///   freeing it.
+///
+/// Readers announce themselves in the half of `readers` selected by `epoch`.
+/// A writer flips `epoch` and waits for the other half to drain, twice, which
+/// waits out every reader that started before the new snapshot was published
+/// while allowing new readers to make progress.
+///
+/// Snapshots are only republished when a module's code is registered for the
+/// first time or when its last registration goes away, so instantiating a
+/// module that's already in use by another store doesn't affect readers.
+#[derive(Default)]
+struct GlobalModules {
+    /// The current snapshot, created with `Arc::into_raw`, or null if nothing
+    /// has been published yet.
+    current: AtomicPtr<GlobalModuleRegistry>,
+    epoch: AtomicUsize,
+    readers: [[ReaderCount; READER_SHARDS]; 2],
+    writer: Mutex<BTreeMap<usize, GlobalRegistration>>,
+}
+
+/// An entry in the authoritative map of `GlobalModules`.
+struct GlobalRegistration {
+    module: Arc<GlobalRegisteredModule>,
+    /// Note that modules can be instantiated in many stores, so the purpose of
+    /// this field is to keep track of how many stores have registered a
+    /// module. Information is only removed from the global registry when this
+    /// reference count reaches 0.
+    references: usize,
+}
+
+impl GlobalModules {
+    fn read<R>(&self, f: impl FnOnce(&GlobalModuleRegistry) -> R) -> R {
+        struct Reader<'a>(&'a AtomicUsize);
+
+        impl Drop for Reader<'_> {
+            fn drop(&mut self) {
+                self.0.fetch_sub(1, SeqCst);
+            }
+        }
+
+        let count = &self.readers[self.epoch.load(SeqCst) % 2][reader_shard()].0;
+        count.fetch_add(1, SeqCst);
+        let _reader = Reader(count);
+
+        let current = self.current.load(SeqCst);
+        if current.is_null() {
+            // Creating an empty registry doesn't allocate, so this is fine in
+            // signal handlers.
+            f(&GlobalModuleRegistry::default())
+        } else {
+            // Safety: the snapshot isn't freed until this reader has finished,
+            // see `synchronize`.
+            f(unsafe { &*current })
+        }
+    }
 
     /// Registers a new region of code, described by `(start, end)` and with
     /// the given function information, with the global information.
-    fn register(&mut self, start: usize, end: usize, module: &Module) {
-        let info = self.0.entry(end).or_insert_with(|| GlobalRegisteredModule {
-            start,
-            module: module.compiled_module().clone(),
-            wasm_backtrace_details_env_used: module
-                .engine()
-                .config()
-                .wasm_backtrace_details_env_used,
-            references: 0,
-        });
-
-        // Note that ideally we'd debug_assert that the information previously
-        // stored, if any, matches the `functions` we were given, but for now we
-        // just do some simple checks to hope it's the same.
-        assert_eq!(info.start, start);
-        info.references += 1;
+    fn register(&self, start: usize, end: usize, module: &Module) {
+        let mut modules = self.writer.lock().unwrap();
+        match modules.entry(end) {
+            Entry::Occupied(mut e) => {
+                // Note that ideally we'd debug_assert that the information
+                // previously stored matches the `module` we were given, but
+                // for now we just do some simple checks to hope it's the same.
+                assert_eq!(e.get().module.start, start);
+                e.get_mut().references += 1;
+            }
+            Entry::Vacant(e) => {
+                e.insert(GlobalRegistration {
+                    module: Arc::new(GlobalRegisteredModule {
+                        start,
+                        module: module.compiled_module().clone(),
+                        wasm_backtrace_details_env_used: module
+                            .engine()
+                            .config()
+                            .wasm_backtrace_details_env_used,
+                    }),
+                    references: 1,
+                });
+                self.publish(&modules);
+            }
+        }
     }
 
-    /// Unregisters a region of code (keyed by the `end` address) from the
+    /// Unregisters regions of code (keyed by their `end` addresses) from the
     /// global information.
-    fn unregister(&mut self, end: usize) {
-        let info = self.0.get_mut(&end).unwrap();
-        info.references -= 1;
-        if info.references == 0 {
-            self.0.remove(&end);
+    fn unregister(&self, ends: impl Iterator<Item = usize>) {
+        let mut modules = self.writer.lock().unwrap();
+        let mut removed = false;
+        for end in ends {
+            let info = modules.get_mut(&end).unwrap();
+            info.references -= 1;
+            if info.references == 0 {
+                modules.remove(&end);
+                removed = true;
+            }
+        }
+        if removed {
+            self.publish(&modules);
+        }
+    }
+
+    /// Replaces the current snapshot with one of `modules`, freeing the
+    /// previous snapshot once no reader can be using it anymore.
+    ///
+    /// Must be called with the `writer` lock held.
+    fn publish(&self, modules: &BTreeMap<usize, GlobalRegistration>) {
+        let snapshot = GlobalModuleRegistry(
+            modules
+                .iter()
+                .map(|(end, info)| (*end, info.module.clone()))
+                .collect(),
+        );
+        let new = Arc::into_raw(Arc::new(snapshot)) as *mut GlobalModuleRegistry;
+        let old = self.current.swap(new, SeqCst);
+        self.synchronize();
+        if !old.is_null() {
+            unsafe {
+                drop(Arc::from_raw(old));
+            }
+        }
+    }
+
+    /// Waits for all readers which started before this call to finish.
+    fn synchronize(&self) {
+        for _ in 0..2 {
+            let old = self.epoch.fetch_add(1, SeqCst) % 2;
+            for count in self.readers[old].iter() {
+                while count.0.load(SeqCst) != 0 {
+                    std::thread::yield_now();
+                }
+            }
         }
     }
 }
 
+/// Picks which of the `READER_SHARDS` counters the current thread announces
+/// itself in.
+///
+/// Thread-locals may not be initialized when a signal handler runs, so this
+/// hashes the address of the current stack instead, which differs between
+/// threads.
+fn reader_shard() -> usize {
+    let marker = 0u8;
+    let addr = ptr::addr_of!(marker) as usize;
+    let bits = READER_SHARDS.trailing_zeros();
+    addr.wrapping_mul(0x9e37_79b9_7f4a_7c15_u64 as usize) >> (usize::BITS - bits)
+}
+
 impl GlobalRegisteredModule {
     /// Determines if the related module has unparsed debug information.
     pub fn has_unparsed_debuginfo(&self) -> bool {
@@ -525,3 +678,48 @@ fn test_frame_info() -> Result<(), anyhow::Error> {
     });
     Ok(())
 }
+
+#[test]
+fn test_concurrent_registration() -> Result<(), anyhow::Error> {
+    use crate::*;
+    let engine = Engine::default();
+    let wat = r#"(module (func (export "f") (result i32) i32.const 1))"#;
+    let module = Module::new(&engine, wat)?;
+    let mut store = Store::new(&engine, ());
+    Instance::new(&mut store, &module, &[])?;
+    let (_, alloc) = module
+        .compiled_module()
+        .finished_functions()
+        .next()
+        .unwrap();
+    let pc = unsafe { (*alloc).as_ptr() as usize };
+
+    // Load and drop other modules on a few threads while looking up `pc`,
+    // which must remain registered throughout.
+    let done = Arc::new(std::sync::atomic::AtomicBool::new(false));
+    let threads = (0..4)
+        .map(|_| {
+            let engine = engine.clone();
+            let done = done.clone();
+            std::thread::spawn(move || -> Result<(), anyhow::Error> {
+                while !done.load(SeqCst) {
+                    let module = Module::new(&engine, wat)?;
+                    let mut store = Store::new(&engine, ());
+                    Instance::new(&mut store, &module, &[])?;
+                }
+                Ok(())
+            })
+        })
+        .collect::<Vec<_>>();
+    for _ in 0..1000 {
+        GlobalModuleRegistry::with(|modules| {
+            let (frame, _, _) = modules.lookup_frame_info(pc).unwrap();
+            assert_eq!(frame.func_index(), 0);
+        });
+    }
+    done.store(true, SeqCst);
+    for thread in threads {
+        thread.join().unwrap()?;
+    }
+    Ok(())
+}
@@ -37,7 +37,7 @@
 //! by any parsing of the ELF itself, which provides a convenient location for
 //! the metadata information to go.
 //!
-//! This format is implemented by the `to_bytes` and `from_mmap` function.
+//! This format is implemented by the `to_writer` and `from_mmap` function.
 
 use crate::{Engine, Module, ModuleVersionStrategy};
 use anyhow::{anyhow, bail, Context, Result};
@@ -45,6 +45,7 @@ use object::read::elf::FileHeader;
 use object::Bytes;
 use serde::{Deserialize, Serialize};
 use std::collections::BTreeMap;
+use std::io::Write;
 use std::path::Path;
 use std::str::FromStr;
 use std::sync::Arc;
@@ -205,6 +206,13 @@ impl<'a> SerializedModule<'a> {
     }
 
     pub fn into_module(self, engine: &Engine) -> Result<Module> {
+        // Artifacts are only ever loaded to be run here, so in addition to
+        // matching the engine the engine itself must also be able to run code
+        // on this host. The configured target may be different from the host
+        // when precompiling for another machine.
+        engine
+            .check_compatible_with_native_host()
+            .context("compilation settings are not compatible with the native host")?;
         let (mmap, info, types) = self.into_parts(engine)?;
         Module::from_parts(engine, mmap, info, Arc::new(types))
     }
@@ -228,12 +236,44 @@ impl<'a> SerializedModule<'a> {
     }
 
     pub fn to_bytes(&self, version_strat: &ModuleVersionStrategy) -> Result<Vec<u8>> {
-        // Start off with a copy of the ELF image.
-        let mut ret = self.artifacts.as_ref().to_vec();
+        let trailer = self.trailer(version_strat)?;
+        let mut ret = Vec::with_capacity(self.artifacts.as_ref().len() + trailer.len());
+        ret.extend_from_slice(self.artifacts.as_ref());
+        ret.extend_from_slice(&trailer);
+        Ok(ret)
+    }
+
+    /// Writes the serialized module to `writer`, without first assembling it
+    /// in memory.
+    ///
+    /// The ELF image is handed to `writer` in a single write, and everything
+    /// following it in another.
+    #[cfg(compiler)]
+    pub fn to_writer(
+        &self,
+        writer: &mut dyn Write,
+        version_strat: &ModuleVersionStrategy,
+    ) -> Result<()> {
+        let trailer = self.trailer(version_strat)?;
+        writer.write_all(self.artifacts.as_ref())?;
+        writer.write_all(&trailer)?;
+        Ok(())
+    }
+
+    /// Returns the number of bytes that `to_bytes` and `to_writer` produce.
+    #[cfg(compiler)]
+    pub fn serialized_size(&self, version_strat: &ModuleVersionStrategy) -> Result<usize> {
+        Ok(self.artifacts.as_ref().len() + self.trailer(version_strat)?.len())
+    }
 
-        // Append the bincode-encoded `Metadata` section with a few other guards
-        // to help give better error messages during deserialization if
-        // something goes wrong.
+    /// Encodes everything which follows the ELF image: the bincode-encoded
+    /// `Metadata` section with a few other guards to help give better error
+    /// messages during deserialization if something goes wrong.
+    ///
+    /// This is small compared to the ELF image, which doesn't need to be
+    /// copied to produce it.
+    fn trailer(&self, version_strat: &ModuleVersionStrategy) -> Result<Vec<u8>> {
+        let mut ret = Vec::new();
         ret.extend_from_slice(HEADER);
         let version = match version_strat {
             ModuleVersionStrategy::WasmtimeVersion => env!("CARGO_PKG_VERSION"),
@@ -0,0 +1,70 @@
+//! Process-wide sharing of compiled modules loaded from files.
+//!
+//! When `Config::share_deserialized_code` is enabled a module deserialized
+//! from a file which is already loaded elsewhere in the process reuses the
+//! existing `CompiledModule`, and with it the existing mapping of the file,
+//! rather than creating another one. Entries only hold weak references so a
+//! compiled module is still freed once the last `Module` using it is dropped.
+
+use anyhow::Result;
+use once_cell::sync::Lazy;
+use std::collections::HashMap;
+use std::sync::{Arc, Mutex, Weak};
+use wasmtime_jit::CompiledModule;
+use wasmtime_runtime::MmapVec;
+
+/// Identifies the contents of a region of a file, along with the settings
+/// used to load it which aren't checked against the engine.
+#[derive(Hash, PartialEq, Eq)]
+pub struct SharedCodeKey {
+    dev: u64,
+    ino: u64,
+    size: u64,
+    mtime: (i64, i64),
+    offset: usize,
+    len: usize,
+    lazy_debug_registration: bool,
+}
+
+static SHARED_CODE: Lazy<Mutex<HashMap<SharedCodeKey, Weak<CompiledModule>>>> =
+    Lazy::new(Default::default);
+
+impl SharedCodeKey {
+    /// Returns the key for `mmap` if it's mapped from a file.
+    #[cfg(unix)]
+    pub fn new(mmap: &MmapVec, lazy_debug_registration: bool) -> Option<SharedCodeKey> {
+        use std::os::unix::fs::MetadataExt;
+
+        let metadata = mmap.original_file()?.metadata().ok()?;
+        Some(SharedCodeKey {
+            dev: metadata.dev(),
+            ino: metadata.ino(),
+            size: metadata.size(),
+            mtime: (metadata.mtime(), metadata.mtime_nsec()),
+            offset: mmap.original_offset(),
+            len: mmap.len(),
+            lazy_debug_registration,
+        })
+    }
+
+    #[cfg(not(unix))]
+    pub fn new(_mmap: &MmapVec, _lazy_debug_registration: bool) -> Option<SharedCodeKey> {
+        None
+    }
+
+    /// Returns the live compiled module for this key, or creates one with
+    /// `create` and records it for later lookups.
+    pub fn get_or_insert(
+        self,
+        create: impl FnOnce() -> Result<Arc<CompiledModule>>,
+    ) -> Result<Arc<CompiledModule>> {
+        let mut shared = SHARED_CODE.lock().unwrap();
+        if let Some(module) = shared.get(&self).and_then(|m| m.upgrade()) {
+            return Ok(module);
+        }
+        let module = create()?;
+        shared.retain(|_, m| m.strong_count() > 0);
+        shared.insert(self, Arc::downgrade(&module));
+        Ok(module)
+    }
+}
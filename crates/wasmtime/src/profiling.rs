@@ -0,0 +1,127 @@
+//! Built-in sampling of which WebAssembly functions are executing in a store.
+//!
+//! Samples are taken whenever a store's epoch deadline is reached while it is
+//! configured with [`Store::epoch_deadline_sample_and_update`], so the sampling
+//! rate is controlled by how often the embedder calls
+//! [`Engine::increment_epoch`]. Each sample walks the native stack only as far
+//! as the innermost WebAssembly frame and attributes the sample to the
+//! function of that frame.
+//!
+//! [`Store::epoch_deadline_sample_and_update`]: crate::Store::epoch_deadline_sample_and_update
+//! [`Engine::increment_epoch`]: crate::Engine::increment_epoch
+
+#[cfg(feature = "wasm-backtrace")]
+use crate::module::GlobalModuleRegistry;
+#[cfg(feature = "wasm-backtrace")]
+use std::collections::hash_map::Entry;
+use std::collections::HashMap;
+
+/// The number of profiling samples attributed to a single WebAssembly
+/// function.
+///
+/// This is returned from
+/// [`Store::profile_samples`](crate::Store::profile_samples).
+#[derive(Debug, Clone)]
+pub struct FuncSamples {
+    module_name: Option<String>,
+    func_index: u32,
+    func_name: Option<String>,
+    samples: u64,
+}
+
+impl FuncSamples {
+    /// Returns the identifer of the module that this function is defined in.
+    ///
+    /// See [`FrameInfo::module_name`](crate::FrameInfo::module_name) for more
+    /// information.
+    pub fn module_name(&self) -> Option<&str> {
+        self.module_name.as_deref()
+    }
+
+    /// Returns the index of this function in the function index space of its
+    /// module.
+    pub fn func_index(&self) -> u32 {
+        self.func_index
+    }
+
+    /// Returns the name of this function, if one is available in the `name`
+    /// custom section of its module.
+    pub fn func_name(&self) -> Option<&str> {
+        self.func_name.as_deref()
+    }
+
+    /// Returns the number of samples in which this function was the innermost
+    /// WebAssembly frame on the stack.
+    pub fn samples(&self) -> u64 {
+        self.samples
+    }
+}
+
+/// Per-store collection of profiling samples.
+///
+/// Functions are keyed by the start of their module's text section and their
+/// function index. The modules of a store stay registered until the store is
+/// dropped or reset, which also clears its samples, so these keys are stable
+/// for the lifetime of the samples.
+#[derive(Default)]
+pub(crate) struct ProfileSamples {
+    funcs: HashMap<(usize, u32), FuncSamples>,
+}
+
+impl ProfileSamples {
+    /// Records a sample for the innermost WebAssembly frame on the current
+    /// native stack, if there is one.
+    ///
+    /// Note that this does nothing if the `wasm-backtrace` feature is
+    /// disabled.
+    pub fn sample(&mut self) {
+        #[cfg(feature = "wasm-backtrace")]
+        GlobalModuleRegistry::with(|registry| {
+            let mut found = None;
+            backtrace::trace(|frame| {
+                let pc = frame.ip() as usize;
+                if pc == 0 {
+                    return true;
+                }
+                // Each frame's pc is the return address of a call, so look up
+                // the call instruction itself.
+                found = registry.lookup_func(pc - 1).map(|key| (key, pc - 1));
+                found.is_none()
+            });
+            let (key, pc) = match found {
+                Some(found) => found,
+                None => return,
+            };
+            let entry = match self.funcs.entry(key) {
+                Entry::Occupied(e) => e.into_mut(),
+                Entry::Vacant(e) => match registry.lookup_frame_info(pc) {
+                    Some((info, _, _)) => e.insert(FuncSamples {
+                        module_name: info.module_name().map(|s| s.to_string()),
+                        func_index: info.func_index(),
+                        func_name: info.func_name().map(|s| s.to_string()),
+                        samples: 0,
+                    }),
+                    None => return,
+                },
+            };
+            entry.samples += 1;
+        });
+    }
+
+    /// Returns the samples recorded so far, most frequently sampled functions
+    /// first.
+    pub fn snapshot(&self) -> Vec<FuncSamples> {
+        let mut ret = self.funcs.values().cloned().collect::<Vec<_>>();
+        ret.sort_by(|a, b| {
+            b.samples
+                .cmp(&a.samples)
+                .then_with(|| a.module_name.cmp(&b.module_name))
+                .then_with(|| a.func_index.cmp(&b.func_index))
+        });
+        ret
+    }
+
+    pub fn clear(&mut self) {
+        self.funcs.clear();
+    }
+}
@@ -0,0 +1,555 @@
+//! Snapshots of initialized instances, as created by [`Instance::snapshot`].
+//!
+//! A snapshot is a rewritten version of the WebAssembly binary of an
+//! instance's module in which:
+//!
+//! * the start function has been removed,
+//! * defined globals are initialized with their current values,
+//! * defined memories and tables start out at their current size,
+//! * the contents of defined memories are provided by active data segments,
+//!   and
+//! * the contents of defined tables are provided by active element segments.
+//!
+//! The module's own active segments were already applied when the instance
+//! was created, after which they behave as if dropped. Active data segments
+//! are therefore replaced with empty passive segments, and active element
+//! segments with declarative segments, both of which behave exactly like
+//! dropped segments. This preserves the indices of all other segments for
+//! `memory.init`, `table.init`, and friends, as well as the functions declared
+//! for `ref.func`. Passive segments are kept as they are.
+//!
+//! The data segments of the snapshot are at constant offsets, so compiling it
+//! with copy-on-write memory initialization enabled makes instantiation map
+//! the snapshot's memory image rather than copy it.
+//!
+//! [`Instance::snapshot`]: crate::Instance::snapshot
+
+use anyhow::{bail, Result};
+use std::collections::HashMap;
+use std::convert::TryFrom;
+use std::ops::Range;
+use wasmparser::{
+    BinaryReader, DataKind, DataSectionReader, ElementItem, ElementKind, ElementSectionReader,
+    Operator, Type,
+};
+use wasmtime_environ::{
+    DefinedGlobalIndex, DefinedMemoryIndex, DefinedTableIndex, EntityRef, FuncIndex, Module,
+    WasmType,
+};
+use wasmtime_runtime::{InstanceHandle, TableElement, VMCallerCheckedAnyfunc};
+
+const SECTION_FUNCTION: u8 = 3;
+const SECTION_TABLE: u8 = 4;
+const SECTION_MEMORY: u8 = 5;
+const SECTION_GLOBAL: u8 = 6;
+const SECTION_START: u8 = 8;
+const SECTION_ELEMENT: u8 = 9;
+const SECTION_CODE: u8 = 10;
+const SECTION_DATA: u8 = 11;
+const SECTION_DATA_COUNT: u8 = 12;
+
+const WASM_PAGE_SIZE: usize = 0x10000;
+
+/// Runs of zero bytes in a memory shorter than this are included in the
+/// surrounding data segment instead of splitting it in two, since each
+/// segment has a few bytes of overhead.
+const MIN_ZERO_RUN: usize = 64;
+
+/// A run of non-null elements of a table.
+struct TableSegment {
+    table: u32,
+    offset: u32,
+    funcs: Vec<FuncIndex>,
+}
+
+/// A run of non-zero bytes of a memory.
+struct DataSegment<'a> {
+    memory: u32,
+    memory64: bool,
+    offset: u64,
+    bytes: &'a [u8],
+}
+
+pub(crate) fn snapshot(instance: &mut InstanceHandle, wasm: &[u8]) -> Result<Vec<u8>> {
+    let module = instance.module().clone();
+    let sections = parse_sections(wasm)?;
+    check_matches(&module, wasm, &sections)?;
+
+    // Map every function of the instance back to its index so that funcref
+    // values in globals and tables can be encoded as `ref.func`.
+    let funcs = module
+        .functions
+        .keys()
+        .map(|index| {
+            let anyfunc = instance.get_exported_func(index).anyfunc.as_ptr();
+            (anyfunc as *const VMCallerCheckedAnyfunc, index)
+        })
+        .collect::<HashMap<_, _>>();
+    let func_index = |anyfunc: *const VMCallerCheckedAnyfunc| -> Result<Option<FuncIndex>> {
+        if anyfunc.is_null() {
+            return Ok(None);
+        }
+        match funcs.get(&anyfunc) {
+            Some(index) => Ok(Some(*index)),
+            None => bail!("cannot snapshot a reference to a function of another instance"),
+        }
+    };
+
+    let globals = encode_globals(instance, &module, &func_index)?;
+    let (tables, table_segments) = encode_tables(instance, &module, &func_index)?;
+    let (memories, data_segments) = encode_memories(instance, &module);
+
+    let mut out = wasm[..8].to_vec();
+    let mut wrote_elements = false;
+    let mut wrote_data = false;
+    for (id, range) in sections.iter().cloned() {
+        let contents = &wasm[range.clone()];
+        // Element segments come before the data count, code, and data
+        // sections, so if the module doesn't have an element section of its
+        // own the snapshot's segments are emitted right before those.
+        if !wrote_elements && (id == SECTION_DATA_COUNT || id == SECTION_CODE || id == SECTION_DATA)
+        {
+            write_section(
+                &mut out,
+                SECTION_ELEMENT,
+                &elements(&[], 0, &table_segments)?,
+            );
+            wrote_elements = true;
+        }
+        match id {
+            SECTION_TABLE => write_section(&mut out, id, &tables),
+            SECTION_MEMORY => write_section(&mut out, id, &memories),
+            SECTION_GLOBAL => write_section(&mut out, id, &globals),
+            SECTION_START => {}
+            SECTION_ELEMENT => {
+                let contents = elements(contents, range.start, &table_segments)?;
+                write_section(&mut out, id, &contents);
+                wrote_elements = true;
+            }
+            SECTION_DATA_COUNT => {
+                let original = match sections.iter().find(|(id, _)| *id == SECTION_DATA) {
+                    Some((_, range)) => {
+                        DataSectionReader::new(&wasm[range.clone()], range.start)?.get_count()
+                    }
+                    None => 0,
+                };
+                let mut contents = Vec::new();
+                leb_u32(
+                    &mut contents,
+                    original + u32::try_from(data_segments.len())?,
+                );
+                write_section(&mut out, id, &contents);
+            }
+            SECTION_DATA => {
+                let contents = data(contents, range.start, &data_segments)?;
+                write_section(&mut out, id, &contents);
+                wrote_data = true;
+            }
+            _ => write_section(&mut out, id, contents),
+        }
+    }
+    if !wrote_elements {
+        write_section(
+            &mut out,
+            SECTION_ELEMENT,
+            &elements(&[], 0, &table_segments)?,
+        );
+    }
+    if !wrote_data {
+        write_section(&mut out, SECTION_DATA, &data(&[], 0, &data_segments)?);
+    }
+    Ok(out)
+}
+
+/// Splits `wasm` into its sections, returning the id and the range of the
+/// contents of each.
+fn parse_sections(wasm: &[u8]) -> Result<Vec<(u8, Range<usize>)>> {
+    if wasm.len() < 8 || &wasm[..4] != b"\0asm" || wasm[4..8] != [1, 0, 0, 0] {
+        bail!("cannot snapshot with a binary which isn't a core WebAssembly module");
+    }
+    let mut reader = BinaryReader::new_with_offset(&wasm[8..], 8);
+    let mut sections = Vec::new();
+    while !reader.eof() {
+        let id = reader.read_u8()? as u8;
+        let size = reader.read_var_u32()? as usize;
+        let start = reader.original_position();
+        reader.read_bytes(size)?;
+        sections.push((id, start..start + size));
+    }
+    Ok(sections)
+}
+
+/// Checks that the number of items defined by `wasm` agrees with `module`,
+/// which catches most cases of passing a binary other than the one the
+/// instance was created from.
+fn check_matches(module: &Module, wasm: &[u8], sections: &[(u8, Range<usize>)]) -> Result<()> {
+    let defined = [
+        (
+            SECTION_FUNCTION,
+            module.functions.len() - module.num_imported_funcs,
+        ),
+        (
+            SECTION_TABLE,
+            module.table_plans.len() - module.num_imported_tables,
+        ),
+        (
+            SECTION_MEMORY,
+            module.memory_plans.len() - module.num_imported_memories,
+        ),
+        (
+            SECTION_GLOBAL,
+            module.globals.len() - module.num_imported_globals,
+        ),
+    ];
+    for &(id, expected) in defined.iter() {
+        let count = match sections.iter().find(|(i, _)| *i == id) {
+            Some((_, range)) => BinaryReader::new_with_offset(&wasm[range.clone()], range.start)
+                .read_var_u32()? as usize,
+            None => 0,
+        };
+        if count != expected {
+            bail!("binary passed to snapshot is not the module of the instance");
+        }
+    }
+    Ok(())
+}
+
+fn encode_globals(
+    instance: &mut InstanceHandle,
+    module: &Module,
+    func_index: &dyn Fn(*const VMCallerCheckedAnyfunc) -> Result<Option<FuncIndex>>,
+) -> Result<Vec<u8>> {
+    let count = module.globals.len() - module.num_imported_globals;
+    let mut out = Vec::new();
+    leb_u32(&mut out, u32::try_from(count)?);
+    for i in 0..count {
+        let index = module.global_index(DefinedGlobalIndex::new(i));
+        let global = &module.globals[index];
+        let definition = instance.get_exported_global(index).definition;
+        out.push(val_type(global.wasm_ty));
+        out.push(global.mutability as u8);
+        unsafe {
+            match global.wasm_ty {
+                WasmType::I32 => {
+                    out.push(0x41);
+                    leb_i64(&mut out, (*(*definition).as_i32()).into());
+                }
+                WasmType::I64 => {
+                    out.push(0x42);
+                    leb_i64(&mut out, *(*definition).as_i64());
+                }
+                WasmType::F32 => {
+                    out.push(0x43);
+                    out.extend_from_slice(&(*(*definition).as_f32_bits()).to_le_bytes());
+                }
+                WasmType::F64 => {
+                    out.push(0x44);
+                    out.extend_from_slice(&(*(*definition).as_f64_bits()).to_le_bytes());
+                }
+                WasmType::V128 => {
+                    out.push(0xfd);
+                    leb_u32(&mut out, 12);
+                    out.extend_from_slice(&(*(*definition).as_u128()).to_le_bytes());
+                }
+                WasmType::FuncRef => match func_index((*definition).as_anyfunc())? {
+                    Some(func) => ref_func(&mut out, func),
+                    None => out.extend_from_slice(&[0xd0, 0x70]),
+                },
+                WasmType::ExternRef => {
+                    if (*definition).as_externref().is_some() {
+                        bail!("cannot snapshot a non-null externref global");
+                    }
+                    out.extend_from_slice(&[0xd0, 0x6f]);
+                }
+            }
+        }
+        out.push(0x0b);
+    }
+    Ok(out)
+}
+
+fn encode_tables(
+    instance: &mut InstanceHandle,
+    module: &Module,
+    func_index: &dyn Fn(*const VMCallerCheckedAnyfunc) -> Result<Option<FuncIndex>>,
+) -> Result<(Vec<u8>, Vec<TableSegment>)> {
+    let count = module.table_plans.len() - module.num_imported_tables;
+    let mut out = Vec::new();
+    let mut segments = Vec::new();
+    leb_u32(&mut out, u32::try_from(count)?);
+    for i in 0..count {
+        let defined = DefinedTableIndex::new(i);
+        let index = module.table_index(defined);
+        let ty = &module.table_plans[index].table;
+        let table = unsafe {
+            let size = (*instance.get_defined_table(defined)).size();
+            &*instance.get_defined_table_with_lazy_init(defined, 0..size)
+        };
+        out.push(val_type(ty.wasm_ty));
+        limits(&mut out, table.size().into(), ty.maximum.map(u64::from), 0);
+
+        let mut segment: Option<TableSegment> = None;
+        for j in 0..table.size() {
+            let func = match table.get(j) {
+                Some(TableElement::FuncRef(anyfunc)) => func_index(anyfunc)?,
+                Some(TableElement::ExternRef(None)) => None,
+                Some(TableElement::ExternRef(Some(_))) => {
+                    bail!("cannot snapshot a table containing non-null externrefs")
+                }
+                Some(TableElement::UninitFunc) | None => unreachable!(),
+            };
+            match (func, &mut segment) {
+                (Some(func), Some(segment)) => segment.funcs.push(func),
+                (Some(func), None) => {
+                    segment = Some(TableSegment {
+                        table: index.as_u32(),
+                        offset: j,
+                        funcs: vec![func],
+                    })
+                }
+                (None, _) => segments.extend(segment.take()),
+            }
+        }
+        segments.extend(segment);
+    }
+    Ok((out, segments))
+}
+
+fn encode_memories<'a>(
+    instance: &'a mut InstanceHandle,
+    module: &Module,
+) -> (Vec<u8>, Vec<DataSegment<'a>>) {
+    let count = module.memory_plans.len() - module.num_imported_memories;
+    let mut out = Vec::new();
+    let mut segments = Vec::new();
+    leb_u32(&mut out, count as u32);
+    for i in 0..count {
+        let index = module.memory_index(DefinedMemoryIndex::new(i));
+        let ty = &module.memory_plans[index].memory;
+        let memory = unsafe {
+            let definition = &*instance.get_exported_memory(index).definition;
+            std::slice::from_raw_parts(definition.base, definition.current_length)
+        };
+        let flags = ((ty.shared as u8) << 1) | ((ty.memory64 as u8) << 2);
+        limits(
+            &mut out,
+            (memory.len() / WASM_PAGE_SIZE) as u64,
+            ty.maximum,
+            flags,
+        );
+
+        let mut start = 0;
+        while let Some(n) = memory[start..].iter().position(|b| *b != 0) {
+            start += n;
+            let mut end = start;
+            loop {
+                match memory[end..].iter().position(|b| *b == 0) {
+                    Some(n) => end += n,
+                    None => {
+                        end = memory.len();
+                        break;
+                    }
+                }
+                match memory[end..].iter().position(|b| *b != 0) {
+                    Some(n) if n < MIN_ZERO_RUN => end += n,
+                    _ => break,
+                }
+            }
+            segments.push(DataSegment {
+                memory: index.as_u32(),
+                memory64: ty.memory64,
+                offset: start as u64,
+                bytes: &memory[start..end],
+            });
+            start = end;
+        }
+    }
+    (out, segments)
+}
+
+/// Encodes the element section of the snapshot from the `original` contents
+/// of the module's element section, located at `offset`.
+fn elements(original: &[u8], offset: usize, segments: &[TableSegment]) -> Result<Vec<u8>> {
+    let mut count = 0;
+    let mut body = Vec::new();
+    if !original.is_empty() {
+        for element in ElementSectionReader::new(original, offset)? {
+            let element = element?;
+            count += 1;
+            if let ElementKind::Active { .. } = element.kind {
+                // Declarative segment with expressions, keeping the items so
+                // that the functions stay declared.
+                body.push(0x07);
+                body.push(match element.ty {
+                    Type::FuncRef => 0x70,
+                    Type::ExternRef => 0x6f,
+                    _ => bail!("unsupported element segment type"),
+                });
+                let items = element.items.get_items_reader()?;
+                leb_u32(&mut body, items.get_count());
+                for item in items {
+                    match item? {
+                        ElementItem::Func(f) => ref_func(&mut body, FuncIndex::from_u32(f)),
+                        ElementItem::Expr(init) => {
+                            match init.get_binary_reader().read_operator()? {
+                                Operator::RefNull {
+                                    ty: Type::ExternRef,
+                                } => body.extend_from_slice(&[0xd0, 0x6f]),
+                                Operator::RefNull { .. } => body.extend_from_slice(&[0xd0, 0x70]),
+                                Operator::RefFunc { function_index } => {
+                                    ref_func(&mut body, FuncIndex::from_u32(function_index))
+                                }
+                                other => bail!("unsupported element segment item {:?}", other),
+                            }
+                        }
+                    }
+                    body.push(0x0b);
+                }
+            } else {
+                let range = element.range;
+                body.extend_from_slice(&original[range.start - offset..range.end - offset]);
+            }
+        }
+    }
+    for segment in segments {
+        count += 1;
+        body.push(0x06);
+        leb_u32(&mut body, segment.table);
+        body.push(0x41);
+        leb_i64(&mut body, (segment.offset as i32).into());
+        body.push(0x0b);
+        body.push(0x70);
+        leb_u32(&mut body, u32::try_from(segment.funcs.len())?);
+        for func in segment.funcs.iter() {
+            ref_func(&mut body, *func);
+            body.push(0x0b);
+        }
+    }
+    let mut out = Vec::new();
+    leb_u32(&mut out, count);
+    out.extend_from_slice(&body);
+    Ok(out)
+}
+
+/// Encodes the data section of the snapshot from the `original` contents of
+/// the module's data section, located at `offset`.
+fn data(original: &[u8], offset: usize, segments: &[DataSegment<'_>]) -> Result<Vec<u8>> {
+    let mut count = 0;
+    let mut body = Vec::new();
+    if !original.is_empty() {
+        for data in DataSectionReader::new(original, offset)? {
+            let data = data?;
+            count += 1;
+            match data.kind {
+                // An empty passive segment.
+                DataKind::Active { .. } => body.extend_from_slice(&[0x01, 0x00]),
+                DataKind::Passive => {
+                    let range = data.range;
+                    body.extend_from_slice(&original[range.start - offset..range.end - offset]);
+                }
+            }
+        }
+    }
+    for segment in segments {
+        count += 1;
+        if segment.memory == 0 {
+            body.push(0x00);
+        } else {
+            body.push(0x02);
+            leb_u32(&mut body, segment.memory);
+        }
+        if segment.memory64 {
+            body.push(0x42);
+            leb_i64(&mut body, segment.offset as i64);
+        } else {
+            body.push(0x41);
+            leb_i64(&mut body, (segment.offset as u32 as i32).into());
+        }
+        body.push(0x0b);
+        leb_u32(&mut body, u32::try_from(segment.bytes.len())?);
+        body.extend_from_slice(segment.bytes);
+    }
+    let mut out = Vec::new();
+    leb_u32(&mut out, count);
+    out.extend_from_slice(&body);
+    Ok(out)
+}
+
+fn val_type(ty: WasmType) -> u8 {
+    match ty {
+        WasmType::I32 => 0x7f,
+        WasmType::I64 => 0x7e,
+        WasmType::F32 => 0x7d,
+        WasmType::F64 => 0x7c,
+        WasmType::V128 => 0x7b,
+        WasmType::FuncRef => 0x70,
+        WasmType::ExternRef => 0x6f,
+    }
+}
+
+fn limits(out: &mut Vec<u8>, minimum: u64, maximum: Option<u64>, flags: u8) {
+    out.push(flags | maximum.is_some() as u8);
+    leb_u64(out, minimum);
+    if let Some(maximum) = maximum {
+        leb_u64(out, maximum);
+    }
+}
+
+fn ref_func(out: &mut Vec<u8>, func: FuncIndex) {
+    out.push(0xd2);
+    leb_u32(out, func.as_u32());
+}
+
+fn write_section(out: &mut Vec<u8>, id: u8, contents: &[u8]) {
+    out.push(id);
+    leb_u32(out, contents.len() as u32);
+    out.extend_from_slice(contents);
+}
+
+fn leb_u32(out: &mut Vec<u8>, val: u32) {
+    leb_u64(out, val.into())
+}
+
+fn leb_u64(out: &mut Vec<u8>, mut val: u64) {
+    loop {
+        let byte = (val & 0x7f) as u8;
+        val >>= 7;
+        if val == 0 {
+            out.push(byte);
+            return;
+        }
+        out.push(byte | 0x80);
+    }
+}
+
+fn leb_i64(out: &mut Vec<u8>, mut val: i64) {
+    loop {
+        let byte = (val & 0x7f) as u8;
+        val >>= 7;
+        if (val == 0 && byte & 0x40 == 0) || (val == -1 && byte & 0x40 != 0) {
+            out.push(byte);
+            return;
+        }
+        out.push(byte | 0x80);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn signed_leb() {
+        let encode = |val| {
+            let mut out = Vec::new();
+            leb_i64(&mut out, val);
+            out
+        };
+        assert_eq!(encode(0), [0x00]);
+        assert_eq!(encode(63), [0x3f]);
+        assert_eq!(encode(64), [0xc0, 0x00]);
+        assert_eq!(encode(-1), [0x7f]);
+        assert_eq!(encode(-64), [0x40]);
+        assert_eq!(encode(-65), [0xbf, 0x7f]);
+    }
+}
@@ -77,7 +77,10 @@
 //! `wasmtime`, must uphold for the public interface to be safe.
 
 use crate::module::BareModuleInfo;
-use crate::{module::ModuleRegistry, Engine, Module, Trap, Val, ValRaw};
+use crate::profiling::ProfileSamples;
+use crate::{
+    module::ModuleRegistry, Engine, FuncSamples, Module, ResourceUsage, Trap, Val, ValRaw,
+};
 use anyhow::{bail, Result};
 use std::cell::UnsafeCell;
 use std::collections::HashMap;
@@ -92,6 +95,7 @@ use std::ptr;
 use std::sync::atomic::AtomicU64;
 use std::sync::Arc;
 use std::task::{Context, Poll};
+pub use wasmtime_runtime::GcStats;
 use wasmtime_runtime::{
     InstanceAllocationRequest, InstanceAllocator, InstanceHandle, ModuleInfo,
     OnDemandInstanceAllocator, SignalHandler, StorePtr, VMCallerCheckedAnyfunc, VMContext,
@@ -201,10 +205,49 @@ pub struct StoreInner<T> {
 
     limiter: Option<ResourceLimiterInner<T>>,
     call_hook: Option<CallHookInner<T>>,
+    out_of_fuel_callback: Option<OutOfFuelCallback<T>>,
+    epoch_deadline_callback: Option<EpochDeadlineCallback<T>>,
     // for comments about `ManuallyDrop`, see `Store::into_data`
     data: ManuallyDrop<T>,
 }
 
+type OutOfFuelCallback<T> =
+    Box<dyn FnMut(StoreContextMut<'_, T>) -> Result<FuelAction> + Send + Sync>;
+
+/// What to do after running out of fuel, as returned from a callback
+/// configured with [`Store::out_of_fuel_callback`].
+#[derive(Debug, Copy, Clone, PartialEq, Eq)]
+pub enum FuelAction {
+    /// Add the specified amount of fuel and continue executing.
+    Refuel(u64),
+    /// Yield to the async executor, and add the specified amount of fuel
+    /// once execution resumes.
+    ///
+    /// This is only valid for stores associated with an [async
+    /// config](crate::Config::async_support); otherwise running out of fuel
+    /// will raise a trap.
+    YieldAndRefuel(u64),
+}
+
+type EpochDeadlineCallback<T> =
+    Box<dyn FnMut(StoreContextMut<'_, T>) -> Result<DeadlineAction> + Send + Sync>;
+
+/// What to do after the epoch deadline is reached, as returned from a
+/// callback configured with [`Store::epoch_deadline_callback`].
+#[derive(Debug, Copy, Clone, PartialEq, Eq)]
+pub enum DeadlineAction {
+    /// Extend the deadline by the specified number of ticks and continue
+    /// executing.
+    Extend(u64),
+    /// Yield to the async executor, and extend the deadline by the specified
+    /// number of ticks once execution resumes.
+    ///
+    /// This is only valid for stores associated with an [async
+    /// config](crate::Config::async_support); otherwise reaching the deadline
+    /// will raise a trap.
+    YieldAndExtend(u64),
+}
+
 enum ResourceLimiterInner<T> {
     Sync(Box<dyn FnMut(&mut T) -> &mut (dyn crate::ResourceLimiter) + Send + Sync>),
     #[cfg(feature = "async")]
@@ -296,6 +339,7 @@ pub struct StoreOpaque {
     async_state: AsyncState,
     out_of_gas_behavior: OutOfGas,
     epoch_deadline_behavior: EpochDeadline,
+    profile_samples: ProfileSamples,
     store_data: StoreData,
     default_callee: InstanceHandle,
 
@@ -397,6 +441,7 @@ struct StoreInstance {
 #[derive(Copy, Clone)]
 enum OutOfGas {
     Trap,
+    Callback,
     InjectFuel {
         injection_count: u64,
         fuel_to_inject: u64,
@@ -413,6 +458,11 @@ enum EpochDeadline {
     /// yielding to the async executor loop.
     #[cfg(feature = "async")]
     YieldAndExtendDeadline { delta: u64 },
+    /// Record a profiling sample and extend the deadline by the specified
+    /// number of ticks.
+    SampleAndExtendDeadline { delta: u64 },
+    /// Call the store's epoch deadline callback.
+    Callback,
 }
 
 impl<T> Store<T> {
@@ -471,6 +521,7 @@ impl<T> Store<T> {
                 },
                 out_of_gas_behavior: OutOfGas::Trap,
                 epoch_deadline_behavior: EpochDeadline::Trap,
+                profile_samples: ProfileSamples::default(),
                 store_data: StoreData::new(),
                 default_callee,
                 hostcall_val_storage: Vec::new(),
@@ -478,6 +529,8 @@ impl<T> Store<T> {
             },
             limiter: None,
             call_hook: None,
+            out_of_fuel_callback: None,
+            epoch_deadline_callback: None,
             data: ManuallyDrop::new(data),
         });
 
@@ -544,6 +597,36 @@ impl<T> Store<T> {
         }
     }
 
+    /// Resets this [`Store`] to the state it was in when it was created,
+    /// while retaining its internal allocations for reuse.
+    ///
+    /// All instances in this store are deallocated and all functions, tables,
+    /// memories, and globals created within it are dropped, along with any
+    /// host state they own. Afterwards the store behaves as if it were newly
+    /// created: resource counts are reset, no fuel has been consumed or added,
+    /// the epoch deadline is zero, and out-of-fuel and epoch-deadline behavior
+    /// is back to trapping, dropping any [`Store::out_of_fuel_callback`] and
+    /// [`Store::epoch_deadline_callback`].
+    /// Configuration applied through [`Store::limiter`]
+    /// and [`Store::call_hook`] is retained, as is the data `T` (which can be
+    /// replaced through [`Store::data_mut`]).
+    ///
+    /// This is intended for embeddings which handle many short-lived requests
+    /// and would otherwise create and destroy a [`Store`] for each one.
+    /// Resetting a store avoids reallocating its bookkeeping structures. The
+    /// modules previously instantiated within it are unregistered, so a reused
+    /// store doesn't keep modules alive after they're otherwise dropped.
+    ///
+    /// Any [`Func`](crate::Func), [`Instance`](crate::Instance), or other item
+    /// previously created within this store cannot be used with it after it
+    /// has been reset, and attempting to do so will panic, as with any other
+    /// item used with the wrong store.
+    pub fn reset(&mut self) {
+        self.inner.out_of_fuel_callback = None;
+        self.inner.epoch_deadline_callback = None;
+        self.inner.reset();
+    }
+
     /// Configures the [`ResourceLimiter`](crate::ResourceLimiter) used to limit
     /// resource creation within this [`Store`].
     ///
@@ -674,6 +757,26 @@ impl<T> Store<T> {
         self.inner.gc()
     }
 
+    /// Returns statistics about the garbage collections of `ExternRef`s that
+    /// have happened in this store so far, both those triggered explicitly
+    /// through [`Store::gc`] and those triggered automatically when internal
+    /// buffers fill up.
+    ///
+    /// The internal buffer that holds references passed into WebAssembly
+    /// grows as GCs find it full, so the frequency of automatic GCs decreases
+    /// for workloads that pass many `ExternRef`s into WebAssembly.
+    pub fn gc_stats(&self) -> GcStats {
+        self.inner.gc_stats()
+    }
+
+    /// Returns the resources currently allocated within this store.
+    ///
+    /// This walks all of the store's instances, so it takes time proportional
+    /// to the number of instances, memories and tables in the store.
+    pub fn resource_usage(&self) -> ResourceUsage {
+        self.inner.resource_usage()
+    }
+
     /// Returns the amount of fuel consumed by this store's execution so far.
     ///
     /// If fuel consumption is not enabled via
@@ -784,6 +887,35 @@ impl<T> Store<T> {
             .out_of_fuel_async_yield(injection_count, fuel_to_inject)
     }
 
+    /// Configures a [`Store`] to invoke a callback whenever fuel runs out.
+    ///
+    /// When a [`Store`] is configured to consume fuel with
+    /// [`Config::consume_fuel`](crate::Config::consume_fuel) this method will
+    /// configure what happens when fuel runs out. Specifically `callback` is
+    /// invoked and its result decides how to proceed:
+    ///
+    /// * Returning an error raises a trap, aborting the current execution of
+    ///   WebAssembly just as [`Store::out_of_fuel_trap`] does.
+    /// * Returning [`FuelAction::Refuel`] adds fuel and continues executing.
+    ///   The callback may also inspect the store, for example to charge the
+    ///   fuel consumed so far to whatever account is running this store,
+    ///   rather than having to tear down the guest when it runs out.
+    /// * Returning [`FuelAction::YieldAndRefuel`] suspends execution
+    ///   and yields control back to the caller, like
+    ///   [`Store::out_of_fuel_async_yield`] does, and adds fuel once
+    ///   execution resumes.
+    ///
+    /// Note that fuel is only checked on entry to functions and at the head of
+    /// loops, so the amount returned should be large enough to make progress.
+    /// Refueling with zero fuel makes the callback run again at the next
+    /// check.
+    pub fn out_of_fuel_callback(
+        &mut self,
+        callback: impl FnMut(StoreContextMut<'_, T>) -> Result<FuelAction> + Send + Sync + 'static,
+    ) {
+        self.inner.out_of_fuel_callback(Box::new(callback))
+    }
+
     /// Sets the epoch deadline to a certain number of ticks in the future.
     ///
     /// When the Wasm guest code is compiled with epoch-interruption
@@ -863,6 +995,82 @@ impl<T> Store<T> {
     pub fn epoch_deadline_async_yield_and_update(&mut self, delta: u64) {
         self.inner.epoch_deadline_async_yield_and_update(delta);
     }
+
+    /// Configures epoch-deadline expiration to record a profiling sample
+    /// and then update the deadline.
+    ///
+    /// When epoch-interruption-instrumented code is executed on this
+    /// store and the epoch deadline is reached before completion,
+    /// with the store configured in this way, the WebAssembly function
+    /// currently executing is recorded as a sample and execution
+    /// continues with an epoch deadline equal to the current epoch
+    /// plus `delta` ticks.
+    ///
+    /// This implements a low-overhead sampling profiler: some external
+    /// driver (a thread that wakes up periodically, for example) calls
+    /// [`Engine::increment_epoch()`](crate::Engine::increment_epoch) at
+    /// the desired sampling interval, and the collected samples are
+    /// retrieved with [`Store::profile_samples`]. Each sample only walks
+    /// the native stack as far as the innermost WebAssembly frame.
+    ///
+    /// Samples are only recorded when the `wasm-backtrace` feature of
+    /// this crate is enabled, which it is by default. Otherwise this
+    /// behaves as if the deadline were simply extended.
+    ///
+    /// See documentation on
+    /// [`Config::epoch_interruption()`](crate::Config::epoch_interruption)
+    /// for an introduction to epoch-based interruption.
+    pub fn epoch_deadline_sample_and_update(&mut self, delta: u64) {
+        self.inner.epoch_deadline_sample_and_update(delta);
+    }
+
+    /// Configures epoch-deadline expiration to invoke a callback.
+    ///
+    /// When epoch-interruption-instrumented code is executed on this
+    /// store and the epoch deadline is reached before completion, with
+    /// the store configured in this way, `callback` is invoked and its
+    /// result decides how to proceed:
+    ///
+    /// * Returning an error raises a trap, just as
+    ///   [`Store::epoch_deadline_trap`] does.
+    /// * Returning [`DeadlineAction::Extend`] sets the deadline to the
+    ///   current epoch plus the given number of ticks and continues
+    ///   executing.
+    /// * Returning [`DeadlineAction::YieldAndExtend`] yields to the async
+    ///   caller, like
+    ///   [`Store::epoch_deadline_async_yield_and_update`] does, and extends
+    ///   the deadline once execution resumes.
+    ///
+    /// This allows deciding on each deadline whether a guest has run for
+    /// too long in total, should be given another time slice right away,
+    /// or should let other guests run first, based on the state of the
+    /// store.
+    ///
+    /// See documentation on
+    /// [`Config::epoch_interruption()`](crate::Config::epoch_interruption)
+    /// for an introduction to epoch-based interruption.
+    pub fn epoch_deadline_callback(
+        &mut self,
+        callback: impl FnMut(StoreContextMut<'_, T>) -> Result<DeadlineAction> + Send + Sync + 'static,
+    ) {
+        self.inner.epoch_deadline_callback(Box::new(callback))
+    }
+
+    /// Returns the profiling samples recorded in this store so far, with
+    /// the most frequently sampled functions first.
+    ///
+    /// Samples are recorded when the epoch deadline is reached with the
+    /// store configured by [`Store::epoch_deadline_sample_and_update`].
+    /// Samples accumulate until [`Store::clear_profile_samples`] or
+    /// [`Store::reset`] is called.
+    pub fn profile_samples(&self) -> Vec<FuncSamples> {
+        self.inner.profile_samples.snapshot()
+    }
+
+    /// Discards all profiling samples recorded in this store so far.
+    pub fn clear_profile_samples(&mut self) {
+        self.inner.profile_samples.clear();
+    }
 }
 
 impl<'a, T> StoreContext<'a, T> {
@@ -888,6 +1096,20 @@ impl<'a, T> StoreContext<'a, T> {
     pub fn fuel_consumed(&self) -> Option<u64> {
         self.0.fuel_consumed()
     }
+
+    /// Returns statistics about garbage collections in this store.
+    ///
+    /// For more information see [`Store::gc_stats`].
+    pub fn gc_stats(&self) -> GcStats {
+        self.0.gc_stats()
+    }
+
+    /// Returns the resources currently allocated within this store.
+    ///
+    /// For more information see [`Store::resource_usage`].
+    pub fn resource_usage(&self) -> ResourceUsage {
+        self.0.resource_usage()
+    }
 }
 
 impl<'a, T> StoreContextMut<'a, T> {
@@ -917,6 +1139,20 @@ impl<'a, T> StoreContextMut<'a, T> {
         self.0.gc()
     }
 
+    /// Returns statistics about garbage collections in this store.
+    ///
+    /// For more information see [`Store::gc_stats`].
+    pub fn gc_stats(&self) -> GcStats {
+        self.0.gc_stats()
+    }
+
+    /// Returns the resources currently allocated within this store.
+    ///
+    /// For more information see [`Store::resource_usage`].
+    pub fn resource_usage(&self) -> ResourceUsage {
+        self.0.resource_usage()
+    }
+
     /// Returns the fuel consumed by this store.
     ///
     /// For more information see [`Store::fuel_consumed`].
@@ -954,6 +1190,16 @@ impl<'a, T> StoreContextMut<'a, T> {
             .out_of_fuel_async_yield(injection_count, fuel_to_inject)
     }
 
+    /// Configures this `Store` to invoke a callback whenever fuel runs out.
+    ///
+    /// For more information see [`Store::out_of_fuel_callback`]
+    pub fn out_of_fuel_callback(
+        &mut self,
+        callback: impl FnMut(StoreContextMut<'_, T>) -> Result<FuelAction> + Send + Sync + 'static,
+    ) {
+        self.0.out_of_fuel_callback(Box::new(callback))
+    }
+
     /// Sets the epoch deadline to a certain number of ticks in the future.
     ///
     /// For more information see [`Store::set_epoch_deadline`].
@@ -978,6 +1224,39 @@ impl<'a, T> StoreContextMut<'a, T> {
     pub fn epoch_deadline_async_yield_and_update(&mut self, delta: u64) {
         self.0.epoch_deadline_async_yield_and_update(delta);
     }
+
+    /// Configures epoch-deadline expiration to record a profiling sample
+    /// and then update the deadline.
+    ///
+    /// For more information see
+    /// [`Store::epoch_deadline_sample_and_update`].
+    pub fn epoch_deadline_sample_and_update(&mut self, delta: u64) {
+        self.0.epoch_deadline_sample_and_update(delta);
+    }
+
+    /// Configures epoch-deadline expiration to invoke a callback.
+    ///
+    /// For more information see [`Store::epoch_deadline_callback`].
+    pub fn epoch_deadline_callback(
+        &mut self,
+        callback: impl FnMut(StoreContextMut<'_, T>) -> Result<DeadlineAction> + Send + Sync + 'static,
+    ) {
+        self.0.epoch_deadline_callback(Box::new(callback))
+    }
+
+    /// Returns the profiling samples recorded in this store so far.
+    ///
+    /// For more information see [`Store::profile_samples`].
+    pub fn profile_samples(&self) -> Vec<FuncSamples> {
+        self.0.profile_samples.snapshot()
+    }
+
+    /// Discards all profiling samples recorded in this store so far.
+    ///
+    /// For more information see [`Store::clear_profile_samples`].
+    pub fn clear_profile_samples(&mut self) {
+        self.0.profile_samples.clear();
+    }
 }
 
 impl<T> StoreInner<T> {
@@ -1010,6 +1289,40 @@ impl<T> StoreInner<T> {
 }
 
 impl StoreOpaque {
+    fn reset(&mut self) {
+        let allocator = self.engine.allocator();
+        unsafe {
+            let ondemand = OnDemandInstanceAllocator::default();
+            for instance in self.instances.drain(..) {
+                if instance.ondemand {
+                    ondemand.deallocate(&instance.handle);
+                } else {
+                    allocator.deallocate(&instance.handle);
+                }
+            }
+        }
+        // With no instances left nothing refers to the modules registered in
+        // this store, so release them rather than keeping every module the
+        // store ever instantiated alive.
+        self.modules = ModuleRegistry::default();
+        self.store_data.reset();
+        self.instance_count = 0;
+        self.memory_count = 0;
+        self.table_count = 0;
+        self.fuel_adj = 0;
+        unsafe {
+            *self.runtime_limits.fuel_consumed.get() = 0;
+            *self.runtime_limits.epoch_deadline.get() = 0;
+        }
+        self.out_of_gas_behavior = OutOfGas::Trap;
+        self.epoch_deadline_behavior = EpochDeadline::Trap;
+        self.profile_samples.clear();
+
+        // Release any `externref` values that were only kept alive by the
+        // activations table; nothing can be on the stack at this point.
+        self.gc();
+    }
+
     pub fn bump_resource_counts(&mut self, module: &Module) -> Result<()> {
         fn bump(slot: &mut usize, max: usize, amt: usize, desc: &str) -> Result<()> {
             let new = slot.saturating_add(amt);
@@ -1102,6 +1415,29 @@ impl StoreOpaque {
         unsafe { wasmtime_runtime::gc(&self.modules, &mut self.externref_activations_table) }
     }
 
+    pub fn gc_stats(&self) -> GcStats {
+        self.externref_activations_table.gc_stats()
+    }
+
+    pub fn resource_usage(&self) -> ResourceUsage {
+        let mut usage = ResourceUsage {
+            instances: self.instance_count,
+            ..ResourceUsage::default()
+        };
+        for instance in self.instances.iter() {
+            for memory in instance.handle.defined_memories() {
+                usage.memories += 1;
+                usage.memory_bytes_committed += memory.byte_size();
+                usage.memory_bytes_reserved += memory.reserved_byte_size();
+            }
+            for table in instance.handle.defined_tables() {
+                usage.tables += 1;
+                usage.table_elements += table.size() as usize;
+            }
+        }
+        usage
+    }
+
     /// Looks up the corresponding `VMTrampoline` which can be used to enter
     /// wasm given an anyfunc function pointer.
     ///
@@ -1345,6 +1681,10 @@ impl StoreOpaque {
         drop(delta); // suppress warning in non-async build
     }
 
+    fn epoch_deadline_sample_and_update(&mut self, delta: u64) {
+        self.epoch_deadline_behavior = EpochDeadline::SampleAndExtendDeadline { delta };
+    }
+
     #[inline]
     pub fn signal_handler(&self) -> Option<*const SignalHandler<'static>> {
         let handler = self.signal_handler.as_ref()?;
@@ -1796,6 +2136,7 @@ unsafe impl<T> wasmtime_runtime::Store for StoreInner<T> {
     fn out_of_gas(&mut self) -> Result<(), anyhow::Error> {
         return match &mut self.out_of_gas_behavior {
             OutOfGas::Trap => Err(anyhow::Error::new(OutOfGasError)),
+            OutOfGas::Callback => self.invoke_out_of_fuel_callback(),
             #[cfg(feature = "async")]
             OutOfGas::InjectFuel {
                 injection_count,
@@ -1843,6 +2184,15 @@ unsafe impl<T> wasmtime_runtime::Store for StoreInner<T> {
                 // doesn't have to reload it.
                 Ok(self.get_epoch_deadline())
             }
+            &EpochDeadline::SampleAndExtendDeadline { delta } => {
+                self.profile_samples.sample();
+                self.set_epoch_deadline(delta);
+                Ok(self.get_epoch_deadline())
+            }
+            &EpochDeadline::Callback => {
+                self.invoke_epoch_deadline_callback()?;
+                Ok(self.get_epoch_deadline())
+            }
         };
 
         #[derive(Debug)]
@@ -1859,6 +2209,70 @@ unsafe impl<T> wasmtime_runtime::Store for StoreInner<T> {
 }
 
 impl<T> StoreInner<T> {
+    fn out_of_fuel_callback(&mut self, callback: OutOfFuelCallback<T>) {
+        self.out_of_fuel_callback = Some(callback);
+        self.out_of_gas_behavior = OutOfGas::Callback;
+    }
+
+    fn invoke_out_of_fuel_callback(&mut self) -> Result<(), anyhow::Error> {
+        // Take the callback out of the store while it runs so that it can be
+        // given access to the store itself.
+        let mut callback = self
+            .out_of_fuel_callback
+            .take()
+            .expect("out-of-fuel callback is configured");
+        let action = callback(StoreContextMut(self));
+        // Put the callback back unless it replaced itself.
+        if self.out_of_fuel_callback.is_none() {
+            self.out_of_fuel_callback = Some(callback);
+        }
+        let fuel = match action? {
+            FuelAction::Refuel(fuel) => fuel,
+            FuelAction::YieldAndRefuel(fuel) => {
+                anyhow::ensure!(
+                    self.async_support(),
+                    "cannot yield on running out of fuel without async support"
+                );
+                #[cfg(feature = "async")]
+                self.async_yield_impl()?;
+                fuel
+            }
+        };
+        self.add_fuel(fuel)
+    }
+
+    fn epoch_deadline_callback(&mut self, callback: EpochDeadlineCallback<T>) {
+        self.epoch_deadline_callback = Some(callback);
+        self.epoch_deadline_behavior = EpochDeadline::Callback;
+    }
+
+    fn invoke_epoch_deadline_callback(&mut self) -> Result<(), anyhow::Error> {
+        // As with the out-of-fuel callback, the callback is taken out of the
+        // store while it runs so that it can be given access to the store.
+        let mut callback = self
+            .epoch_deadline_callback
+            .take()
+            .expect("epoch deadline callback is configured");
+        let action = callback(StoreContextMut(self));
+        if self.epoch_deadline_callback.is_none() {
+            self.epoch_deadline_callback = Some(callback);
+        }
+        let delta = match action? {
+            DeadlineAction::Extend(delta) => delta,
+            DeadlineAction::YieldAndExtend(delta) => {
+                anyhow::ensure!(
+                    self.async_support(),
+                    "cannot yield on reaching the epoch deadline without async support"
+                );
+                #[cfg(feature = "async")]
+                self.async_yield_impl()?;
+                delta
+            }
+        };
+        self.set_epoch_deadline(delta);
+        Ok(())
+    }
+
     pub(crate) fn set_epoch_deadline(&mut self, delta: u64) {
         // Set a new deadline based on the "epoch deadline delta".
         //
@@ -1943,3 +2357,25 @@ impl<T: Copy> Drop for Reset<T> {
         }
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use crate::*;
+    use std::sync::Arc;
+
+    // Assert that resetting a store releases the modules instantiated in it.
+    #[test]
+    fn reset_releases_modules() -> anyhow::Result<()> {
+        let engine = Engine::default();
+        let mut store = Store::new(&engine, ());
+        let module = Module::new(&engine, "(module (func (export \"f\")))")?;
+        let compiled = Arc::downgrade(module.compiled_module());
+        Instance::new(&mut store, &module, &[])?;
+        drop(module);
+        assert!(compiled.upgrade().is_some());
+
+        store.reset();
+        assert!(compiled.upgrade().is_none());
+        Ok(())
+    }
+}
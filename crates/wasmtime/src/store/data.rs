@@ -48,18 +48,8 @@ impl_store_data! {
 
 impl StoreData {
     pub fn new() -> StoreData {
-        static NEXT_ID: AtomicU64 = AtomicU64::new(0);
-
-        // Only allow 2^63 stores at which point we start panicking to prevent
-        // overflow. This should still last us to effectively the end of time.
-        let id = NEXT_ID.fetch_add(1, SeqCst);
-        if id & (1 << 63) != 0 {
-            NEXT_ID.store(1 << 63, SeqCst);
-            panic!("store id allocator overflow");
-        }
-
         StoreData {
-            id: NonZeroU64::new(id + 1).unwrap(),
+            id: next_store_id(),
             funcs: Vec::new(),
             tables: Vec::new(),
             globals: Vec::new(),
@@ -68,6 +58,20 @@ impl StoreData {
         }
     }
 
+    /// Removes all items from this store, retaining the capacity of the
+    /// underlying lists.
+    ///
+    /// A fresh id is assigned as well so that `Stored` handles created before
+    /// the reset are rejected rather than aliasing new items.
+    pub fn reset(&mut self) {
+        self.id = next_store_id();
+        self.funcs.clear();
+        self.tables.clear();
+        self.globals.clear();
+        self.instances.clear();
+        self.memories.clear();
+    }
+
     pub fn insert<T>(&mut self, data: T) -> Stored<T>
     where
         T: StoredData,
@@ -109,6 +113,19 @@ impl StoreData {
     }
 }
 
+fn next_store_id() -> NonZeroU64 {
+    static NEXT_ID: AtomicU64 = AtomicU64::new(0);
+
+    // Only allow 2^63 stores at which point we start panicking to prevent
+    // overflow. This should still last us to effectively the end of time.
+    let id = NEXT_ID.fetch_add(1, SeqCst);
+    if id & (1 << 63) != 0 {
+        NEXT_ID.store(1 << 63, SeqCst);
+        panic!("store id allocator overflow");
+    }
+    NonZeroU64::new(id + 1).unwrap()
+}
+
 impl<T> Index<Stored<T>> for StoreData
 where
     T: StoredData,
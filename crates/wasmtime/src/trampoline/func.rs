@@ -4,8 +4,14 @@ use crate::module::BareModuleInfo;
 use crate::{Engine, FuncType, Trap, ValRaw};
 use anyhow::Result;
 use std::any::Any;
+#[cfg(compiler)]
+use std::collections::HashMap;
 use std::panic::{self, AssertUnwindSafe};
 use std::sync::Arc;
+#[cfg(compiler)]
+use std::sync::{Mutex, Weak};
+#[cfg(compiler)]
+use wasmtime_environ::WasmFuncType;
 use wasmtime_environ::{
     AnyfuncIndex, EntityIndex, FunctionInfo, Module, ModuleType, SignatureIndex,
 };
@@ -19,9 +25,46 @@ use wasmtime_runtime::{
 struct TrampolineState<F> {
     func: F,
     #[allow(dead_code)]
+    trampolines: Arc<HostTrampolines>,
+}
+
+/// The compiled trampolines of a host function.
+///
+/// The trampolines only depend on the function's signature and on the stub
+/// they call into, so they're shared between all host functions with the same
+/// signature and closure type. This is the common case when embedders define
+/// many functions through a single generic callback, as the C API does.
+#[cfg_attr(not(compiler), allow(dead_code))]
+struct HostTrampolines {
+    // Addresses within `code_memory` of the host-to-wasm and wasm-to-host
+    // trampolines. These are stored as integers so this type is `Send` and
+    // `Sync`, like `CodeMemory` itself.
+    host_trampoline: usize,
+    wasm_trampoline: (usize, usize),
+    #[allow(dead_code)]
     code_memory: CodeMemory,
 }
 
+/// A per-engine cache of the trampolines of host functions which are alive.
+///
+/// Entries are keyed by the function's type and the address of the stub it
+/// calls, and don't keep the trampolines themselves alive: once every host
+/// function using them is dropped their code is freed as usual.
+#[cfg(compiler)]
+#[derive(Default)]
+pub(crate) struct HostTrampolineCache {
+    state: Mutex<HostTrampolineCacheState>,
+}
+
+#[cfg(compiler)]
+#[derive(Default)]
+struct HostTrampolineCacheState {
+    entries: HashMap<(WasmFuncType, usize), Weak<HostTrampolines>>,
+    // When the number of entries reaches this, entries whose trampolines were
+    // freed are pruned.
+    prune_at: usize,
+}
+
 unsafe extern "C" fn stub_fn<F>(
     vmctx: *mut VMContext,
     caller_vmctx: *mut VMContext,
@@ -111,12 +154,79 @@ pub fn create_function<F>(
 where
     F: Fn(*mut VMContext, *mut ValRaw) -> Result<(), Trap> + Send + Sync + 'static,
 {
+    let trampolines =
+        engine
+            .host_trampolines()
+            .get_or_compile(engine, ft, stub_fn::<F> as usize)?;
+    let (wasm_start, wasm_len) = trampolines.wasm_trampoline;
+    let wasm_trampoline =
+        std::ptr::slice_from_raw_parts_mut(wasm_start as *mut VMFunctionBody, wasm_len);
+    let host_trampoline = trampolines.host_trampoline;
+
+    let sig = engine.signatures().register(ft.as_wasm_func_type());
+
+    unsafe {
+        let instance = create_raw_function(
+            wasm_trampoline,
+            sig,
+            Box::new(TrampolineState { func, trampolines }),
+        )?;
+        let host_trampoline = std::mem::transmute::<usize, VMTrampoline>(host_trampoline);
+        Ok((instance, host_trampoline))
+    }
+}
+
+#[cfg(compiler)]
+impl HostTrampolineCache {
+    fn get_or_compile(
+        &self,
+        engine: &Engine,
+        ft: &FuncType,
+        stub: usize,
+    ) -> Result<Arc<HostTrampolines>> {
+        let key = (ft.as_wasm_func_type().clone(), stub);
+        if let Some(trampolines) = self
+            .state
+            .lock()
+            .unwrap()
+            .entries
+            .get(&key)
+            .and_then(|t| t.upgrade())
+        {
+            return Ok(trampolines);
+        }
+
+        // Compile outside of the lock so that host functions with different
+        // signatures can be created concurrently. If another thread compiles
+        // the same trampolines in the meantime then either copy is fine to use.
+        let trampolines = Arc::new(compile_trampolines(engine, ft, stub)?);
+
+        let mut state = self.state.lock().unwrap();
+        if state.entries.len() >= state.prune_at {
+            state.entries.retain(|_, t| t.strong_count() > 0);
+            state.prune_at = (state.entries.len() * 2).max(16);
+        }
+        state.entries.insert(key, Arc::downgrade(&trampolines));
+        Ok(trampolines)
+    }
+
+    /// Returns how many distinct sets of trampolines in this cache are alive.
+    pub(crate) fn live_entries(&self) -> usize {
+        let state = self.state.lock().unwrap();
+        state
+            .entries
+            .values()
+            .filter(|t| t.strong_count() > 0)
+            .count()
+    }
+}
+
+#[cfg(compiler)]
+fn compile_trampolines(engine: &Engine, ft: &FuncType, stub: usize) -> Result<HostTrampolines> {
     let mut obj = engine.compiler().object()?;
-    let (t1, t2) = engine.compiler().emit_trampoline_obj(
-        ft.as_wasm_func_type(),
-        stub_fn::<F> as usize,
-        &mut obj,
-    )?;
+    let (t1, t2) = engine
+        .compiler()
+        .emit_trampoline_obj(ft.as_wasm_func_type(), stub, &mut obj)?;
     let obj = wasmtime_jit::mmap_vec_from_obj(obj)?;
 
     // Copy the results of JIT compilation into executable memory, and this will
@@ -128,21 +238,17 @@ where
 
     // Extract the host/wasm trampolines from the results of compilation since
     // we know their start/length.
-    let host_trampoline = code.text[t1.start as usize..][..t1.length as usize].as_ptr();
-    let wasm_trampoline = &code.text[t2.start as usize..][..t2.length as usize];
-    let wasm_trampoline = wasm_trampoline as *const [u8] as *mut [VMFunctionBody];
-
-    let sig = engine.signatures().register(ft.as_wasm_func_type());
+    let host_trampoline = code.text[t1.start as usize..].as_ptr() as usize;
+    let wasm_trampoline = (
+        code.text[t2.start as usize..].as_ptr() as usize,
+        t2.length as usize,
+    );
 
-    unsafe {
-        let instance = create_raw_function(
-            wasm_trampoline,
-            sig,
-            Box::new(TrampolineState { func, code_memory }),
-        )?;
-        let host_trampoline = std::mem::transmute::<*const u8, VMTrampoline>(host_trampoline);
-        Ok((instance, host_trampoline))
-    }
+    Ok(HostTrampolines {
+        host_trampoline,
+        wasm_trampoline,
+        code_memory,
+    })
 }
 
 pub unsafe fn create_raw_function(
@@ -38,6 +38,12 @@ impl RuntimeLinearMemory for LinearMemoryProxy {
         self.mem.maximum_byte_size()
     }
 
+    fn reserved_byte_size(&self) -> usize {
+        // How custom memories are allocated isn't known here, so only the
+        // accessible part is reported.
+        self.mem.byte_size()
+    }
+
     fn grow_to(&mut self, new_size: usize) -> Result<()> {
         self.mem.grow_to(new_size)
     }
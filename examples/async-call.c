@@ -0,0 +1,212 @@
+/*
+Example of calling WebAssembly asynchronously, where it in turn calls an
+asynchronous host function.
+
+You can compile and run this example on Linux with:
+
+   cargo build --release -p wasmtime-c-api
+   cc examples/async-call.c \
+       -I crates/c-api/include \
+       -I crates/c-api/wasm-c-api/include \
+       target/release/libwasmtime.a \
+       -lpthread -ldl -lm \
+       -o async-call
+   ./async-call
+
+Note that on Windows and macOS the command will be similar, but you'll need
+to tweak the `-lpthread` and such annotations.
+*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wasm.h>
+#include <wasmtime.h>
+
+static void exit_with_error(const char *message, wasmtime_error_t *error, wasm_trap_t *trap);
+
+// The state of a pending call to `sleep`, polled through its continuation.
+struct delay {
+  int polls_left;
+  int finalized;
+};
+
+struct host_state {
+  struct delay delay;
+  int finalized;
+};
+
+static bool delay_ready(void *env) {
+  struct delay *delay = env;
+  if (delay->polls_left == 0)
+    return true;
+  delay->polls_left--;
+  return false;
+}
+
+static void delay_finalize(void *env) {
+  struct delay *delay = env;
+  delay->finalized++;
+}
+
+// `sleep` completes after its argument's number of polls, returning twice its
+// argument, and traps right away for negative arguments.
+static void sleep_callback(void *env, wasmtime_caller_t *caller, const wasmtime_val_t *args,
+                           size_t nargs, wasmtime_val_t *results, size_t nresults,
+                           wasm_trap_t **trap_ret,
+                           wasmtime_async_continuation_t *continuation_ret) {
+  struct host_state *state = env;
+  int32_t polls = args[0].of.i32;
+  if (polls < 0) {
+    const char *message = "negative delay";
+    *trap_ret = wasmtime_trap_new(message, strlen(message));
+    return;
+  }
+  state->delay.polls_left = polls;
+  continuation_ret->callback = delay_ready;
+  continuation_ret->env = &state->delay;
+  continuation_ret->finalizer = delay_finalize;
+  results[0].kind = WASMTIME_I32;
+  results[0].of.i32 = polls * 2;
+}
+
+static void host_finalize(void *env) {
+  struct host_state *state = env;
+  state->finalized++;
+}
+
+// Polls a call to `run` until it completes and returns how many times it was
+// pending in the meantime.
+static int call_run(wasmtime_context_t *context, const wasmtime_func_t *run, int32_t arg,
+                    wasmtime_val_t *result, wasm_trap_t **trap, wasmtime_error_t **error) {
+  wasmtime_val_t params[1];
+  params[0].kind = WASMTIME_I32;
+  params[0].of.i32 = arg;
+  wasmtime_call_future_t *future =
+      wasmtime_func_call_async(context, run, params, 1, result, 1, trap, error);
+  int pending = 0;
+  while (!wasmtime_call_future_poll(future))
+    pending++;
+  wasmtime_call_future_delete(future);
+  return pending;
+}
+
+int main() {
+  wasm_config_t *config = wasm_config_new();
+  assert(config != NULL);
+  wasmtime_config_async_support_set(config, true);
+  wasm_engine_t *engine = wasm_engine_new_with_config(config);
+  assert(engine != NULL);
+  wasmtime_store_t *store = wasmtime_store_new(engine, NULL, NULL);
+  assert(store != NULL);
+  wasmtime_context_t *context = wasmtime_store_context(store);
+
+  struct host_state state = {{0, 0}, 0};
+  wasmtime_linker_t *linker = wasmtime_linker_new(engine);
+  assert(linker != NULL);
+  wasm_functype_t *sleep_ty = wasm_functype_new_1_1(wasm_valtype_new_i32(), wasm_valtype_new_i32());
+  wasmtime_error_t *error = wasmtime_linker_define_async_func(
+      linker, "host", strlen("host"), "sleep", strlen("sleep"), sleep_ty, sleep_callback, &state,
+      host_finalize);
+  wasm_functype_delete(sleep_ty);
+  if (error != NULL)
+    exit_with_error("failed to define host function", error, NULL);
+
+  // Load our input file to parse it next
+  FILE* file = fopen("examples/async-call.wat", "r");
+  if (!file) {
+    printf("> Error loading file!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t wat;
+  wasm_byte_vec_new_uninitialized(&wat, file_size);
+  if (fread(wat.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Parse the wat into the binary wasm format
+  wasm_byte_vec_t wasm;
+  error = wasmtime_wat2wasm(wat.data, wat.size, &wasm);
+  if (error != NULL)
+    exit_with_error("failed to parse wat", error, NULL);
+  wasm_byte_vec_delete(&wat);
+
+  // Compile our module and instantiate it asynchronously
+  wasmtime_module_t *module = NULL;
+  error = wasmtime_module_new(engine, (uint8_t*) wasm.data, wasm.size, &module);
+  if (module == NULL)
+    exit_with_error("failed to compile module", error, NULL);
+  wasm_byte_vec_delete(&wasm);
+
+  wasm_trap_t *trap = NULL;
+  wasmtime_instance_t instance;
+  wasmtime_call_future_t *future =
+      wasmtime_linker_instantiate_async(linker, context, module, &instance, &trap, &error);
+  while (!wasmtime_call_future_poll(future))
+    ;
+  wasmtime_call_future_delete(future);
+  if (error != NULL || trap != NULL)
+    exit_with_error("failed to instantiate", error, trap);
+
+  wasmtime_extern_t run;
+  bool ok = wasmtime_instance_export_get(context, &instance, "run", strlen("run"), &run);
+  assert(ok);
+  assert(run.kind == WASMTIME_EXTERN_FUNC);
+
+  // The call is pending once for each poll of the host function's
+  // continuation, which is finalized once the host function completes.
+  wasmtime_val_t result;
+  int pending = call_run(context, &run.of.func, 3, &result, &trap, &error);
+  if (error != NULL || trap != NULL)
+    exit_with_error("failed to call run", error, trap);
+  printf("run(3) = %d after %d polls\n", result.of.i32, pending + 1);
+  assert(pending == 3);
+  assert(result.kind == WASMTIME_I32);
+  assert(result.of.i32 == 7);
+  assert(state.delay.finalized == 1);
+
+  // A trap raised by the host function completes the call right away.
+  pending = call_run(context, &run.of.func, -1, &result, &trap, &error);
+  if (error != NULL)
+    exit_with_error("failed to call run", error, NULL);
+  if (trap == NULL) {
+    printf("> run(-1) should have trapped!\n");
+    return 1;
+  }
+  wasm_byte_vec_t trap_message;
+  wasm_trap_message(trap, &trap_message);
+  printf("run(-1) trapped: %.*s\n", (int) trap_message.size, trap_message.data);
+  wasm_byte_vec_delete(&trap_message);
+  wasm_trap_delete(trap);
+  assert(pending == 0);
+  assert(state.delay.finalized == 1);
+
+  // The instance keeps the host function alive after the linker is deleted,
+  // so its finalizer only runs once the store is deleted too.
+  wasmtime_module_delete(module);
+  wasmtime_linker_delete(linker);
+  assert(state.finalized == 0);
+  wasmtime_store_delete(store);
+  assert(state.finalized == 1);
+  wasm_engine_delete(engine);
+  return 0;
+}
+
+static void exit_with_error(const char *message, wasmtime_error_t *error, wasm_trap_t *trap) {
+  fprintf(stderr, "error: %s\n", message);
+  wasm_byte_vec_t error_message;
+  if (error != NULL) {
+    wasmtime_error_message(error, &error_message);
+  } else {
+    wasm_trap_message(trap, &error_message);
+  }
+  fprintf(stderr, "%.*s\n", (int) error_message.size, error_message.data);
+  wasm_byte_vec_delete(&error_message);
+  exit(1);
+}
@@ -0,0 +1,44 @@
+//! Example of calling WebAssembly asynchronously, where it in turn calls an
+//! asynchronous host function.
+
+// You can execute this example with `cargo run --example async-call`
+
+use anyhow::Result;
+use wasmtime::*;
+
+#[tokio::main]
+async fn main() -> Result<()> {
+    let mut config = Config::new();
+    config.async_support(true);
+    let engine = Engine::new(&config)?;
+    let mut store = Store::new(&engine, ());
+
+    // `sleep` yields back to the executor `polls` times before returning
+    // twice its argument, and traps for negative arguments.
+    let mut linker = Linker::new(&engine);
+    linker.func_wrap1_async("host", "sleep", |_caller, polls: i32| {
+        Box::new(async move {
+            if polls < 0 {
+                return Err(Trap::new("negative delay"));
+            }
+            for _ in 0..polls {
+                tokio::task::yield_now().await;
+            }
+            Ok(polls * 2)
+        })
+    })?;
+
+    let module = Module::from_file(&engine, "examples/async-call.wat")?;
+    let instance = linker.instantiate_async(&mut store, &module).await?;
+    let run = instance.get_typed_func::<i32, i32, _>(&mut store, "run")?;
+
+    let result = run.call_async(&mut store, 3).await?;
+    println!("run(3) = {}", result);
+    assert_eq!(result, 7);
+
+    match run.call_async(&mut store, -1).await {
+        Ok(_) => panic!("run(-1) should have trapped"),
+        Err(trap) => println!("run(-1) trapped: {}", trap),
+    }
+    Ok(())
+}
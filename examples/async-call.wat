@@ -0,0 +1,8 @@
+(module
+  (import "host" "sleep" (func $sleep (param i32) (result i32)))
+  (func (export "run") (param i32) (result i32)
+    local.get 0
+    call $sleep
+    i32.const 1
+    i32.add)
+)
@@ -0,0 +1,159 @@
+/*
+Example of extending a store's epoch deadline from a callback instead of
+trapping as soon as it's reached.
+
+You can compile and run this example on Linux with:
+
+   cargo build --release -p wasmtime-c-api
+   cc examples/epoch-callback.c \
+       -I crates/c-api/include \
+       -I crates/c-api/wasm-c-api/include \
+       target/release/libwasmtime.a \
+       -lpthread -ldl -lm \
+       -o epoch-callback
+   ./epoch-callback
+
+Note that on Windows and macOS the command will be similar, but you'll need
+to tweak the `-lpthread` and such annotations.
+*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wasm.h>
+#include <wasmtime.h>
+
+static void exit_with_error(const char *message, wasmtime_error_t *error, wasm_trap_t *trap);
+
+struct extend_state {
+  int extensions;
+  int finalized;
+};
+
+static wasmtime_error_t *extend(wasmtime_context_t *context, void *env, uint64_t *delta,
+                                wasmtime_deadline_action_t *action) {
+  struct extend_state *state = env;
+  state->extensions++;
+  printf("Epoch deadline reached, extension #%d\n", state->extensions);
+  // Give the store another tick a few times, then let it trap.
+  if (state->extensions > 3)
+    return wasmtime_error_new("extended too many times");
+  *delta = 1;
+  *action = WASMTIME_DEADLINE_ACTION_EXTEND;
+  return NULL;
+}
+
+static void finalize_extend(void *env) {
+  struct extend_state *state = env;
+  state->finalized++;
+}
+
+// Each call to `tick` advances the epoch, standing in for a timer thread.
+static wasm_trap_t *tick(void *env, wasmtime_caller_t *caller, const wasmtime_val_t *args,
+                         size_t nargs, wasmtime_val_t *results, size_t nresults) {
+  wasmtime_engine_increment_epoch((wasm_engine_t*) env);
+  return NULL;
+}
+
+int main() {
+  wasmtime_error_t *error = NULL;
+
+  wasm_config_t *config = wasm_config_new();
+  assert(config != NULL);
+  wasmtime_config_epoch_interruption_set(config, true);
+  wasm_engine_t *engine = wasm_engine_new_with_config(config);
+  assert(engine != NULL);
+  wasmtime_store_t *store = wasmtime_store_new(engine, NULL, NULL);
+  assert(store != NULL);
+  wasmtime_context_t *context = wasmtime_store_context(store);
+  wasmtime_context_set_epoch_deadline(context, 1);
+
+  struct extend_state state = {0, 0};
+  wasmtime_context_epoch_deadline_callback(context, extend, &state, finalize_extend);
+  // The store owns `state` now, and only releases it when it's deleted.
+  assert(state.finalized == 0);
+
+  // Load our input file to parse it next
+  FILE* file = fopen("examples/epoch-callback.wat", "r");
+  if (!file) {
+    printf("> Error loading file!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t wat;
+  wasm_byte_vec_new_uninitialized(&wat, file_size);
+  if (fread(wat.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Parse the wat into the binary wasm format
+  wasm_byte_vec_t wasm;
+  error = wasmtime_wat2wasm(wat.data, wat.size, &wasm);
+  if (error != NULL)
+    exit_with_error("failed to parse wat", error, NULL);
+  wasm_byte_vec_delete(&wat);
+
+  // Compile and instantiate our module
+  wasmtime_module_t *module = NULL;
+  error = wasmtime_module_new(engine, (uint8_t*) wasm.data, wasm.size, &module);
+  if (module == NULL)
+    exit_with_error("failed to compile module", error, NULL);
+  wasm_byte_vec_delete(&wasm);
+
+  wasm_functype_t *tick_ty = wasm_functype_new_0_0();
+  wasmtime_func_t tick_func;
+  wasmtime_func_new(context, tick_ty, tick, engine, NULL, &tick_func);
+  wasm_functype_delete(tick_ty);
+
+  wasm_trap_t *trap = NULL;
+  wasmtime_instance_t instance;
+  wasmtime_extern_t import;
+  import.kind = WASMTIME_EXTERN_FUNC;
+  import.of.func = tick_func;
+  error = wasmtime_instance_new(context, module, &import, 1, &instance, &trap);
+  if (error != NULL || trap != NULL)
+    exit_with_error("failed to instantiate", error, trap);
+
+  wasmtime_extern_t run;
+  bool ok = wasmtime_instance_export_get(context, &instance, "run", strlen("run"), &run);
+  assert(ok);
+  assert(run.kind == WASMTIME_EXTERN_FUNC);
+
+  error = wasmtime_func_call(context, &run.of.func, NULL, 0, NULL, 0, &trap);
+  if (error == NULL && trap == NULL) {
+    printf("> run loops forever and should have trapped!\n");
+    return 1;
+  }
+  printf("Trapped after %d extensions\n", state.extensions);
+  assert(state.extensions == 4);
+  assert(state.finalized == 0);
+  if (error != NULL)
+    wasmtime_error_delete(error);
+  if (trap != NULL)
+    wasm_trap_delete(trap);
+
+  // Deleting the store runs the finalizer exactly once.
+  wasmtime_module_delete(module);
+  wasmtime_store_delete(store);
+  assert(state.finalized == 1);
+  wasm_engine_delete(engine);
+  return 0;
+}
+
+static void exit_with_error(const char *message, wasmtime_error_t *error, wasm_trap_t *trap) {
+  fprintf(stderr, "error: %s\n", message);
+  wasm_byte_vec_t error_message;
+  if (error != NULL) {
+    wasmtime_error_message(error, &error_message);
+  } else {
+    wasm_trap_message(trap, &error_message);
+  }
+  fprintf(stderr, "%.*s\n", (int) error_message.size, error_message.data);
+  wasm_byte_vec_delete(&error_message);
+  exit(1);
+}
@@ -0,0 +1,40 @@
+//! Example of extending a store's epoch deadline from a callback instead of
+//! trapping as soon as it's reached.
+
+// You can execute this example with `cargo run --example epoch-callback`
+
+use anyhow::Result;
+use wasmtime::*;
+
+fn main() -> Result<()> {
+    let mut config = Config::new();
+    config.epoch_interruption(true);
+    let engine = Engine::new(&config)?;
+    let mut store = Store::new(&engine, ());
+    store.set_epoch_deadline(1);
+
+    // Give the store another tick a few times, then let it trap.
+    let mut extensions = 0;
+    store.epoch_deadline_callback(move |_store| {
+        extensions += 1;
+        println!("Epoch deadline reached, extension #{}", extensions);
+        if extensions > 3 {
+            anyhow::bail!("extended too many times");
+        }
+        Ok(DeadlineAction::Extend(1))
+    });
+
+    // Each call to `tick` advances the epoch, standing in for a timer thread.
+    let tick = Func::wrap(&mut store, |caller: Caller<'_, ()>| {
+        caller.engine().increment_epoch();
+    });
+
+    let module = Module::from_file(store.engine(), "examples/epoch-callback.wat")?;
+    let instance = Instance::new(&mut store, &module, &[tick.into()])?;
+    let run = instance.get_typed_func::<(), (), _>(&mut store, "run")?;
+    match run.call(&mut store, ()) {
+        Ok(_) => panic!("run loops forever and should have trapped"),
+        Err(trap) => println!("Trapped: {}", trap),
+    }
+    Ok(())
+}
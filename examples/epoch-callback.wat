@@ -0,0 +1,8 @@
+(module
+  (import "" "tick" (func $tick))
+  (func (export "run")
+    (loop
+      call $tick
+      br 0)
+  )
+)
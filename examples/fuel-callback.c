@@ -0,0 +1,150 @@
+/*
+Example of refueling a store from a callback whenever it runs out of fuel.
+
+You can compile and run this example on Linux with:
+
+   cargo build --release -p wasmtime-c-api
+   cc examples/fuel-callback.c \
+       -I crates/c-api/include \
+       -I crates/c-api/wasm-c-api/include \
+       target/release/libwasmtime.a \
+       -lpthread -ldl -lm \
+       -o fuel-callback
+   ./fuel-callback
+
+Note that on Windows and macOS the command will be similar, but you'll need
+to tweak the `-lpthread` and such annotations.
+*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wasm.h>
+#include <wasmtime.h>
+
+static void exit_with_error(const char *message, wasmtime_error_t *error, wasm_trap_t *trap);
+
+struct refuel_state {
+  int refuels;
+  int finalized;
+};
+
+static wasmtime_error_t *refuel(wasmtime_context_t *context, void *env, uint64_t *fuel,
+                                wasmtime_fuel_action_t *action) {
+  struct refuel_state *state = env;
+  state->refuels++;
+  printf("Out of fuel, refuel #%d\n", state->refuels);
+  // Refuel the store a few times, then let it trap.
+  if (state->refuels > 3)
+    return wasmtime_error_new("refueled too many times");
+  *fuel = 1000;
+  *action = WASMTIME_FUEL_ACTION_REFUEL;
+  return NULL;
+}
+
+static void finalize_refuel(void *env) {
+  struct refuel_state *state = env;
+  state->finalized++;
+}
+
+int main() {
+  wasmtime_error_t *error = NULL;
+
+  wasm_config_t *config = wasm_config_new();
+  assert(config != NULL);
+  wasmtime_config_consume_fuel_set(config, true);
+  wasm_engine_t *engine = wasm_engine_new_with_config(config);
+  assert(engine != NULL);
+  wasmtime_store_t *store = wasmtime_store_new(engine, NULL, NULL);
+  assert(store != NULL);
+  wasmtime_context_t *context = wasmtime_store_context(store);
+
+  error = wasmtime_context_add_fuel(context, 1000);
+  if (error != NULL)
+    exit_with_error("failed to add fuel", error, NULL);
+
+  struct refuel_state state = {0, 0};
+  wasmtime_context_out_of_fuel_callback(context, refuel, &state, finalize_refuel);
+  // The store owns `state` now, and only releases it when it's deleted.
+  assert(state.finalized == 0);
+
+  // Load our input file to parse it next
+  FILE* file = fopen("examples/fuel.wat", "r");
+  if (!file) {
+    printf("> Error loading file!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t wat;
+  wasm_byte_vec_new_uninitialized(&wat, file_size);
+  if (fread(wat.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Parse the wat into the binary wasm format
+  wasm_byte_vec_t wasm;
+  error = wasmtime_wat2wasm(wat.data, wat.size, &wasm);
+  if (error != NULL)
+    exit_with_error("failed to parse wat", error, NULL);
+  wasm_byte_vec_delete(&wat);
+
+  // Compile and instantiate our module
+  wasmtime_module_t *module = NULL;
+  error = wasmtime_module_new(engine, (uint8_t*) wasm.data, wasm.size, &module);
+  if (module == NULL)
+    exit_with_error("failed to compile module", error, NULL);
+  wasm_byte_vec_delete(&wasm);
+
+  wasm_trap_t *trap = NULL;
+  wasmtime_instance_t instance;
+  error = wasmtime_instance_new(context, module, NULL, 0, &instance, &trap);
+  if (error != NULL || trap != NULL)
+    exit_with_error("failed to instantiate", error, trap);
+
+  wasmtime_extern_t fib;
+  bool ok = wasmtime_instance_export_get(context, &instance, "fibonacci", strlen("fibonacci"), &fib);
+  assert(ok);
+  assert(fib.kind == WASMTIME_EXTERN_FUNC);
+
+  wasmtime_val_t params[1];
+  params[0].kind = WASMTIME_I32;
+  params[0].of.i32 = 30;
+  wasmtime_val_t results[1];
+  error = wasmtime_func_call(context, &fib.of.func, params, 1, results, 1, &trap);
+  if (error == NULL && trap == NULL) {
+    printf("> fib(30) shouldn't fit in 4000 fuel!\n");
+    return 1;
+  }
+  printf("Trapped after %d refuels\n", state.refuels);
+  assert(state.refuels == 4);
+  assert(state.finalized == 0);
+  if (error != NULL)
+    wasmtime_error_delete(error);
+  if (trap != NULL)
+    wasm_trap_delete(trap);
+
+  // Deleting the store runs the finalizer exactly once.
+  wasmtime_module_delete(module);
+  wasmtime_store_delete(store);
+  assert(state.finalized == 1);
+  wasm_engine_delete(engine);
+  return 0;
+}
+
+static void exit_with_error(const char *message, wasmtime_error_t *error, wasm_trap_t *trap) {
+  fprintf(stderr, "error: %s\n", message);
+  wasm_byte_vec_t error_message;
+  if (error != NULL) {
+    wasmtime_error_message(error, &error_message);
+  } else {
+    wasm_trap_message(trap, &error_message);
+  }
+  fprintf(stderr, "%.*s\n", (int) error_message.size, error_message.data);
+  wasm_byte_vec_delete(&error_message);
+  exit(1);
+}
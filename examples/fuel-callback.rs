@@ -0,0 +1,34 @@
+//! Example of refueling a store from a callback whenever it runs out of fuel.
+
+// You can execute this example with `cargo run --example fuel-callback`
+
+use anyhow::Result;
+use wasmtime::*;
+
+fn main() -> Result<()> {
+    let mut config = Config::new();
+    config.consume_fuel(true);
+    let engine = Engine::new(&config)?;
+    let mut store = Store::new(&engine, ());
+    store.add_fuel(1_000)?;
+
+    // Refuel the store a few times, then let it trap.
+    let mut refuels = 0;
+    store.out_of_fuel_callback(move |_store| {
+        refuels += 1;
+        println!("Out of fuel, refuel #{}", refuels);
+        if refuels > 3 {
+            anyhow::bail!("refueled too many times");
+        }
+        Ok(FuelAction::Refuel(1_000))
+    });
+
+    let module = Module::from_file(store.engine(), "examples/fuel.wat")?;
+    let instance = Instance::new(&mut store, &module, &[])?;
+    let fibonacci = instance.get_typed_func::<i32, i32, _>(&mut store, "fibonacci")?;
+    match fibonacci.call(&mut store, 30) {
+        Ok(_) => panic!("fib(30) shouldn't fit in 4000 fuel"),
+        Err(trap) => println!("Trapped: {}", trap),
+    }
+    Ok(())
+}
@@ -0,0 +1,188 @@
+/*
+Example of defining many host functions in a linker at once and stamping out
+copies of it.
+
+You can compile and run this example on Linux with:
+
+   cargo build --release -p wasmtime-c-api
+   cc examples/linking-table.c \
+       -I crates/c-api/include \
+       -I crates/c-api/wasm-c-api/include \
+       target/release/libwasmtime.a \
+       -lpthread -ldl -lm \
+       -o linking-table
+   ./linking-table
+
+Note that on Windows and macOS the command will be similar, but you'll need
+to tweak the `-lpthread` and such annotations.
+*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wasm.h>
+#include <wasmtime.h>
+
+static void exit_with_error(const char *message, wasmtime_error_t *error, wasm_trap_t *trap);
+
+struct constant {
+  int32_t value;
+  int finalized;
+};
+
+static wasm_trap_t *get_constant(void *env, wasmtime_caller_t *caller, const wasmtime_val_t *args,
+                                 size_t nargs, wasmtime_val_t *results, size_t nresults) {
+  struct constant *constant = env;
+  results[0].kind = WASMTIME_I32;
+  results[0].of.i32 = constant->value;
+  return NULL;
+}
+
+static void finalize_constant(void *env) {
+  struct constant *constant = env;
+  constant->finalized++;
+}
+
+static wasmtime_linker_func_entry_t entry(const char *name, const wasm_functype_t *ty,
+                                          struct constant *constant) {
+  wasmtime_linker_func_entry_t entry;
+  entry.module = "host";
+  entry.module_len = strlen("host");
+  entry.name = name;
+  entry.name_len = strlen(name);
+  entry.ty = ty;
+  entry.callback = get_constant;
+  entry.data = constant;
+  entry.finalizer = finalize_constant;
+  return entry;
+}
+
+int main() {
+  wasm_engine_t *engine = wasm_engine_new();
+  assert(engine != NULL);
+  wasmtime_linker_t *template = wasmtime_linker_new(engine);
+  assert(template != NULL);
+  wasm_functype_t *ty = wasm_functype_new_0_1(wasm_valtype_new_i32());
+
+  // Define a table of functions in which the third entry reuses the name of
+  // the first. The functions before it are defined and owned by the linker,
+  // and the failing entry and those after it are finalized right away.
+  struct constant constants[4] = {{1, 0}, {2, 0}, {3, 0}, {4, 0}};
+  wasmtime_linker_func_entry_t entries[4] = {
+    entry("one", ty, &constants[0]),
+    entry("two", ty, &constants[1]),
+    entry("one", ty, &constants[2]),
+    entry("three", ty, &constants[3]),
+  };
+  wasmtime_error_t *error = wasmtime_linker_define_func_table(template, entries, 4);
+  if (error == NULL) {
+    printf("> defining `one` twice should fail!\n");
+    return 1;
+  }
+  wasmtime_error_delete(error);
+  assert(constants[0].finalized == 0);
+  assert(constants[1].finalized == 0);
+  assert(constants[2].finalized == 1);
+  assert(constants[3].finalized == 1);
+
+  // The same goes for names which aren't valid UTF-8.
+  struct constant invalid[2] = {{5, 0}, {6, 0}};
+  wasmtime_linker_func_entry_t invalid_entries[2] = {
+    entry("\xff", ty, &invalid[0]),
+    entry("four", ty, &invalid[1]),
+  };
+  error = wasmtime_linker_define_func_table(template, invalid_entries, 2);
+  if (error == NULL) {
+    printf("> defining a name that isn't UTF-8 should fail!\n");
+    return 1;
+  }
+  wasmtime_error_delete(error);
+  assert(invalid[0].finalized == 1);
+  assert(invalid[1].finalized == 1);
+  wasm_functype_delete(ty);
+
+  // Copies of the template share its host functions, so they stay alive after
+  // the template is deleted.
+  wasmtime_linker_t *linker = wasmtime_linker_clone(template);
+  assert(linker != NULL);
+  wasmtime_linker_delete(template);
+  assert(constants[0].finalized == 0);
+  assert(constants[1].finalized == 0);
+
+  // Load our input file to parse it next
+  FILE* file = fopen("examples/linking-table.wat", "r");
+  if (!file) {
+    printf("> Error loading file!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t wat;
+  wasm_byte_vec_new_uninitialized(&wat, file_size);
+  if (fread(wat.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Parse the wat into the binary wasm format
+  wasm_byte_vec_t wasm;
+  error = wasmtime_wat2wasm(wat.data, wat.size, &wasm);
+  if (error != NULL)
+    exit_with_error("failed to parse wat", error, NULL);
+  wasm_byte_vec_delete(&wat);
+
+  // Compile and instantiate our module with the copy of the template
+  wasmtime_module_t *module = NULL;
+  error = wasmtime_module_new(engine, (uint8_t*) wasm.data, wasm.size, &module);
+  if (module == NULL)
+    exit_with_error("failed to compile module", error, NULL);
+  wasm_byte_vec_delete(&wasm);
+
+  wasmtime_store_t *store = wasmtime_store_new(engine, NULL, NULL);
+  assert(store != NULL);
+  wasmtime_context_t *context = wasmtime_store_context(store);
+  wasm_trap_t *trap = NULL;
+  wasmtime_instance_t instance;
+  error = wasmtime_linker_instantiate(linker, context, module, &instance, &trap);
+  if (error != NULL || trap != NULL)
+    exit_with_error("failed to instantiate", error, trap);
+
+  wasmtime_extern_t run;
+  bool ok = wasmtime_instance_export_get(context, &instance, "run", strlen("run"), &run);
+  assert(ok);
+  assert(run.kind == WASMTIME_EXTERN_FUNC);
+
+  wasmtime_val_t results[1];
+  error = wasmtime_func_call(context, &run.of.func, NULL, 0, results, 1, &trap);
+  if (error != NULL || trap != NULL)
+    exit_with_error("failed to call run", error, trap);
+  assert(results[0].kind == WASMTIME_I32);
+  printf("one + two = %d\n", results[0].of.i32);
+  assert(results[0].of.i32 == 3);
+
+  // Once nothing uses the host functions anymore they're finalized exactly
+  // once.
+  wasmtime_module_delete(module);
+  wasmtime_store_delete(store);
+  wasmtime_linker_delete(linker);
+  assert(constants[0].finalized == 1);
+  assert(constants[1].finalized == 1);
+  wasm_engine_delete(engine);
+  return 0;
+}
+
+static void exit_with_error(const char *message, wasmtime_error_t *error, wasm_trap_t *trap) {
+  fprintf(stderr, "error: %s\n", message);
+  wasm_byte_vec_t error_message;
+  if (error != NULL) {
+    wasmtime_error_message(error, &error_message);
+  } else {
+    wasm_trap_message(trap, &error_message);
+  }
+  fprintf(stderr, "%.*s\n", (int) error_message.size, error_message.data);
+  wasm_byte_vec_delete(&error_message);
+  exit(1);
+}
@@ -0,0 +1,44 @@
+//! Example of defining many host functions in a linker at once and stamping
+//! out copies of it.
+
+// You can execute this example with `cargo run --example linking-table`
+
+use anyhow::Result;
+use wasmtime::*;
+
+fn main() -> Result<()> {
+    let engine = Engine::default();
+
+    // Define all of the host functions in a template linker up front.
+    let names = ["one", "two", "three"];
+    let mut template = Linker::new(&engine);
+    template.reserve(names.len());
+    for (i, name) in names.iter().enumerate() {
+        let value = i as i32 + 1;
+        template.func_new(
+            "host",
+            name,
+            FuncType::new(None, Some(ValType::I32)),
+            move |_, _, results| {
+                results[0] = Val::I32(value);
+                Ok(())
+            },
+        )?;
+    }
+
+    // Names still can't be defined twice.
+    assert!(template.func_wrap("host", "one", || 1).is_err());
+
+    // Copies of the template share its host functions.
+    let linker = template.clone();
+    drop(template);
+
+    let module = Module::from_file(&engine, "examples/linking-table.wat")?;
+    let mut store = Store::new(&engine, ());
+    let instance = linker.instantiate(&mut store, &module)?;
+    let run = instance.get_typed_func::<(), i32, _>(&mut store, "run")?;
+    let result = run.call(&mut store, ())?;
+    println!("one + two = {}", result);
+    assert_eq!(result, 3);
+    Ok(())
+}
@@ -0,0 +1,6 @@
+(module
+  (import "host" "one" (func $one (result i32)))
+  (import "host" "two" (func $two (result i32)))
+  (func (export "run") (result i32)
+    (i32.add (call $one) (call $two)))
+)
@@ -0,0 +1,145 @@
+/*
+Example of checking a function's type once up front and then calling it
+without per-call checks.
+
+You can compile and run this example on Linux with:
+
+   cargo build --release -p wasmtime-c-api
+   cc examples/typed-call.c \
+       -I crates/c-api/include \
+       -I crates/c-api/wasm-c-api/include \
+       target/release/libwasmtime.a \
+       -lpthread -ldl -lm \
+       -o typed-call
+   ./typed-call
+
+Note that on Windows and macOS the command will be similar, but you'll need
+to tweak the `-lpthread` and such annotations.
+*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wasm.h>
+#include <wasmtime.h>
+
+static void exit_with_error(const char *message, wasmtime_error_t *error, wasm_trap_t *trap);
+
+int main() {
+  wasm_engine_t *engine = wasm_engine_new();
+  assert(engine != NULL);
+  wasmtime_store_t *store = wasmtime_store_new(engine, NULL, NULL);
+  assert(store != NULL);
+  wasmtime_context_t *context = wasmtime_store_context(store);
+
+  // Load our input file to parse it next
+  FILE* file = fopen("examples/typed-call.wat", "r");
+  if (!file) {
+    printf("> Error loading file!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t wat;
+  wasm_byte_vec_new_uninitialized(&wat, file_size);
+  if (fread(wat.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Parse the wat into the binary wasm format
+  wasm_byte_vec_t wasm;
+  wasmtime_error_t *error = wasmtime_wat2wasm(wat.data, wat.size, &wasm);
+  if (error != NULL)
+    exit_with_error("failed to parse wat", error, NULL);
+  wasm_byte_vec_delete(&wat);
+
+  // Compile and instantiate our module
+  wasmtime_module_t *module = NULL;
+  error = wasmtime_module_new(engine, (uint8_t*) wasm.data, wasm.size, &module);
+  if (module == NULL)
+    exit_with_error("failed to compile module", error, NULL);
+  wasm_byte_vec_delete(&wasm);
+
+  wasm_trap_t *trap = NULL;
+  wasmtime_instance_t instance;
+  error = wasmtime_instance_new(context, module, NULL, 0, &instance, &trap);
+  if (error != NULL || trap != NULL)
+    exit_with_error("failed to instantiate", error, trap);
+
+  wasmtime_extern_t div;
+  bool ok = wasmtime_instance_export_get(context, &instance, "div", strlen("div"), &div);
+  assert(ok);
+  assert(div.kind == WASMTIME_EXTERN_FUNC);
+
+  // The type is checked when the typed function is created, and a mismatch
+  // leaves `typed` unwritten.
+  wasmtime_typed_func_t *typed = NULL;
+  wasm_functype_t *wrong_ty = wasm_functype_new_2_1(
+      wasm_valtype_new_i64(), wasm_valtype_new_i64(), wasm_valtype_new_i64());
+  error = wasmtime_typed_func_new(context, &div.of.func, wrong_ty, &typed);
+  wasm_functype_delete(wrong_ty);
+  if (error == NULL) {
+    printf("> creating a typed function with the wrong type should fail!\n");
+    return 1;
+  }
+  wasm_byte_vec_t error_message;
+  wasmtime_error_message(error, &error_message);
+  printf("Type mismatch: %.*s\n", (int) error_message.size, error_message.data);
+  wasm_byte_vec_delete(&error_message);
+  wasmtime_error_delete(error);
+  assert(typed == NULL);
+
+  wasm_functype_t *ty = wasm_functype_new_2_1(
+      wasm_valtype_new_i32(), wasm_valtype_new_i32(), wasm_valtype_new_i32());
+  error = wasmtime_typed_func_new(context, &div.of.func, ty, &typed);
+  wasm_functype_delete(ty);
+  if (error != NULL)
+    exit_with_error("failed to create typed function", error, NULL);
+  assert(typed != NULL);
+  assert(wasmtime_typed_func_args_and_results_len(typed) == 2);
+
+  // Parameters are read from, and results written to, the same raw slots.
+  wasmtime_val_raw_t args_and_results[2];
+  args_and_results[0].i32 = 42;
+  args_and_results[1].i32 = 7;
+  trap = wasmtime_typed_func_call(context, typed, args_and_results);
+  if (trap != NULL)
+    exit_with_error("failed to call div", NULL, trap);
+  printf("42 / 7 = %d\n", args_and_results[0].i32);
+  assert(args_and_results[0].i32 == 6);
+
+  args_and_results[0].i32 = 1;
+  args_and_results[1].i32 = 0;
+  trap = wasmtime_typed_func_call(context, typed, args_and_results);
+  if (trap == NULL) {
+    printf("> dividing by zero should have trapped!\n");
+    return 1;
+  }
+  wasm_trap_message(trap, &error_message);
+  printf("1 / 0 trapped: %.*s\n", (int) error_message.size, error_message.data);
+  wasm_byte_vec_delete(&error_message);
+  wasm_trap_delete(trap);
+
+  wasmtime_typed_func_delete(typed);
+  wasmtime_module_delete(module);
+  wasmtime_store_delete(store);
+  wasm_engine_delete(engine);
+  return 0;
+}
+
+static void exit_with_error(const char *message, wasmtime_error_t *error, wasm_trap_t *trap) {
+  fprintf(stderr, "error: %s\n", message);
+  wasm_byte_vec_t error_message;
+  if (error != NULL) {
+    wasmtime_error_message(error, &error_message);
+  } else {
+    wasm_trap_message(trap, &error_message);
+  }
+  fprintf(stderr, "%.*s\n", (int) error_message.size, error_message.data);
+  wasm_byte_vec_delete(&error_message);
+  exit(1);
+}
@@ -0,0 +1,30 @@
+//! Example of checking a function's type once up front and then calling it
+//! without per-call checks.
+
+// You can execute this example with `cargo run --example typed-call`
+
+use anyhow::Result;
+use wasmtime::*;
+
+fn main() -> Result<()> {
+    let engine = Engine::default();
+    let mut store = Store::new(&engine, ());
+    let module = Module::from_file(&engine, "examples/typed-call.wat")?;
+    let instance = Instance::new(&mut store, &module, &[])?;
+
+    // The type is checked when the typed function is created.
+    assert!(instance
+        .get_typed_func::<(i64, i64), i64, _>(&mut store, "div")
+        .is_err());
+    let div = instance.get_typed_func::<(i32, i32), i32, _>(&mut store, "div")?;
+
+    let result = div.call(&mut store, (42, 7))?;
+    println!("42 / 7 = {}", result);
+    assert_eq!(result, 6);
+
+    match div.call(&mut store, (1, 0)) {
+        Ok(_) => panic!("dividing by zero should have trapped"),
+        Err(trap) => println!("1 / 0 trapped: {}", trap),
+    }
+    Ok(())
+}
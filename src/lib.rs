@@ -99,15 +99,16 @@ use wasmtime::{Config, ProfilingStrategy};
 #[cfg(feature = "pooling-allocator")]
 use wasmtime::{InstanceLimits, PoolingAllocationStrategy};
 
-fn pick_profiling_strategy(jitdump: bool, vtune: bool) -> Result<ProfilingStrategy> {
-    Ok(match (jitdump, vtune) {
-        (true, false) => ProfilingStrategy::JitDump,
-        (false, true) => ProfilingStrategy::VTune,
-        (true, true) => {
-            println!("Can't enable --jitdump and --vtune at the same time. Profiling not enabled.");
+fn pick_profiling_strategy(jitdump: bool, vtune: bool, perfmap: bool) -> Result<ProfilingStrategy> {
+    Ok(match (jitdump, vtune, perfmap) {
+        (true, false, false) => ProfilingStrategy::JitDump,
+        (false, true, false) => ProfilingStrategy::VTune,
+        (false, false, true) => ProfilingStrategy::PerfMap,
+        (false, false, false) => ProfilingStrategy::None,
+        _ => {
+            println!("Can't enable more than one of --jitdump, --vtune and --perfmap at the same time. Profiling not enabled.");
             ProfilingStrategy::None
         }
-        _ => ProfilingStrategy::None,
     })
 }
 
@@ -169,13 +170,17 @@ struct CommonOptions {
     wasi_modules: Option<WasiModules>,
 
     /// Generate jitdump file (supported on --features=profiling build)
-    #[structopt(long, conflicts_with = "vtune")]
+    #[structopt(long, conflicts_with_all = &["vtune", "perfmap"])]
     jitdump: bool,
 
     /// Generate vtune (supported on --features=vtune build)
-    #[structopt(long, conflicts_with = "jitdump")]
+    #[structopt(long, conflicts_with_all = &["jitdump", "perfmap"])]
     vtune: bool,
 
+    /// Generate a perf map file in /tmp (supported on Linux)
+    #[structopt(long, conflicts_with_all = &["jitdump", "vtune"])]
+    perfmap: bool,
+
     /// Run optimization passes on translated functions, on by default
     #[structopt(short = "O", long)]
     optimize: bool,
@@ -294,7 +299,11 @@ impl CommonOptions {
             .cranelift_debug_verifier(self.enable_cranelift_debug_verifier)
             .debug_info(self.debug_info)
             .cranelift_opt_level(self.opt_level())
-            .profiler(pick_profiling_strategy(self.jitdump, self.vtune)?)?
+            .profiler(pick_profiling_strategy(
+                self.jitdump,
+                self.vtune,
+                self.perfmap,
+            )?)?
             .cranelift_nan_canonicalization(self.enable_cranelift_nan_canonicalization);
 
         self.enable_wasm_features(&mut config);
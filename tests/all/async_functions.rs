@@ -390,6 +390,58 @@ fn iloop_with_fuel() {
     }
 }
 
+#[test]
+fn out_of_fuel_callback_yields() {
+    let engine = Engine::new(Config::new().async_support(true).consume_fuel(true)).unwrap();
+    let mut store = Store::new(&engine, 0);
+    store.out_of_fuel_callback(|mut cx| {
+        *cx.data_mut() += 1;
+        if *cx.data() < 5 {
+            Ok(FuelAction::YieldAndRefuel(10))
+        } else {
+            Ok(FuelAction::Refuel(u64::max_value()))
+        }
+    });
+    let module = Module::new(
+        &engine,
+        "
+            (module
+                (func
+                    (local i32)
+                    i32.const 1000
+                    local.set 0
+                    (loop
+                        local.get 0
+                        i32.const -1
+                        i32.add
+                        local.tee 0
+                        br_if 0)
+                )
+                (start 0)
+            )
+        ",
+    )
+    .unwrap();
+    let instance = Instance::new_async(&mut store, &module, &[]);
+    let mut f = Pin::from(Box::new(instance));
+    let waker = dummy_waker();
+    let mut cx = Context::from_waker(&waker);
+
+    // The first four times fuel runs out the future yields, after which the
+    // callback refuels enough to finish.
+    for _ in 0..4 {
+        assert!(f.as_mut().poll(&mut cx).is_pending());
+    }
+    match f.as_mut().poll(&mut cx) {
+        Poll::Ready(result) => {
+            result.unwrap();
+        }
+        Poll::Pending => panic!("should have finished"),
+    }
+    drop(f);
+    assert_eq!(*store.data(), 5);
+}
+
 #[test]
 fn fuel_eventually_finishes() {
     let engine = Engine::new(Config::new().async_support(true).consume_fuel(true)).unwrap();
@@ -480,6 +532,33 @@ fn async_host_func_with_pooling_stacks() -> Result<()> {
     Ok(())
 }
 
+#[test]
+#[cfg_attr(windows, ignore)] // stacks are managed by the OS on Windows
+fn async_with_cached_stacks() -> Result<()> {
+    let mut config = Config::new();
+    config.async_support(true);
+    config.async_stack_cache_size(1);
+    let engine = Engine::new(&config)?;
+    let mut store = Store::new(&engine, ());
+    let func = Func::new_async(
+        &mut store,
+        FuncType::new(None, None),
+        move |_caller, _params, _results| Box::new(async { Ok(()) }),
+    );
+
+    run_smoke_test(&mut store, func);
+    run_smoke_typed_test(&mut store, func);
+
+    // Each call returned its stack to the cache, so only the first allocated
+    // a new one.
+    let stats = engine.fiber_stack_stats();
+    assert_eq!(stats.live(), 0);
+    assert_eq!(stats.cached(), 1);
+    assert_eq!(stats.created(), 1);
+    assert_eq!(stats.reused(), 3);
+    Ok(())
+}
+
 fn execute_across_threads<F: Future + Send + 'static>(future: F) {
     let mut future = Pin::from(Box::new(future));
     let poll = future
@@ -1,7 +1,9 @@
+use anyhow::bail;
 use std::future::Future;
 use std::sync::atomic::{AtomicBool, Ordering};
 use std::sync::Arc;
 use std::task::{Context, Poll, RawWaker, RawWakerVTable, Waker};
+use std::time::Duration;
 use wasmtime::*;
 
 fn dummy_waker() -> Waker {
@@ -33,7 +35,7 @@ fn build_engine() -> Arc<Engine> {
     Arc::new(Engine::new(&config).unwrap())
 }
 
-fn make_env(engine: &Engine) -> Linker<()> {
+fn make_env<T>(engine: &Engine) -> Linker<T> {
     let mut linker = Linker::new(engine);
     let engine = engine.clone();
 
@@ -422,3 +424,157 @@ fn drop_future_on_epoch_yield() {
     drop(future);
     assert_eq!(true, alive_flag.load(Ordering::Acquire));
 }
+
+#[test]
+fn epoch_sample_and_update() {
+    let mut config = Config::new();
+    config.epoch_interruption(true);
+    let engine = Engine::new(&config).unwrap();
+    let linker = make_env(&engine);
+    let module = Module::new(
+        &engine,
+        "
+            (module
+                (import \"\" \"bump_epoch\" (func $bump))
+                (func $hot (export \"run\") (local i32)
+                    i32.const 10
+                    local.set 0
+                    (loop $l
+                        call $bump
+                        local.get 0
+                        i32.const 1
+                        i32.sub
+                        local.tee 0
+                        br_if $l)))
+        ",
+    )
+    .unwrap();
+    let mut store = Store::new(&engine, ());
+    store.set_epoch_deadline(1);
+    store.epoch_deadline_sample_and_update(1);
+
+    let instance = linker.instantiate(&mut store, &module).unwrap();
+    let run = instance
+        .get_typed_func::<(), (), _>(&mut store, "run")
+        .unwrap();
+    run.call(&mut store, ()).unwrap();
+
+    let samples = store.profile_samples();
+    assert_eq!(samples.len(), 1);
+    assert_eq!(samples[0].func_index(), 1);
+    assert_eq!(samples[0].func_name(), Some("hot"));
+    assert!(samples[0].samples() >= 9);
+
+    store.clear_profile_samples();
+    assert!(store.profile_samples().is_empty());
+}
+
+#[test]
+fn epoch_deadline_callback() {
+    let mut config = Config::new();
+    config.epoch_interruption(true);
+    let engine = Engine::new(&config).unwrap();
+    let linker = make_env(&engine);
+    let module = Module::new(
+        &engine,
+        "
+            (module
+                (import \"\" \"bump_epoch\" (func $bump))
+                (func (export \"run\")
+                    (loop $l
+                        call $bump
+                        br $l)))
+        ",
+    )
+    .unwrap();
+    let mut store = Store::new(&engine, 0);
+    store.set_epoch_deadline(1);
+    store.epoch_deadline_callback(|mut store| {
+        *store.data_mut() += 1;
+        if *store.data() == 5 {
+            bail!("out of time slices");
+        }
+        Ok(DeadlineAction::Extend(1))
+    });
+
+    let instance = linker.instantiate(&mut store, &module).unwrap();
+    let run = instance
+        .get_typed_func::<(), (), _>(&mut store, "run")
+        .unwrap();
+    let err = run.call(&mut store, ()).unwrap_err();
+    assert!(err.to_string().contains("out of time slices"), "{}", err);
+    assert_eq!(*store.data(), 5);
+
+    // Yielding requires async support.
+    *store.data_mut() = 0;
+    store.set_epoch_deadline(1);
+    store.epoch_deadline_callback(|_| Ok(DeadlineAction::YieldAndExtend(1)));
+    assert!(run.call(&mut store, ()).is_err());
+}
+
+#[tokio::test]
+async fn epoch_deadline_callback_yields() {
+    let engine = build_engine();
+    let linker = make_env(&engine);
+    let module = Module::new(
+        &engine,
+        "
+            (module
+                (import \"\" \"bump_epoch\" (func $bump))
+                (func (export \"run\") (local i32)
+                    i32.const 10
+                    local.set 0
+                    (loop $l
+                        call $bump
+                        local.get 0
+                        i32.const 1
+                        i32.sub
+                        local.tee 0
+                        br_if $l)))
+        ",
+    )
+    .unwrap();
+    let mut store = Store::new(&engine, 0);
+    store.set_epoch_deadline(1);
+    store.epoch_deadline_callback(|mut store| {
+        *store.data_mut() += 1;
+        Ok(DeadlineAction::YieldAndExtend(1))
+    });
+
+    let instance = linker.instantiate_async(&mut store, &module).await.unwrap();
+    let run = instance
+        .get_typed_func::<(), (), _>(&mut store, "run")
+        .unwrap();
+    run.call_async(&mut store, ()).await.unwrap();
+    assert!(*store.data() >= 9);
+}
+
+#[test]
+fn epoch_ticker_interrupts_infinite_loop() {
+    let mut config = Config::new();
+    config.epoch_interruption(true);
+    let engine = Engine::new(&config).unwrap();
+    assert!(engine.start_epoch_ticker(Duration::from_secs(0)).is_err());
+    engine.start_epoch_ticker(Duration::from_millis(1)).unwrap();
+
+    let module = Module::new(
+        &engine,
+        "
+            (module
+                (func (export \"run\")
+                    (loop $l
+                        br $l)))
+        ",
+    )
+    .unwrap();
+    let mut store = Store::new(&engine, ());
+    store.set_epoch_deadline(2);
+    let instance = Instance::new(&mut store, &module, &[]).unwrap();
+    let run = instance
+        .get_typed_func::<(), (), _>(&mut store, "run")
+        .unwrap();
+    let trap = run.call(&mut store, ()).unwrap_err();
+    assert!(trap.to_string().contains("epoch deadline reached"));
+
+    engine.stop_epoch_ticker();
+}
@@ -189,3 +189,50 @@ fn manual_edge_cases() {
     assert!(store.consume_fuel(i64::MAX as u64 + 1).is_err());
     assert_eq!(store.consume_fuel(i64::MAX as u64 - 1).unwrap(), 1);
 }
+
+#[test]
+fn out_of_fuel_callback() -> Result<()> {
+    let mut config = Config::new();
+    config.consume_fuel(true);
+    let engine = Engine::new(&config)?;
+    let module = Module::new(
+        &engine,
+        r#"
+            (module
+                (func (export "run") (param i32)
+                    (loop
+                        local.get 0
+                        i32.const -1
+                        i32.add
+                        local.tee 0
+                        br_if 0)))
+        "#,
+    )?;
+    let mut store = Store::new(&engine, 0);
+    store.out_of_fuel_callback(|mut cx| {
+        *cx.data_mut() += 1;
+        Ok(FuelAction::Refuel(100))
+    });
+    let instance = Instance::new(&mut store, &module, &[])?;
+    let run = instance.get_typed_func::<i32, (), _>(&mut store, "run")?;
+
+    // The loop consumes far more than 100 fuel, so it only finishes through
+    // repeated refueling.
+    run.call(&mut store, 10_000)?;
+    assert!(*store.data() > 10);
+
+    // Errors returned from the callback are raised as traps.
+    store.out_of_fuel_callback(|_| anyhow::bail!("budget exhausted"));
+    let trap = run.call(&mut store, 10_000).unwrap_err().to_string();
+    assert!(trap.contains("budget exhausted"), "bad error: {}", trap);
+
+    // Yielding requires async support.
+    store.out_of_fuel_callback(|_| Ok(FuelAction::YieldAndRefuel(100)));
+    let trap = run.call(&mut store, 10_000).unwrap_err().to_string();
+    assert!(
+        trap.contains("without async support"),
+        "bad error: {}",
+        trap
+    );
+    Ok(())
+}
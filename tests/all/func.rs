@@ -932,3 +932,65 @@ fn typed_funcs_count_params_correctly_in_error_messages() -> anyhow::Result<()>
 
     Ok(())
 }
+
+#[test]
+fn call_unchecked_batch() -> Result<()> {
+    let mut store = Store::<()>::default();
+    let module = Module::new(
+        store.engine(),
+        r#"
+            (module
+                (func (export "f") (param i32) (result i32)
+                    local.get 0
+                    i32.eqz
+                    if
+                        unreachable
+                    end
+                    local.get 0
+                    i32.const 2
+                    i32.mul)
+            )
+        "#,
+    )?;
+    let instance = Instance::new(&mut store, &module, &[])?;
+    let f = instance.get_func(&mut store, "f").unwrap();
+
+    // Use a stride larger than strictly necessary to ensure that it's
+    // respected for both parameters and results.
+    let mut blocks = [ValRaw { i32: 0 }; 8];
+    for (i, x) in [1, 2, 3, 4].iter().enumerate() {
+        blocks[i * 2] = ValRaw { i32: *x };
+        blocks[i * 2 + 1] = ValRaw { i32: -1 };
+    }
+    unsafe {
+        f.call_unchecked_batch(&mut store, blocks.as_mut_ptr(), 2, 4)
+            .map_err(|(_, trap)| trap)?;
+        for (i, x) in [2, 4, 6, 8].iter().enumerate() {
+            assert_eq!(blocks[i * 2].i32, *x);
+            assert_eq!(blocks[i * 2 + 1].i32, -1);
+        }
+    }
+
+    // A trap in the middle of the batch stops execution and reports the
+    // index of the invocation that trapped.
+    for (i, x) in [1, 2, 0, 4].iter().enumerate() {
+        blocks[i * 2] = ValRaw { i32: *x };
+    }
+    unsafe {
+        let (index, trap) = f
+            .call_unchecked_batch(&mut store, blocks.as_mut_ptr(), 2, 4)
+            .unwrap_err();
+        assert_eq!(index, 2);
+        assert_eq!(trap.trap_code(), Some(TrapCode::UnreachableCodeReached));
+        assert_eq!(blocks[0].i32, 2);
+        assert_eq!(blocks[2].i32, 4);
+        assert_eq!(blocks[6].i32, 4);
+    }
+
+    // An empty batch doesn't call anything.
+    unsafe {
+        f.call_unchecked_batch(&mut store, blocks.as_mut_ptr(), 2, 0)
+            .map_err(|(_, trap)| trap)?;
+    }
+    Ok(())
+}
@@ -487,3 +487,36 @@ fn no_gc_middle_of_args() -> anyhow::Result<()> {
 
     Ok(())
 }
+
+#[test]
+fn gc_stats() -> anyhow::Result<()> {
+    let (mut store, module) = ref_types_module(
+        false,
+        r#"
+            (module
+                (func (export "run") (param externref))
+            )
+        "#,
+    )?;
+
+    let instance = Instance::new(&mut store, &module, &[])?;
+    let func = instance.get_typed_func::<Option<ExternRef>, (), _>(&mut store, "run")?;
+    assert_eq!(store.gc_stats().collections(), 0);
+
+    // Passing many references into wasm fills up the activations table, which
+    // triggers GCs and grows the table.
+    for i in 0..10_000 {
+        func.call(&mut store, Some(ExternRef::new(i)))?;
+    }
+    let stats = store.gc_stats();
+    assert!(stats.collections() >= 2);
+    assert!(stats.collections() < 10_000);
+    assert!(stats.chunk_capacity() > 512);
+    assert!(stats.max_pause() <= stats.total_pause());
+
+    store.gc();
+    assert_eq!(store.gc_stats().collections(), stats.collections() + 1);
+    assert_eq!(store.gc_stats().live_roots(), 0);
+
+    Ok(())
+}
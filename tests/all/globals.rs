@@ -103,3 +103,38 @@ fn v128() -> anyhow::Result<()> {
     assert_eq!(g.get(&mut store).v128(), Some(1));
     Ok(())
 }
+
+#[test]
+fn data_ptr() -> anyhow::Result<()> {
+    let mut store = Store::<()>::default();
+    let module = Module::new(
+        store.engine(),
+        r#"
+            (module
+                (global $count (export "count") (mut i64) (i64.const 0))
+                (global (export "pi") f32 (f32.const 3.5))
+                (func (export "bump")
+                    (global.set $count (i64.add (global.get $count) (i64.const 1)))))
+        "#,
+    )?;
+    let instance = Instance::new(&mut store, &module, &[])?;
+    let bump = instance.get_typed_func::<(), (), _>(&mut store, "bump")?;
+    let count = instance.get_global(&mut store, "count").unwrap();
+    let pi = instance.get_global(&mut store, "pi").unwrap();
+
+    let count_ptr = count.data_ptr(&store).cast::<i64>();
+    unsafe {
+        assert_eq!(*count_ptr, 0);
+        bump.call(&mut store, ())?;
+        bump.call(&mut store, ())?;
+        assert_eq!(*count_ptr, 2);
+
+        *count_ptr = 10;
+        assert_eq!(count.get(&mut store).i64(), Some(10));
+        bump.call(&mut store, ())?;
+        assert_eq!(*count_ptr, 11);
+
+        assert_eq!(*pi.data_ptr(&store).cast::<f32>(), 3.5);
+    }
+    Ok(())
+}
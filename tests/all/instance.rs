@@ -103,3 +103,110 @@ fn linear_memory_limits() -> Result<()> {
         Ok(())
     }
 }
+
+#[test]
+fn export_by_index() -> Result<()> {
+    let engine = Engine::default();
+    let module = Module::new(
+        &engine,
+        r#"
+            (module
+                (import "" "read" (func $read (result i32)))
+                (global (export "g") i32 (i32.const 0))
+                (memory (export "memory") 1)
+                (func (export "run") (result i32)
+                    call $read)
+                (data (i32.const 0) "\2a"))
+        "#,
+    )?;
+    assert_eq!(module.get_export_index("g"), Some(0));
+    assert_eq!(module.get_export_index("run"), Some(2));
+    assert_eq!(module.get_export_index("missing"), None);
+    let memory_index = module.get_export_index("memory").unwrap();
+
+    let mut store = Store::new(&engine, ());
+    let read = Func::wrap(&mut store, move |mut caller: Caller<'_, ()>| {
+        // Globals aren't available through `Caller`.
+        assert!(caller.get_export_by_index(0).is_none());
+        let memory = caller
+            .get_export_by_index(memory_index)
+            .unwrap()
+            .into_memory()
+            .unwrap();
+        i32::from(memory.data(&caller)[0])
+    });
+    let instance = Instance::new(&mut store, &module, &[read.into()])?;
+    assert!(instance
+        .get_export_by_index(&mut store, 0)
+        .unwrap()
+        .into_global()
+        .is_some());
+    assert!(instance.get_export_by_index(&mut store, 3).is_none());
+
+    let run = instance
+        .get_export_by_index(&mut store, 2)
+        .unwrap()
+        .into_func()
+        .unwrap()
+        .typed::<(), i32, _>(&store)?;
+    assert_eq!(run.call(&mut store, ())?, 42);
+    Ok(())
+}
+
+#[test]
+fn snapshot_initialized_state() -> Result<()> {
+    let wat = r#"
+        (module
+            (import "" "init" (func $init))
+            (memory (export "memory") 1)
+            (global $g (export "g") (mut i32) (i32.const 0))
+            (table (export "table") 2 funcref)
+            (elem declare func $answer)
+            (func $answer (result i32) i32.const 42)
+            (func $start
+                call $init
+                (memory.grow (i32.const 1))
+                drop
+                (i32.store (i32.const 70000) (i32.const 0xdead))
+                (i32.store8 (i32.const 10) (i32.const 7))
+                (global.set $g (i32.const 100))
+                (table.set (i32.const 1) (ref.func $answer)))
+            (start $start)
+            (func (export "call") (param i32) (result i32)
+                local.get 0
+                call_indirect (result i32)))
+    "#;
+    let engine = Engine::default();
+    let module = Module::new(&engine, wat)?;
+    let mut store = Store::new(&engine, 0);
+    let init = Func::wrap(&mut store, |mut caller: Caller<'_, i32>| {
+        *caller.data_mut() += 1;
+    });
+    let instance = Instance::new(&mut store, &module, &[init.into()])?;
+    assert_eq!(*store.data(), 1);
+    let snapshot = instance.snapshot(&mut store, wat.as_bytes())?;
+
+    // The snapshot starts out in the initialized state without running the
+    // start function again.
+    let module = Module::new(&engine, &snapshot)?;
+    let mut store = Store::new(&engine, 0);
+    let init = Func::wrap(&mut store, |mut caller: Caller<'_, i32>| {
+        *caller.data_mut() += 1;
+    });
+    let instance = Instance::new(&mut store, &module, &[init.into()])?;
+    assert_eq!(*store.data(), 0);
+
+    let memory = instance.get_memory(&mut store, "memory").unwrap();
+    assert_eq!(memory.size(&store), 2);
+    assert_eq!(memory.data(&store)[10], 7);
+    assert_eq!(&memory.data(&store)[70000..70002], &[0xad, 0xde]);
+    let g = instance.get_global(&mut store, "g").unwrap();
+    assert_eq!(g.get(&mut store).i32(), Some(100));
+    let call = instance.get_typed_func::<i32, i32, _>(&mut store, "call")?;
+    assert_eq!(call.call(&mut store, 1)?, 42);
+    assert!(call.call(&mut store, 0).is_err());
+
+    // Snapshots may only be taken with the instance's own module.
+    assert!(instance.snapshot(&mut store, b"(module)").is_err());
+    Ok(())
+}
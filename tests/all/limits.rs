@@ -3,6 +3,43 @@ use wasmtime::*;
 
 const WASM_PAGE_SIZE: usize = wasmtime_environ::WASM_PAGE_SIZE as usize;
 
+#[test]
+fn test_resource_usage() -> Result<()> {
+    let engine = Engine::default();
+    let module = Module::new(
+        &engine,
+        r#"(module
+            (memory (export "m") 1)
+            (table 3 funcref))"#,
+    )?;
+    let mut store = Store::new(&engine, ());
+    let usage = store.resource_usage();
+    assert_eq!(usage.instances(), 0);
+    assert_eq!(usage.memory_bytes_committed(), 0);
+
+    let instance = Instance::new(&mut store, &module, &[])?;
+    let usage = store.resource_usage();
+    assert_eq!(usage.instances(), 1);
+    assert_eq!(usage.memories(), 1);
+    assert_eq!(usage.tables(), 1);
+    assert_eq!(usage.memory_bytes_committed(), WASM_PAGE_SIZE);
+    assert!(usage.memory_bytes_reserved() >= WASM_PAGE_SIZE);
+    assert_eq!(usage.table_elements(), 3);
+
+    // Growth and host-created objects are reflected as well.
+    instance
+        .get_memory(&mut store, "m")
+        .unwrap()
+        .grow(&mut store, 1)?;
+    Memory::new(&mut store, MemoryType::new(2, None))?;
+    let usage = store.resource_usage();
+    assert_eq!(usage.instances(), 1);
+    assert_eq!(usage.memories(), 2);
+    assert_eq!(usage.memory_bytes_committed(), 4 * WASM_PAGE_SIZE);
+    assert_eq!(store.as_context().resource_usage().memories(), 2);
+    Ok(())
+}
+
 #[test]
 fn test_limits() -> Result<()> {
     let engine = Engine::default();
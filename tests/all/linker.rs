@@ -340,3 +340,59 @@ fn instance_pre() -> Result<()> {
     instance_pre.instantiate(&mut store)?;
     Ok(())
 }
+
+#[test]
+fn many_host_funcs_share_trampolines() -> Result<()> {
+    let engine = Engine::default();
+    let mut linker = Linker::new(&engine);
+    linker.reserve(20);
+
+    // All of these closures have the same type, so functions of the same
+    // signature share their trampolines.
+    fn define(linker: &mut Linker<()>, name: &str, ty: FuncType, n: i32) -> Result<()> {
+        linker.func_new("host", name, ty, move |_, params, results| {
+            let param = params.get(0).map_or(0, |p| p.unwrap_i32());
+            results[0] = Val::I32(param + n);
+            Ok(())
+        })?;
+        Ok(())
+    }
+    for i in 0..10 {
+        let nullary = FuncType::new(None, Some(ValType::I32));
+        let unary = FuncType::new(Some(ValType::I32), Some(ValType::I32));
+        define(&mut linker, &format!("nullary{}", i), nullary, i)?;
+        define(&mut linker, &format!("unary{}", i), unary, 100 * i)?;
+    }
+    assert_eq!(engine.live_host_trampolines(), 2);
+
+    // Host functions, and with them their trampolines, outlive the linker they
+    // were defined in.
+    let linker = {
+        let template = linker;
+        template.clone()
+    };
+
+    let module = Module::new(
+        &engine,
+        r#"
+            (module
+                (import "host" "nullary3" (func $a (result i32)))
+                (import "host" "nullary7" (func $b (result i32)))
+                (import "host" "unary2" (func $c (param i32) (result i32)))
+                (func (export "run") (result i32)
+                    (i32.add (call $a) (call $b))
+                    call $c))
+        "#,
+    )?;
+    let mut store = Store::new(&engine, ());
+    let instance = linker.instantiate(&mut store, &module)?;
+    let run = instance.get_typed_func::<(), i32, _>(&mut store, "run")?;
+    assert_eq!(run.call(&mut store, ())?, 210);
+    assert_eq!(engine.live_host_trampolines(), 2);
+
+    // Once the last functions using them are gone so are the trampolines.
+    drop(store);
+    drop(linker);
+    assert_eq!(engine.live_host_trampolines(), 0);
+    Ok(())
+}
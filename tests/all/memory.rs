@@ -474,3 +474,101 @@ fn memory64_maximum_minimum() -> Result<()> {
 
     Ok(())
 }
+
+#[test]
+fn read_write_vectored() -> Result<()> {
+    use std::io::{IoSlice, IoSliceMut};
+
+    let mut store = Store::<()>::default();
+    let memory = Memory::new(&mut store, MemoryType::new(1, None))?;
+
+    let bufs = [
+        IoSlice::new(b"hello"),
+        IoSlice::new(b""),
+        IoSlice::new(b" world"),
+    ];
+    memory.write_vectored(&mut store, 100, &bufs)?;
+    assert_eq!(&memory.data(&store)[100..111], b"hello world");
+
+    let (mut a, mut b) = ([0; 3], [0; 8]);
+    memory.read_vectored(
+        &store,
+        100,
+        &mut [IoSliceMut::new(&mut a), IoSliceMut::new(&mut b)],
+    )?;
+    assert_eq!(&a, b"hel");
+    assert_eq!(&b, b"lo world");
+
+    // Nothing is written if any part of the range is out of bounds.
+    let bufs = [IoSlice::new(b"abc"), IoSlice::new(b"def")];
+    assert!(memory.write_vectored(&mut store, 65531, &bufs).is_err());
+    assert_eq!(&memory.data(&store)[65531..], [0; 5]);
+    memory.write_vectored(&mut store, 65530, &bufs)?;
+    assert_eq!(&memory.data(&store)[65530..], b"abcdef");
+    Ok(())
+}
+
+#[test]
+fn decommit() -> Result<()> {
+    let mut store = Store::<()>::default();
+    let memory = Memory::new(&mut store, MemoryType::new(4, None))?;
+    memory.data_mut(&mut store).fill(1);
+
+    // Whole pages are released and partial ones zeroed, nothing else changes.
+    memory.decommit(&mut store, 100, 3 << 16)?;
+    let data = memory.data(&store);
+    assert!(data[..100].iter().all(|b| *b == 1));
+    assert!(data[100..][..3 << 16].iter().all(|b| *b == 0));
+    assert!(data[(3 << 16) + 100..].iter().all(|b| *b == 1));
+    assert_eq!(memory.size(&store), 4);
+
+    assert!(memory.decommit(&mut store, 1, 4 << 16).is_err());
+    assert!(memory.decommit(&mut store, usize::MAX, 2).is_err());
+    assert_eq!(memory.data(&store)[(4 << 16) - 1], 1);
+
+    memory.reset(&mut store)?;
+    assert!(memory.data(&store).iter().all(|b| *b == 0));
+    memory.write(&mut store, 0, b"hello")?;
+    assert_eq!(&memory.data(&store)[..5], b"hello");
+    Ok(())
+}
+
+#[test]
+fn decommit_image_pooling() -> Result<()> {
+    let mut config = Config::new();
+    config.allocation_strategy(InstanceAllocationStrategy::Pooling {
+        strategy: PoolingAllocationStrategy::default(),
+        instance_limits: InstanceLimits {
+            count: 1,
+            memory_pages: 2,
+            ..Default::default()
+        },
+    });
+    let engine = Engine::new(&config)?;
+    let module = Module::new(
+        &engine,
+        r#"
+            (module
+                (memory (export "m") 2)
+                (data (i32.const 0) "init")
+                (data (i32.const 65536) "more"))
+        "#,
+    )?;
+
+    for _ in 0..2 {
+        let mut store = Store::new(&engine, ());
+        let instance = Instance::new(&mut store, &module, &[])?;
+        let memory = instance.get_memory(&mut store, "m").unwrap();
+        assert_eq!(&memory.data(&store)[..4], b"init");
+        assert_eq!(&memory.data(&store)[65536..][..4], b"more");
+
+        // Decommitted parts of the initial image read as zero, and the image
+        // is restored for the next instance using the same slot.
+        memory.decommit(&mut store, 0, 65536)?;
+        assert_eq!(&memory.data(&store)[..4], [0; 4]);
+        assert_eq!(&memory.data(&store)[65536..][..4], b"more");
+        memory.reset(&mut store)?;
+        assert!(memory.data(&store).iter().all(|b| *b == 0));
+    }
+    Ok(())
+}
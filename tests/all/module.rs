@@ -20,6 +20,24 @@ fn checks_incompatible_target() -> Result<()> {
     Ok(())
 }
 
+#[test]
+fn deserialize_checks_incompatible_target() -> Result<()> {
+    let mut target = target_lexicon::Triple::host();
+    target.operating_system = target_lexicon::OperatingSystem::Unknown;
+    let engine = Engine::new(Config::new().target(&target.to_string())?)?;
+    let bytes = engine.precompile_module(b"(module)")?;
+    match unsafe { Module::deserialize(&engine, &bytes) } {
+        Ok(_) => unreachable!(),
+        Err(e) => assert!(
+            format!("{:?}", e).contains("configuration does not match the host"),
+            "bad error: {:?}",
+            e
+        ),
+    }
+
+    Ok(())
+}
+
 #[test]
 fn caches_across_engines() {
     let c = Config::new();
@@ -110,3 +128,200 @@ fn serialize_deterministic() {
     assert_deterministic("(module (data \"\") (data \"\"))");
     assert_deterministic("(module (elem) (elem))");
 }
+
+#[test]
+#[cfg(all(
+    target_os = "linux",
+    feature = "memory-init-cow",
+    not(feature = "uffd")
+))]
+fn reports_memory_image() -> Result<()> {
+    let wat = r#"
+        (module
+            (memory 1)
+            (data (i32.const 0) "hello"))
+    "#;
+
+    let mut config = Config::new();
+    config.memory_init_cow(true);
+    let module = Module::new(&Engine::new(&config)?, wat)?;
+    assert!(module.has_memory_image()?);
+
+    config.memory_init_cow(false);
+    let module = Module::new(&Engine::new(&config)?, wat)?;
+    assert!(!module.has_memory_image()?);
+
+    Ok(())
+}
+
+#[test]
+fn reports_compile_progress() -> Result<()> {
+    let mut config = Config::new();
+    config.parallel_compilation_threads(2);
+    let engine = Engine::new(&config)?;
+    let wasm = wat::parse_str(
+        r#"
+            (module
+                (func)
+                (func (param i32) (result i32) local.get 0)
+                (func (export "f") (result i64) i64.const 0))
+        "#,
+    )?;
+
+    let calls = std::sync::Mutex::new(Vec::new());
+    Module::from_binary_with_progress(&engine, &wasm, |completed, total| {
+        calls.lock().unwrap().push((completed, total));
+    })?;
+    let mut calls = calls.into_inner().unwrap();
+    calls.sort();
+    assert_eq!(calls, [(1, 3), (2, 3), (3, 3)]);
+    Ok(())
+}
+
+#[test]
+fn reports_compile_events() -> Result<()> {
+    #[derive(Default)]
+    struct MemoryStore(std::sync::Mutex<std::collections::HashMap<String, Vec<u8>>>);
+
+    impl CacheStore for MemoryStore {
+        fn get(&self, key: &str) -> Option<Vec<u8>> {
+            self.0.lock().unwrap().get(key).cloned()
+        }
+
+        fn insert(&self, key: &str, value: Vec<u8>) -> bool {
+            self.0.lock().unwrap().insert(key.to_string(), value);
+            true
+        }
+    }
+
+    fn events(engine: &Engine, wasm: &[u8]) -> Result<Vec<CompileEvent>> {
+        let events = std::cell::RefCell::new(Vec::new());
+        Module::from_binary_with_events(engine, wasm, |event| events.borrow_mut().push(event))?;
+        Ok(events.into_inner())
+    }
+
+    let wasm = wat::parse_str(r#"(module (func (export "f") (result i32) i32.const 1))"#)?;
+    let phases = [
+        CompilePhase::Translate,
+        CompilePhase::Codegen,
+        CompilePhase::Link,
+        CompilePhase::Publish,
+    ];
+    let compiled = phases
+        .iter()
+        .flat_map(|p| [CompileEvent::Start(*p), CompileEvent::End(*p)])
+        .collect::<Vec<_>>();
+
+    // Without a cache there's no hit or miss to report.
+    let engine = Engine::default();
+    assert_eq!(events(&engine, &wasm)?, compiled);
+
+    let mut config = Config::new();
+    config.cache_store(std::sync::Arc::new(MemoryStore::default()));
+    let engine = Engine::new(&config)?;
+    let mut miss = vec![CompileEvent::CacheMiss];
+    miss.extend(compiled);
+    assert_eq!(events(&engine, &wasm)?, miss);
+    assert_eq!(
+        events(&engine, &wasm)?,
+        [
+            CompileEvent::CacheHit,
+            CompileEvent::Start(CompilePhase::Publish),
+            CompileEvent::End(CompilePhase::Publish),
+        ]
+    );
+    Ok(())
+}
+
+#[test]
+fn tier_up_modules_share_engine() -> Result<()> {
+    let mut config = Config::new();
+    config.cranelift_opt_level(OptLevel::None);
+    config.cranelift_tier_up_opt_level(OptLevel::Speed);
+    let engine = Engine::new(&config)?;
+    let wasm = wat::parse_str(
+        r#"
+            (module
+                (func (export "add") (param i32 i32) (result i32)
+                    local.get 0
+                    local.get 1
+                    i32.add))
+        "#,
+    )?;
+
+    let baseline = Module::from_binary(&engine, &wasm)?;
+    let optimized = Module::from_binary_tier_up(&engine, &wasm)?;
+
+    let mut store = Store::new(&engine, ());
+    for module in [&baseline, &optimized] {
+        let instance = Instance::new(&mut store, module, &[])?;
+        let add = instance.get_typed_func::<(i32, i32), i32, _>(&mut store, "add")?;
+        assert_eq!(add.call(&mut store, (1, 2))?, 3);
+    }
+    Ok(())
+}
+
+#[test]
+fn custom_cache_store() -> Result<()> {
+    #[derive(Debug, Default)]
+    struct MemoryStore {
+        entries: std::sync::Mutex<std::collections::HashMap<String, Vec<u8>>>,
+        hits: std::sync::atomic::AtomicUsize,
+    }
+
+    impl CacheStore for MemoryStore {
+        fn get(&self, key: &str) -> Option<Vec<u8>> {
+            let ret = self.entries.lock().unwrap().get(key).cloned();
+            if ret.is_some() {
+                self.hits.fetch_add(1, std::sync::atomic::Ordering::SeqCst);
+            }
+            ret
+        }
+
+        fn insert(&self, key: &str, value: Vec<u8>) -> bool {
+            self.entries.lock().unwrap().insert(key.to_string(), value);
+            true
+        }
+    }
+
+    let cache = std::sync::Arc::new(MemoryStore::default());
+    let mut config = Config::new();
+    config.cache_store(cache.clone());
+    let engine = Engine::new(&config)?;
+    let wasm = wat::parse_str(r#"(module (func (export "f") (result i32) i32.const 1))"#)?;
+
+    Module::new(&engine, &wasm)?;
+    assert_eq!(cache.entries.lock().unwrap().len(), 1);
+    assert_eq!(cache.hits.load(std::sync::atomic::Ordering::SeqCst), 0);
+
+    let module = Module::new(&engine, &wasm)?;
+    assert_eq!(cache.hits.load(std::sync::atomic::Ordering::SeqCst), 1);
+
+    let mut store = Store::new(&engine, ());
+    let instance = Instance::new(&mut store, &module, &[])?;
+    let f = instance.get_typed_func::<(), i32, _>(&mut store, "f")?;
+    assert_eq!(f.call(&mut store, ())?, 1);
+    Ok(())
+}
+
+#[test]
+fn lazy_debug_registration() -> Result<()> {
+    let mut config = Config::new();
+    config.debug_info(true);
+    config.lazy_debug_registration(true);
+    let engine = Engine::new(&config)?;
+    let module = Module::new(
+        &engine,
+        r#"(module (func (export "f") (result i32) i32.const 1))"#,
+    )?;
+
+    // Registration is idempotent.
+    module.register_debug_info()?;
+    module.register_debug_info()?;
+
+    let mut store = Store::new(&engine, ());
+    let instance = Instance::new(&mut store, &module, &[])?;
+    let f = instance.get_typed_func::<(), i32, _>(&mut store, "f")?;
+    assert_eq!(f.call(&mut store, ())?, 1);
+    Ok(())
+}
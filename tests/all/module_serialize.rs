@@ -58,6 +58,31 @@ fn test_module_serialize_simple() -> Result<()> {
     Ok(())
 }
 
+#[test]
+fn test_module_serialize_to_writer() -> Result<()> {
+    let engine = Engine::default();
+    let module = Module::new(
+        &engine,
+        "(module (func (export \"run\") (result i32) i32.const 42))",
+    )?;
+    let buffer = module.serialize()?;
+    assert_eq!(module.serialized_size()?, buffer.len());
+
+    let mut streamed = Vec::new();
+    module.serialize_to(&mut streamed)?;
+    assert_eq!(streamed, buffer);
+
+    let mut store = Store::default();
+    let instance = unsafe { deserialize_and_instantiate(&mut store, &streamed)? };
+    let run = instance.get_typed_func::<(), i32, _>(&mut store, "run")?;
+    assert_eq!(run.call(&mut store, ())?, 42);
+
+    // Errors from the writer are propagated.
+    let mut full = [0; 16];
+    assert!(module.serialize_to(&mut full[..]).is_err());
+    Ok(())
+}
+
 #[test]
 fn test_module_serialize_fail() -> Result<()> {
     let buffer = serialize(
@@ -103,3 +128,41 @@ fn test_deserialize_from_file() -> Result<()> {
         Ok(())
     }
 }
+
+#[test]
+#[cfg_attr(not(unix), ignore)]
+fn test_share_deserialized_code() -> Result<()> {
+    let mut config = Config::new();
+    config.share_deserialized_code(true);
+    let engine1 = Engine::new(&config)?;
+    let engine2 = Engine::new(&config)?;
+    let unshared = Engine::default();
+
+    let td = tempfile::TempDir::new()?;
+    let path = td.path().join("module.bin");
+    let buffer = serialize(
+        &engine1,
+        "(module (func (export \"run\") (result i32) i32.const 42))",
+    )?;
+    fs::write(&path, &buffer)?;
+
+    let module1 = unsafe { Module::deserialize_file(&engine1, &path)? };
+    let module2 = unsafe { Module::deserialize_file(&engine2, &path)? };
+    let module3 = unsafe { Module::deserialize_file(&unshared, &path)? };
+    assert_eq!(module1.image_range(), module2.image_range());
+    assert_ne!(module1.image_range(), module3.image_range());
+
+    for module in [&module1, &module2, &module3] {
+        let mut store = Store::new(module.engine(), ());
+        let instance = Instance::new(&mut store, module, &[])?;
+        let func = instance.get_typed_func::<(), i32, _>(&mut store, "run")?;
+        assert_eq!(func.call(&mut store, ())?, 42);
+    }
+
+    // Once the shared module is dropped the file is loaded anew.
+    drop((module1, module2));
+    let module4 = unsafe { Module::deserialize_file(&engine2, &path)? };
+    let mut store = Store::new(&engine2, ());
+    Instance::new(&mut store, &module4, &[])?;
+    Ok(())
+}
@@ -1,5 +1,5 @@
 use std::sync::atomic::{AtomicUsize, Ordering::SeqCst};
-use wasmtime::{Engine, Store};
+use wasmtime::*;
 
 #[test]
 fn into_inner() {
@@ -20,3 +20,63 @@ fn into_inner() {
     Store::new(&engine, A).into_data();
     assert_eq!(HITS.load(SeqCst), 2);
 }
+
+#[test]
+fn reset() -> anyhow::Result<()> {
+    static HITS: AtomicUsize = AtomicUsize::new(0);
+
+    struct A;
+
+    impl Drop for A {
+        fn drop(&mut self) {
+            HITS.fetch_add(1, SeqCst);
+        }
+    }
+
+    let mut config = Config::new();
+    config.consume_fuel(true);
+    let engine = Engine::new(&config)?;
+    let module = Module::new(
+        &engine,
+        r#"
+            (module
+                (import "" "" (func))
+                (memory (export "m") 1)
+                (func (export "f") call 0))
+        "#,
+    )?;
+    let mut store = Store::new(&engine, ());
+
+    for i in 0..3 {
+        let a = A;
+        let import = Func::wrap(&mut store, move || drop(&a));
+        store.add_fuel(10_000)?;
+        let instance = Instance::new(&mut store, &module, &[import.into()])?;
+        let f = instance.get_typed_func::<(), (), _>(&mut store, "f")?;
+        f.call(&mut store, ())?;
+        assert!(store.fuel_consumed().unwrap() > 0);
+        let memory = instance.get_memory(&mut store, "m").unwrap();
+        assert_eq!(memory.data(&store)[0], 0);
+        memory.data_mut(&mut store)[0] = 1;
+
+        store.reset();
+
+        // Host state owned by the store is dropped on reset, and the store
+        // starts over with no fuel.
+        assert_eq!(HITS.load(SeqCst), i + 1);
+        assert_eq!(store.fuel_consumed(), Some(0));
+    }
+
+    // Items from before a reset are rejected.
+    let instance = {
+        let import = Func::wrap(&mut store, || {});
+        store.add_fuel(10_000)?;
+        Instance::new(&mut store, &module, &[import.into()])?
+    };
+    store.reset();
+    let result = std::panic::catch_unwind(std::panic::AssertUnwindSafe(|| {
+        instance.get_memory(&mut store, "m")
+    }));
+    assert!(result.is_err());
+    Ok(())
+}
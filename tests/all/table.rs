@@ -50,3 +50,43 @@ fn copy_wrong() {
         "tables do not have the same element type"
     );
 }
+
+#[test]
+fn set_range() {
+    let mut store = Store::<()>::default();
+    let ty = TableType::new(ValType::ExternRef, 4, None);
+    let table = Table::new(&mut store, ty, Val::ExternRef(None)).unwrap();
+    let vals = (0..3)
+        .map(|i| Val::ExternRef(Some(ExternRef::new(i))))
+        .collect::<Vec<_>>();
+    table.set_range(&mut store, 1, &vals).unwrap();
+
+    assert!(matches!(
+        table.get(&mut store, 0),
+        Some(Val::ExternRef(None))
+    ));
+    for i in 0..3 {
+        match table.get(&mut store, i + 1) {
+            Some(Val::ExternRef(Some(x))) => {
+                assert_eq!(x.data().downcast_ref::<u32>(), Some(&i));
+            }
+            _ => panic!(),
+        }
+    }
+
+    // Out-of-bounds and mistyped ranges write nothing.
+    assert_eq!(
+        table
+            .set_range(&mut store, 2, &vals)
+            .map_err(|e| e.to_string())
+            .unwrap_err(),
+        "table element index out of bounds"
+    );
+    assert!(table
+        .set_range(&mut store, 0, &[Val::ExternRef(None), Val::FuncRef(None)])
+        .is_err());
+    assert!(matches!(
+        table.get(&mut store, 0),
+        Some(Val::ExternRef(None))
+    ));
+}
@@ -671,3 +671,37 @@ fn traps_without_address_map() -> Result<()> {
     assert_eq!(trace[1].module_offset(), None);
     Ok(())
 }
+
+#[test]
+fn no_wasm_backtrace() -> Result<()> {
+    let mut config = Config::new();
+    config.wasm_backtrace(false);
+    let engine = Engine::new(&config)?;
+    let mut store = Store::new(&engine, ());
+    let wat = r#"
+        (module
+            (memory 1)
+            (func (export "unreachable") (call $hello))
+            (func $hello (unreachable))
+            (func (export "fill")
+                (memory.fill (i32.const 65536) (i32.const 0) (i32.const 1)))
+        )
+    "#;
+
+    let module = Module::new(&engine, wat)?;
+    let instance = Instance::new(&mut store, &module, &[])?;
+
+    // A trap raised by a signal handler.
+    let run = instance.get_typed_func::<(), (), _>(&mut store, "unreachable")?;
+    let e = run.call(&mut store, ()).unwrap_err();
+    assert_eq!(e.trap_code(), Some(TrapCode::UnreachableCodeReached));
+    assert!(e.trace().is_empty());
+
+    // A trap raised by a libcall.
+    let fill = instance.get_typed_func::<(), (), _>(&mut store, "fill")?;
+    let e = fill.call(&mut store, ()).unwrap_err();
+    assert_eq!(e.trap_code(), Some(TrapCode::HeapOutOfBounds));
+    assert!(e.trace().is_empty());
+
+    Ok(())
+}